@@ -38,7 +38,17 @@ EMSCRIPTEN_BINDINGS(gdjs_JsPlatform) {
 }
 
 EMSCRIPTEN_BINDINGS(gdjs_EventsCodeGenerator) {
-    function("GenerateSceneEventsCompleteCode", &EventsCodeGenerator::GenerateSceneEventsCompleteCode);
+    class_<ExternalEventsFunctions>("ExternalEventsFunctions")
+        .constructor<>()
+        .function("getCode", &ExternalEventsFunctions::GetCode)
+        .function("isEmpty", &ExternalEventsFunctions::IsEmpty)
+        ;
+
+    class_<EventsCodeSizes>("EventsCodeSizes")
+        .constructor<>()
+        ;
+
+    function("GenerateSceneEventsCompleteCode", &EventsCodeGenerator::GenerateSceneEventsCompleteCode, allow_raw_pointers());
 }
 
 EMSCRIPTEN_BINDINGS(gdjs_Exporter) {
@@ -46,6 +56,8 @@ EMSCRIPTEN_BINDINGS(gdjs_Exporter) {
         .constructor<gd::AbstractFileSystem &>()
         .function("exportLayoutForPreview", &Exporter::ExportLayoutForPreview)
         .function("exportWholeProject", &Exporter::ExportWholeProject)
+        .function("setWhileIterationsLimit", &Exporter::SetWhileIterationsLimit)
+        .function("setCodeSizeReportFile", &Exporter::SetCodeSizeReportFile)
         ;
 }
 #endif
\ No newline at end of file
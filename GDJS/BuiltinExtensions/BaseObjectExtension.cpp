@@ -11,6 +11,7 @@
 #include "GDCore/Events/EventsCodeNameMangler.h"
 #include "GDCore/CommonTools.h"
 #include "GDCore/Tools/Localization.h"
+#include "GDJS/EventsCodeGenerator.h"
 
 namespace gdjs
 {
@@ -130,6 +131,15 @@ BaseObjectExtension::BaseObjectExtension()
     objectExpressions["Distance"].codeExtraInformation.SetFunctionName("getDistanceFrom");
     objectExpressions["SqDistance"].codeExtraInformation.SetFunctionName("getSqDistanceFrom");
 
+    //Accessors without side effects: their calls can be cached by the generated code.
+    EventsCodeGenerator::DeclarePureObjectFunction("getX");
+    EventsCodeGenerator::DeclarePureObjectFunction("getY");
+    EventsCodeGenerator::DeclarePureObjectFunction("getZOrder");
+    EventsCodeGenerator::DeclarePureObjectFunction("getWidth");
+    EventsCodeGenerator::DeclarePureObjectFunction("getHeight");
+    EventsCodeGenerator::DeclarePureObjectFunction("getAngle");
+    EventsCodeGenerator::DeclarePureObjectFunction("getVariables");
+
 
     GetAllActions()["Create"].codeExtraInformation
         .SetFunctionName("gdjs.evtTools.object.createObjectOnScene");
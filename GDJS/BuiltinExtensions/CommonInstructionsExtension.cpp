@@ -24,6 +24,7 @@
 #include <set>
 #include "GDCore/Tools/Localization.h"
 #include "GDJS/JsCodeEvent.h"
+#include "GDJS/EventsCodeGenerator.h"
 
 using namespace std;
 using namespace gd;
@@ -31,6 +32,17 @@ using namespace gd;
 namespace gdjs
 {
 
+/**
+ * \brief Return the namespace in which the code generated by \a codeGenerator must declare its variables.
+ */
+static std::string GetCodeNamespace(gd::EventsCodeGenerator & codeGenerator)
+{
+    gdjs::EventsCodeGenerator * jsCodeGenerator = dynamic_cast<gdjs::EventsCodeGenerator*>(&codeGenerator);
+    if ( jsCodeGenerator ) return jsCodeGenerator->GetCodeNamespace();
+
+    return "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())+"Code.";
+}
+
 CommonInstructionsExtension::CommonInstructionsExtension()
 {
     gd::BuiltinExtensionsImplementer::ImplementsCommonInstructionsExtension(*this);
@@ -48,8 +60,31 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                                     gd::EventsList & eventList, unsigned int indexOfTheEventInThisList)
             {
                 gd::LinkEvent & event = dynamic_cast<gd::LinkEvent&>(event_);
+
+                //Links to all the events of external events, at the root of the layout events, are
+                //replaced by a call to a function shared by all the layouts using these external events
+                //( only for the first link to the same external events, see CanShareExternalEvents ).
+                gdjs::EventsCodeGenerator * jsCodeGenerator = dynamic_cast<gdjs::EventsCodeGenerator*>(&codeGenerator);
+                if ( jsCodeGenerator && jsCodeGenerator->CanShareExternalEvents(eventList, event.GetTarget()) && event.IncludeAllEvents() )
+                {
+                    std::string functionName = jsCodeGenerator->GenerateExternalEventsFunction(event.GetTarget());
+                    if ( !functionName.empty() )
+                    {
+                        //The link event is kept, and generated as the call to the function ( see Generate ).
+                        jsCodeGenerator->SetExternalEventsFunction(event, functionName);
+                        return;
+                    }
+                }
+
                 event.ReplaceLinkByLinkedEvents(codeGenerator.GetProject(), eventList, indexOfTheEventInThisList);
             }
+
+            virtual std::string Generate(gd::BaseEvent & event, gd::EventsCodeGenerator & codeGenerator, gd::EventsCodeGenerationContext & context)
+            {
+                //Only the link events calling the function of their external events are still there after the preprocessing.
+                gdjs::EventsCodeGenerator * jsCodeGenerator = dynamic_cast<gdjs::EventsCodeGenerator*>(&codeGenerator);
+                return jsCodeGenerator ? jsCodeGenerator->GenerateExternalEventsCall(event) : "";
+            }
         };
         gd::EventMetadata::CodeGenerator * codeGen = new CodeGen;
 
@@ -106,7 +141,7 @@ CommonInstructionsExtension::CommonInstructionsExtension()
         {
             virtual std::string GenerateCode(gd::Instruction & instruction, gd::EventsCodeGenerator & codeGenerator, gd::EventsCodeGenerationContext & parentContext)
             {
-                std::string codeNamespace = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())+"Code.";
+                std::string codeNamespace = GetCodeNamespace(codeGenerator);
 
                 //Conditions code
                 std::string conditionsCode;
@@ -304,10 +339,19 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                 if ( !event.GetConditions().empty() )
                     ifPredicat = codeGenerator.GenerateBooleanFullName("condition"+ToString(event.GetConditions().size()-1)+"IsTrue", context)+".val";
 
+                //The loop can be bounded so that a While event which never ends does not freeze the game.
+                gdjs::EventsCodeGenerator * jsCodeGenerator = dynamic_cast<gdjs::EventsCodeGenerator*>(&codeGenerator);
+                unsigned int iterationsLimit = jsCodeGenerator ? jsCodeGenerator->GetWhileIterationsLimit() : 0;
+
                 //Write final code
-                std::string whileBoolean = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                    +"Code.stopDoWhile"+gd::ToString(context.GetContextDepth());
+                std::string whileBoolean = GetCodeNamespace(codeGenerator)+"stopDoWhile"+gd::ToString(context.GetContextDepth());
                 codeGenerator.AddGlobalDeclaration(whileBoolean+" = false;\n");
+                std::string whileIterationsCount = GetCodeNamespace(codeGenerator)+"doWhileIterations"+gd::ToString(context.GetContextDepth());
+                if ( iterationsLimit != 0 )
+                {
+                    codeGenerator.AddGlobalDeclaration(whileIterationsCount+" = 0;\n");
+                    outputCode += whileIterationsCount+" = 0;\n";
+                }
                 outputCode += whileBoolean+" = false;\n";
                 outputCode += "do {";
                 outputCode += codeGenerator.GenerateObjectsDeclarationCode(context);
@@ -322,7 +366,17 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                 outputCode += "}\n";
                 outputCode += "} else "+whileBoolean+" = true; \n";
 
-                outputCode += "} while ( !"+whileBoolean+" );\n";
+                if ( iterationsLimit != 0 )
+                {
+                    //The loop was exited without its conditions being false: the limit was reached.
+                    std::string limit = gd::ToString(iterationsLimit);
+                    outputCode += "} while ( !"+whileBoolean+" && ++"+whileIterationsCount+" < "+limit+" );\n";
+                    std::string eventPath = jsCodeGenerator ? jsCodeGenerator->GetEventPath(event_) : "";
+                    outputCode += "if ( !"+whileBoolean+" ) gdjs.EventsContext.onWhileIterationsLimitReached(runtimeScene, "
+                        "\""+codeGenerator.ConvertToString(eventPath)+"\", "+limit+");\n";
+                }
+                else
+                    outputCode += "} while ( !"+whileBoolean+" );\n";
 
                 return outputCode;
             }
@@ -366,11 +420,9 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                 std::string objectDeclaration = codeGenerator.GenerateObjectsDeclarationCode(context)+"\n";
 
                 //Write final code
-                std::string repeatCountVar = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                    +"Code.repeatCount"+gd::ToString(context.GetContextDepth());
+                std::string repeatCountVar = GetCodeNamespace(codeGenerator)+"repeatCount"+gd::ToString(context.GetContextDepth());
                 codeGenerator.AddGlobalDeclaration(repeatCountVar+" = 0;\n");
-                std::string repeatIndexVar = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                    +"Code.repeatIndex"+gd::ToString(context.GetContextDepth());
+                std::string repeatIndexVar = GetCodeNamespace(codeGenerator)+"repeatIndex"+gd::ToString(context.GetContextDepth());
                 codeGenerator.AddGlobalDeclaration(repeatIndexVar+" = 0;\n");
                 outputCode += repeatCountVar+" = "+repeatCountCode+";\n";
                 outputCode += "for("+repeatIndexVar+" = 0;"+repeatIndexVar+" < "+repeatCountVar+";++"+repeatIndexVar+") {\n";
@@ -454,14 +506,11 @@ CommonInstructionsExtension::CommonInstructionsExtension()
 
                 std::string objectDeclaration = codeGenerator.GenerateObjectsDeclarationCode(context)+"\n";
 
-                std::string forEachTotalCountVar = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                    +"Code.forEachTotalCount"+gd::ToString(context.GetContextDepth());
+                std::string forEachTotalCountVar = GetCodeNamespace(codeGenerator)+"forEachTotalCount"+gd::ToString(context.GetContextDepth());
                 codeGenerator.AddGlobalDeclaration(forEachTotalCountVar+" = 0;\n");
-                std::string forEachIndexVar = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                    +"Code.forEachIndex"+gd::ToString(context.GetContextDepth());
+                std::string forEachIndexVar = GetCodeNamespace(codeGenerator)+"forEachIndex"+gd::ToString(context.GetContextDepth());
                 codeGenerator.AddGlobalDeclaration(forEachIndexVar+" = 0;\n");
-                std::string forEachObjectsList = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                    +"Code.forEachObjects"+gd::ToString(context.GetContextDepth());
+                std::string forEachObjectsList = GetCodeNamespace(codeGenerator)+"forEachObjects"+gd::ToString(context.GetContextDepth());
                 codeGenerator.AddGlobalDeclaration(forEachObjectsList+" = [];\n");
 
 
@@ -471,8 +520,7 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                     outputCode += forEachObjectsList+".length = 0;\n";
                     for (unsigned int i = 0;i<realObjects.size();++i)
                     {
-                        std::string forEachCountVar = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                            +"Code.forEachCount"+gd::ToString(i)+"_"+gd::ToString(context.GetContextDepth());
+                        std::string forEachCountVar = GetCodeNamespace(codeGenerator)+"forEachCount"+gd::ToString(i)+"_"+gd::ToString(context.GetContextDepth());
                         codeGenerator.AddGlobalDeclaration(forEachCountVar+" = 0;\n");
 
                         outputCode += forEachCountVar+" = "+codeGenerator.GetObjectListName(realObjects[i], parentContext)+".length;\n";
@@ -494,8 +542,7 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                 //Clear all concerned objects lists and keep only one object
                 if ( realObjects.size() == 1 )
                 {
-                    std::string temporary = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                        +"Code.forEachTemporary"+gd::ToString(context.GetContextDepth());
+                    std::string temporary = GetCodeNamespace(codeGenerator)+"forEachTemporary"+gd::ToString(context.GetContextDepth());
                     codeGenerator.AddGlobalDeclaration(temporary+" = null;\n");
                     outputCode += temporary+" = "+codeGenerator.GetObjectListName(realObjects[0], parentContext)+"["+forEachIndexVar+"];\n";
                     outputCode += codeGenerator.GetObjectListName(realObjects[0], context)+".length = 0;\n";
@@ -512,8 +559,7 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                         std::string count;
                         for (unsigned int j = 0;j<=i;++j)
                         {
-                            std::string forEachCountVar = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(codeGenerator.GetLayout().GetName())
-                                +"Code.forEachCount"+gd::ToString(j)+"_"+gd::ToString(context.GetContextDepth());
+                            std::string forEachCountVar = GetCodeNamespace(codeGenerator)+"forEachCount"+gd::ToString(j)+"_"+gd::ToString(context.GetContextDepth());
 
                             if (j!=0) count+= "+";
                             count += forEachCountVar;
@@ -547,26 +593,20 @@ CommonInstructionsExtension::CommonInstructionsExtension()
         GetAllEvents()["BuiltinCommonInstructions::ForEach"].codeGeneration = boost::shared_ptr<gd::EventMetadata::CodeGenerator>(codeGen);
     }
 
-    {/*
+    {
         class CodeGen : public gd::EventMetadata::CodeGenerator
         {
             virtual std::string Generate(gd::BaseEvent & event_, gd::EventsCodeGenerator & codeGenerator, gd::EventsCodeGenerationContext & parentContext)
             {
-                CppCodeEvent & event = dynamic_cast<CppCodeEvent&>(event_);
+                JsCodeEvent & event = dynamic_cast<JsCodeEvent&>(event_);
 
                 const gd::Project & project = codeGenerator.GetProject();
                 const gd::Layout & scene = codeGenerator.GetLayout();
 
-                //Generate the code to call the associated source file
-                std::string functionPrototype = "void "+event.GetFunctionToCall()+"("+ (event.GetPassSceneAsParameter() ? "RuntimeScene & scene" :"")
-                                                + ((event.GetPassSceneAsParameter() && event.GetPassObjectListAsParameter()) ? ", ":"")
-                                                + (event.GetPassObjectListAsParameter() ? "std::vector<RuntimeObject*> objectsList" :"") + ");";
-                codeGenerator.AddGlobalDeclaration(functionPrototype+"\n");
-
-                std::string outputCode;
-                outputCode += "{";
+                codeGenerator.AddIncludeFiles(event.GetIncludeFiles());
 
                 //Prepare objects list if needed
+                std::string objectsList = "[]";
                 if ( event.GetPassObjectListAsParameter() )
                 {
                     std::string objectToPassAsParameter = event.GetObjectToPassAsParameter();
@@ -578,7 +618,7 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                                                                                    scene.GetObjectGroups().end(), bind2nd(gd::GroupHasTheSameName(),
                                                                                                                           objectToPassAsParameter));
 
-                    std::vector<std::string> realObjects; //With groups, we may have to generate condition for more than one object list.
+                    std::vector<std::string> realObjects; //With groups, we may have to pass more than one object list.
                     if ( globalGroup != project.GetObjectGroups().end() )
                         realObjects = (*globalGroup).GetAllObjectsNames();
                     else if ( sceneGroup != scene.GetObjectGroups().end() )
@@ -589,28 +629,50 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                     //Ensure that all returned objects actually exists.
                     for (unsigned int i = 0; i < realObjects.size();)
                     {
-                        if ( !codeGenerator.GetLayout().HasObjectNamed(realObjects[i]) && !codeGenerator.GetProject().HasObjectNamed(realObjects[i]) )
+                        if ( !scene.HasObjectNamed(realObjects[i]) && !project.HasObjectNamed(realObjects[i]) )
                             realObjects.erase(realObjects.begin()+i);
                         else
                             ++i;
                     }
 
-                    if ( realObjects.empty() ) return "";
-
-                    outputCode += "std::vector<RuntimeObject*> functionObjects;";
                     for (unsigned int i = 0;i<realObjects.size();++i)
                     {
                         parentContext.ObjectsListNeeded(realObjects[i]);
-                        outputCode += "functionObjects.insert("+ string(i == 0 ? "functionObjects.begin()" : "functionObjects.end()") +", "+ManObjListName(realObjects[i])+".begin(), "+ManObjListName(realObjects[i])+".end());";
+                        if ( i == 0 )
+                            objectsList = codeGenerator.GetObjectListName(realObjects[i], parentContext);
+                        else if ( i == 1 )
+                            objectsList += ".concat("+codeGenerator.GetObjectListName(realObjects[i], parentContext);
+                        else
+                            objectsList += ", "+codeGenerator.GetObjectListName(realObjects[i], parentContext);
                     }
+                    if ( realObjects.size() > 1 ) objectsList += ")";
                 }
 
-                std::string functionCall = event.GetFunctionToCall()+"("+ (event.GetPassSceneAsParameter() ? "*runtimeContext->scene" :"")
-                                           +((event.GetPassSceneAsParameter() && event.GetPassObjectListAsParameter()) ? ", ":"")
-                                           +(event.GetPassObjectListAsParameter() ? "functionObjects" :"") + ");";
-                outputCode += ""+functionCall+"\n";
+                std::string outputCode;
+                gdjs::EventsCodeGenerator * jsCodeGenerator = dynamic_cast<gdjs::EventsCodeGenerator*>(&codeGenerator);
+                if ( jsCodeGenerator && event.CanBeInlined() )
+                {
+                    //Insert the code directly in the events, after declaring the parameters. CanBeInlined ensures the code
+                    //neither declares variables nor uses those of the events. The parameters get unique names, so that they
+                    //are not shared with the other events inlined in the same function.
+                    std::string sceneName = jsCodeGenerator->GenerateUniqueVariableName("jsCodeScene");
+                    std::string objectsListName = jsCodeGenerator->GenerateUniqueVariableName("jsCodeObjectsList");
+
+                    outputCode += "{\n";
+                    if ( event.GetPassSceneAsParameter() ) outputCode += "var "+sceneName+" = runtimeScene;\n";
+                    if ( event.GetPassObjectListAsParameter() ) outputCode += "var "+objectsListName+" = "+objectsList+";\n";
+                    outputCode += event.GetInlinedCode(sceneName, objectsListName);
+                    outputCode += "\n}\n";
+                }
+                else
+                {
+                    //The code is put into a function, declared along with the events, and called by the events.
+                    codeGenerator.AddGlobalDeclaration(event.GenerateAssociatedFileCode());
+                    outputCode += event.GetFunctionToCall()+"("+(event.GetPassSceneAsParameter() ? "runtimeScene" : "")
+                        +((event.GetPassSceneAsParameter() && event.GetPassObjectListAsParameter()) ? ", " : "")
+                        +(event.GetPassObjectListAsParameter() ? objectsList : "")+");\n";
+                }
 
-                outputCode += "}";
                 return outputCode;
             }
         };
@@ -622,7 +684,7 @@ CommonInstructionsExtension::CommonInstructionsExtension()
                   "",
                   "res/source_cpp16.png",
                   boost::shared_ptr<gd::BaseEvent>(new JsCodeEvent))
-                  .SetCodeGenerator(boost::shared_ptr<gd::EventMetadata::CodeGenerator>(codeGen));*/
+                  .SetCodeGenerator(boost::shared_ptr<gd::EventMetadata::CodeGenerator>(codeGen));
     }
 }
 
@@ -0,0 +1,276 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#if defined(WINDOWS)
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+#include "GDJS/CLI/HeadlessFileSystem.h"
+#undef CopyFile //Disable an annoying macro
+
+namespace gdjs
+{
+
+/**
+ * \brief Split a normalized path into its components.
+ */
+static std::vector<std::string> SplitPath(const std::string & path)
+{
+    std::vector<std::string> components;
+    size_t start = 0;
+    while ( start <= path.size() )
+    {
+        size_t end = path.find('/', start);
+        if ( end == std::string::npos ) end = path.size();
+        if ( end > start ) components.push_back(path.substr(start, end-start));
+        start = end+1;
+    }
+
+    return components;
+}
+
+/**
+ * \brief Return true if the path is a directory, and not a link to a directory.
+ */
+static bool IsRealDirectory(const std::string & path)
+{
+    struct stat info;
+    #if defined(WINDOWS)
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    #else
+    return lstat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    #endif
+}
+
+static std::string ToLower(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
+}
+
+HeadlessFileSystem::HeadlessFileSystem(const std::string & tempDir_) :
+    tempDir(tempDir_)
+{
+}
+
+std::string HeadlessFileSystem::NormalizePath(const std::string & path)
+{
+    std::string unixPath = path;
+    #if defined(WINDOWS)
+    std::replace(unixPath.begin(), unixPath.end(), '\\', '/');
+    #endif
+
+    //Keep the root ( "/" or a drive letter ) as is.
+    std::string root;
+    size_t rootLength = 0;
+    if ( !unixPath.empty() && unixPath[0] == '/' ) { root = "/"; rootLength = 1; }
+    #if defined(WINDOWS)
+    else if ( unixPath.size() >= 2 && unixPath[1] == ':' ) { root = unixPath.substr(0, 2)+"/"; rootLength = 2; }
+    #endif
+
+    std::vector<std::string> components = SplitPath(unixPath.substr(rootLength));
+    std::vector<std::string> normalized;
+    for (unsigned int i = 0;i<components.size();++i)
+    {
+        if ( components[i] == "." ) continue;
+        if ( components[i] == ".." && !normalized.empty() && normalized.back() != ".." )
+            normalized.pop_back();
+        else if ( components[i] != ".." || root.empty() ) //".." at the root is the root itself.
+            normalized.push_back(components[i]);
+    }
+
+    std::string result = root;
+    for (unsigned int i = 0;i<normalized.size();++i)
+        result += (i != 0 ? "/" : "")+normalized[i];
+
+    return result.empty() ? "." : result;
+}
+
+std::string HeadlessFileSystem::GetCurrentDir()
+{
+    char buffer[4096];
+    #if defined(WINDOWS)
+    if ( !_getcwd(buffer, sizeof(buffer)) ) return ".";
+    #else
+    if ( !getcwd(buffer, sizeof(buffer)) ) return ".";
+    #endif
+
+    return NormalizePath(buffer);
+}
+
+bool HeadlessFileSystem::MkDir(const std::string & path)
+{
+    if ( path.empty() || DirExists(path) ) return true;
+
+    std::string parent = DirNameFrom(NormalizePath(path));
+    if ( !parent.empty() && parent != path && !MkDir(parent) ) return false;
+
+    #if defined(WINDOWS)
+    return _mkdir(path.c_str()) == 0 || DirExists(path);
+    #else
+    return mkdir(path.c_str(), 0777) == 0 || DirExists(path);
+    #endif
+}
+
+bool HeadlessFileSystem::DirExists(const std::string & path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+bool HeadlessFileSystem::ClearDir(const std::string & directory)
+{
+    DIR * dir = opendir(directory.c_str());
+    if ( !dir ) return false;
+
+    bool success = true;
+    std::vector<std::string> entries;
+    while ( struct dirent * entry = readdir(dir) )
+    {
+        std::string name = entry->d_name;
+        if ( name != "." && name != ".." ) entries.push_back(directory+"/"+name);
+    }
+    closedir(dir);
+
+    for (unsigned int i = 0;i<entries.size();++i)
+    {
+        //Links are removed, never the files they point to.
+        if ( IsRealDirectory(entries[i]) ) success = RemoveDir(entries[i]) && success;
+        else success = remove(entries[i].c_str()) == 0 && success;
+    }
+
+    return success;
+}
+
+bool HeadlessFileSystem::RemoveDir(const std::string & directory)
+{
+    if ( !ClearDir(directory) ) return false;
+
+    #if defined(WINDOWS)
+    return _rmdir(directory.c_str()) == 0;
+    #else
+    return rmdir(directory.c_str()) == 0;
+    #endif
+}
+
+std::string HeadlessFileSystem::FileNameFrom(const std::string & file)
+{
+    size_t separator = file.find_last_of("/\\");
+    return separator != std::string::npos ? file.substr(separator+1) : file;
+}
+
+std::string HeadlessFileSystem::DirNameFrom(const std::string & file)
+{
+    size_t separator = file.find_last_of("/\\");
+    if ( separator == std::string::npos ) return "";
+
+    return separator == 0 ? "/" : file.substr(0, separator);
+}
+
+bool HeadlessFileSystem::IsAbsolute(const std::string & filename)
+{
+    if ( filename.empty() ) return false;
+
+    #if defined(WINDOWS)
+    if ( filename.size() >= 2 && filename[1] == ':' ) return true;
+    if ( filename[0] == '\\' ) return true;
+    #endif
+    return filename[0] == '/';
+}
+
+bool HeadlessFileSystem::MakeAbsolute(std::string & filename, const std::string & baseDirectory)
+{
+    if ( !IsAbsolute(filename) ) filename = baseDirectory+"/"+filename;
+    filename = NormalizePath(filename);
+
+    return true;
+}
+
+bool HeadlessFileSystem::MakeRelative(std::string & filename, const std::string & baseDirectory)
+{
+    std::vector<std::string> file = SplitPath(NormalizePath(filename));
+    std::vector<std::string> base = SplitPath(NormalizePath(baseDirectory));
+
+    unsigned int common = 0;
+    while ( common < file.size() && common < base.size() && file[common] == base[common] )
+        ++common;
+
+    std::string relative;
+    for (unsigned int i = common;i<base.size();++i)
+        relative += "../";
+    for (unsigned int i = common;i<file.size();++i)
+        relative += file[i]+(i+1 < file.size() ? "/" : "");
+
+    filename = relative;
+    return true;
+}
+
+bool HeadlessFileSystem::CopyFile(const std::string & file, const std::string & destination)
+{
+    std::ifstream source(file.c_str(), std::ios::in | std::ios::binary);
+    if ( !source.is_open() ) return false;
+
+    std::ofstream copy(destination.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if ( !copy.is_open() ) return false;
+
+    if ( source.peek() != std::ifstream::traits_type::eof() ) copy << source.rdbuf(); //Nothing is written for empty files.
+    return !copy.fail();
+}
+
+bool HeadlessFileSystem::WriteToFile(const std::string & file, const std::string & content)
+{
+    std::ofstream stream(file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if ( !stream.is_open() ) return false;
+
+    stream.write(content.data(), content.size());
+    return !stream.fail();
+}
+
+std::string HeadlessFileSystem::ReadFile(const std::string & file)
+{
+    std::ifstream stream(file.c_str(), std::ios::in | std::ios::binary);
+    if ( !stream.is_open() ) return "";
+
+    return std::string((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+}
+
+std::vector<std::string> HeadlessFileSystem::ReadDir(const std::string & path, const std::string & extension)
+{
+    std::vector<std::string> files;
+    DIR * dir = opendir(path.c_str());
+    if ( !dir ) return files;
+
+    //Extensions are compared ignoring the case, as they are on Windows.
+    std::string lowerExtension = ToLower(extension);
+    while ( struct dirent * entry = readdir(dir) )
+    {
+        std::string name = entry->d_name;
+        std::string filename = path+"/"+name;
+        if ( name == "." || name == ".." || DirExists(filename) ) continue;
+
+        if ( lowerExtension.empty() ||
+            (name.size() >= lowerExtension.size() && ToLower(name.substr(name.size()-lowerExtension.size())) == lowerExtension) )
+            files.push_back(filename);
+    }
+    closedir(dir);
+
+    return files;
+}
+
+bool HeadlessFileSystem::FileExists(const std::string & filename)
+{
+    struct stat info;
+    return stat(filename.c_str(), &info) == 0 && !S_ISDIR(info.st_mode);
+}
+
+}
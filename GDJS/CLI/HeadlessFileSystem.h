@@ -0,0 +1,67 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef HEADLESSFILESYSTEM_H
+#define HEADLESSFILESYSTEM_H
+#include <string>
+#include <vector>
+#include "GDCore/IDE/AbstractFileSystem.h"
+#undef CopyFile //Disable an annoying macro
+
+namespace gdjs
+{
+
+/**
+ * \brief Implementation of gd::AbstractFileSystem using only the C/POSIX functions,
+ * for the tools running without wxWidgets ( see the command line exporter ).
+ *
+ * Paths are handled with "/" as separator ( "\\" is also accepted on Windows ).
+ */
+class HeadlessFileSystem : public gd::AbstractFileSystem
+{
+public:
+    /**
+     * \param tempDir The directory returned by GetTempDir. Tools running several exports at
+     * the same time must give a different directory to each of them.
+     */
+    HeadlessFileSystem(const std::string & tempDir);
+    virtual ~HeadlessFileSystem() {};
+
+    virtual bool MkDir(const std::string & path);
+    virtual bool DirExists(const std::string & path);
+    virtual bool ClearDir(const std::string & directory);
+    virtual std::string GetTempDir() { return tempDir; };
+    virtual std::string FileNameFrom(const std::string & file);
+    virtual std::string DirNameFrom(const std::string & file);
+    virtual bool MakeAbsolute(std::string & filename, const std::string & baseDirectory);
+    virtual bool MakeRelative(std::string & filename, const std::string & baseDirectory);
+    virtual bool IsAbsolute(const std::string & filename);
+    virtual bool CopyFile(const std::string & file, const std::string & destination);
+    virtual bool WriteToFile(const std::string & file, const std::string & content);
+    virtual std::string ReadFile(const std::string & file);
+    virtual std::vector<std::string> ReadDir(const std::string & path, const std::string & extension = "");
+    virtual bool FileExists(const std::string & filename);
+
+    /**
+     * \brief Remove a directory and all its content.
+     */
+    bool RemoveDir(const std::string & directory);
+
+    /**
+     * \brief Return the path with the "." and ".." components resolved, and with "/" as separator.
+     */
+    static std::string NormalizePath(const std::string & path);
+
+    /**
+     * \brief Return the current working directory.
+     */
+    static std::string GetCurrentDir();
+
+private:
+    std::string tempDir;
+};
+
+}
+#endif // HEADLESSFILESYSTEM_H
@@ -0,0 +1,428 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+
+/*
+ * gdjs-export: export Game Develop projects to HTML5 games from the command line, without the IDE.
+ * It is built with GD_NO_WX_GUI ( see the GDJS_NO_WX_GUI option of CMakeLists.txt ), so that it can
+ * run on machines without display, like build servers.
+ *
+ * The projects are exported in parallel, each one in its own process.
+ * Texture atlases and precompressed files are not available, as they require wxWidgets.
+ * The exit status is 0 if all the projects were exported, 1 if at least one export failed,
+ * and 2 if the command line is invalid.
+ */
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#if defined(WINDOWS)
+#include <direct.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+#include <boost/shared_ptr.hpp>
+#include "GDCore/PlatformDefinition/Project.h"
+#include "GDCore/PlatformDefinition/Layout.h"
+#include "GDCore/PlatformDefinition/Platform.h"
+#include "GDCore/IDE/PlatformManager.h"
+#include "GDJS/JsPlatform.h"
+#include "GDJS/Exporter.h"
+#include "GDJS/CLI/HeadlessFileSystem.h"
+
+using namespace gdjs;
+
+/**
+ * \brief The options given on the command line.
+ */
+struct Options
+{
+    Options() : jobs(0), whileIterationsLimit(0), minify(false), hashedFilenames(false), serviceWorker(false), report(false) {};
+
+    std::vector<std::string> projectFiles; ///< The projects to export ( absolute paths ).
+    std::string outputDir; ///< The directory where the projects are exported ( absolute path ).
+    std::string gdDir; ///< The directory of Game Develop, containing JsPlatform/Runtime and CppPlatform/Extensions.
+    std::string layout; ///< If not empty, only this layout is exported, like for a preview.
+    std::string codeSizeReportFile; ///< If not empty, the file where the code size report is written ( absolute path ).
+    unsigned int jobs; ///< The maximum number of projects exported at the same time ( 0 to use the number of processors ).
+    unsigned int whileIterationsLimit; ///< The maximum number of iterations of While events ( 0 for no limit ).
+    bool minify;
+    bool hashedFilenames;
+    bool serviceWorker;
+    bool report;
+};
+
+/**
+ * \brief Destroy the JS platform when the platform manager is destroyed ( the platform is a singleton ).
+ */
+struct PlatformDestroyer
+{
+    void operator()(gd::Platform *) { JsPlatform::DestroySingleton(); }
+};
+
+static void PrintUsage()
+{
+    std::cout << "Usage: gdjs-export [options] project.gdg [project2.gdg...]" << std::endl
+        << std::endl
+        << "Export Game Develop projects to HTML5 games, in parallel." << std::endl
+        << std::endl
+        << "Options:" << std::endl
+        << "  -o, --output DIR        Export directory ( default: \"export\" ). When several projects" << std::endl
+        << "                          are exported, each one is exported in DIR/<project file name>" << std::endl
+        << "                          ( followed by -2, -3... if several projects have the same file name )." << std::endl
+        << "  -l, --layout NAME       Only export the layout NAME, like for a preview." << std::endl
+        << "  -j, --jobs N            Export at most N projects at the same time ( default: number of processors )." << std::endl
+        << "  --gd-dir DIR            Directory of Game Develop, containing JsPlatform/Runtime" << std::endl
+        << "                          ( default: the directory of gdjs-export )." << std::endl
+        << "  --minify                Minify the exported code." << std::endl
+        << "  --hashed-filenames      Put the hash of their content in the names of the exported files." << std::endl
+        << "  --service-worker        Generate a service worker caching the game." << std::endl
+        << "  --while-limit N         Stop the loops of While events after N iterations ( default: no limit )." << std::endl
+        << "  --report                Write a report of the stages of each export in <export directory>-report.json." << std::endl
+        << "  --code-size-report FILE Write a report of the size of the generated code in FILE. When several" << std::endl
+        << "                          projects are exported, the name of their export directory is added to FILE." << std::endl
+        << "  -h, --help              Show this help." << std::endl;
+}
+
+static bool ChangeDir(const std::string & directory)
+{
+    #if defined(WINDOWS)
+    return _chdir(directory.c_str()) == 0;
+    #else
+    return chdir(directory.c_str()) == 0;
+    #endif
+}
+
+static unsigned int GetProcessorsCount()
+{
+    #if defined(WINDOWS)
+    const char * count = getenv("NUMBER_OF_PROCESSORS");
+    return count ? std::max(atoi(count), 1) : 1;
+    #else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<unsigned int>(count) : 1;
+    #endif
+}
+
+static std::string GetTempDirFor(unsigned int projectIndex)
+{
+    #if defined(WINDOWS)
+    const char * temp = getenv("TEMP");
+    std::string tempDir = temp ? temp : ".";
+    #else
+    const char * temp = getenv("TMPDIR");
+    std::string tempDir = temp ? temp : "/tmp";
+    #endif
+
+    //Each export has its own directory, as the code is generated in the temporary directory.
+    std::ostringstream dir;
+    #if defined(WINDOWS)
+    dir << tempDir << "/gdjs-export-" << projectIndex;
+    #else
+    dir << tempDir << "/gdjs-export-" << getpid() << "-" << projectIndex;
+    #endif
+    return dir.str();
+}
+
+/**
+ * \brief Return the string in lower case.
+ */
+static std::string ToLower(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+    return str;
+}
+
+/**
+ * \brief Return the name of the file, without its directory and its extension.
+ */
+static std::string GetBaseName(HeadlessFileSystem & fs, const std::string & filename)
+{
+    std::string name = fs.FileNameFrom(filename);
+    size_t dot = name.find_last_of('.');
+    return dot != std::string::npos && dot != 0 ? name.substr(0, dot) : name;
+}
+
+/**
+ * \brief Return the directory where a project is exported.
+ *
+ * When several projects are exported, each project is exported in a directory named after its file.
+ * Projects with the same file name ( "a/game.gdg" and "b/game.gdg" ) are exported in "game", "game-2"...
+ * in the order of the command line. Names are compared ignoring the case, as on Windows and OS X.
+ */
+static std::string GetExportDir(HeadlessFileSystem & fs, const Options & options, unsigned int projectIndex)
+{
+    if ( options.projectFiles.size() == 1 ) return options.outputDir;
+
+    std::vector<std::string> usedNames;
+    std::string name;
+    for (unsigned int i = 0;i<=projectIndex && i<options.projectFiles.size();++i)
+    {
+        std::string baseName = GetBaseName(fs, options.projectFiles[i]);
+        name = baseName;
+        for (unsigned int suffix = 2;std::find(usedNames.begin(), usedNames.end(), ToLower(name)) != usedNames.end();++suffix)
+        {
+            std::ostringstream suffixedName;
+            suffixedName << baseName << "-" << suffix;
+            name = suffixedName.str();
+        }
+        usedNames.push_back(ToLower(name));
+    }
+
+    return options.outputDir+"/"+name;
+}
+
+/**
+ * \brief Return the file where the code size report of a project is written.
+ *
+ * When several projects are exported, the name of the export directory of each project is added
+ * to the name of the file ( "sizes.json" becomes "sizes-game.json", "sizes-game-2.json"... ).
+ */
+static std::string GetCodeSizeReportFile(HeadlessFileSystem & fs, const Options & options, unsigned int projectIndex)
+{
+    if ( options.projectFiles.size() == 1 || options.codeSizeReportFile.empty() ) return options.codeSizeReportFile;
+
+    std::string suffix = "-"+fs.FileNameFrom(GetExportDir(fs, options, projectIndex));
+    std::string name = fs.FileNameFrom(options.codeSizeReportFile);
+    size_t dot = name.find_last_of('.');
+    if ( dot == std::string::npos || dot == 0 ) return options.codeSizeReportFile+suffix;
+
+    return options.codeSizeReportFile.substr(0, options.codeSizeReportFile.length()-name.length()+dot)+suffix+name.substr(dot);
+}
+
+/**
+ * \brief Parse the command line.
+ * \return false if the command line is invalid.
+ */
+static bool ParseCommandLine(int argc, char ** argv, Options & options, bool & showHelp)
+{
+    HeadlessFileSystem fs("");
+    std::string currentDir = HeadlessFileSystem::GetCurrentDir();
+    std::string outputDir = "export";
+
+    //By default, Game Develop files are searched in the directory of the executable.
+    std::string executable = argc > 0 ? argv[0] : "";
+    std::string gdDir = fs.DirNameFrom(executable);
+    if ( gdDir.empty() ) gdDir = ".";
+
+    for (int i = 1;i<argc;++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if ( arg == "-h" || arg == "--help" ) showHelp = true;
+        else if ( arg == "--minify" ) options.minify = true;
+        else if ( arg == "--hashed-filenames" ) options.hashedFilenames = true;
+        else if ( arg == "--service-worker" ) options.serviceWorker = true;
+        else if ( arg == "--report" ) options.report = true;
+        else if ( (arg == "-o" || arg == "--output") && hasValue ) outputDir = argv[++i];
+        else if ( (arg == "-l" || arg == "--layout") && hasValue ) options.layout = argv[++i];
+        else if ( arg == "--gd-dir" && hasValue ) gdDir = argv[++i];
+        else if ( arg == "--code-size-report" && hasValue )
+        {
+            options.codeSizeReportFile = argv[++i];
+            fs.MakeAbsolute(options.codeSizeReportFile, currentDir);
+        }
+        else if ( (arg == "-j" || arg == "--jobs") && hasValue )
+        {
+            int jobs = atoi(argv[++i]);
+            if ( jobs <= 0 )
+            {
+                std::cerr << "Invalid number of jobs: " << argv[i] << std::endl;
+                return false;
+            }
+            options.jobs = jobs;
+        }
+        else if ( arg == "--while-limit" && hasValue )
+        {
+            int limit = atoi(argv[++i]);
+            if ( limit <= 0 )
+            {
+                std::cerr << "Invalid number of iterations: " << argv[i] << std::endl;
+                return false;
+            }
+            options.whileIterationsLimit = limit;
+        }
+        else if ( !arg.empty() && arg[0] == '-' )
+        {
+            std::cerr << "Unknown option, or missing value: " << arg << std::endl;
+            return false;
+        }
+        else
+        {
+            fs.MakeAbsolute(arg, currentDir);
+            options.projectFiles.push_back(arg);
+        }
+    }
+
+    //Paths are made absolute as the working directory is changed to the directory of Game Develop.
+    fs.MakeAbsolute(outputDir, currentDir);
+    fs.MakeAbsolute(gdDir, currentDir);
+    options.outputDir = outputDir;
+    options.gdDir = gdDir;
+    if ( options.jobs == 0 ) options.jobs = GetProcessorsCount();
+
+    if ( options.projectFiles.empty() && !showHelp )
+    {
+        std::cerr << "No project to export." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Load and export a project.
+ * \return true if the project was exported.
+ */
+static bool ExportProject(const Options & options, unsigned int projectIndex)
+{
+    const std::string & projectFile = options.projectFiles[projectIndex];
+    std::string tempDir = GetTempDirFor(projectIndex);
+    HeadlessFileSystem fs(tempDir);
+    fs.MkDir(tempDir);
+
+    gd::Project project;
+    if ( !fs.FileExists(projectFile) || !project.LoadFromFile(projectFile) )
+    {
+        std::cerr << "Unable to load the project " << projectFile << std::endl;
+        fs.RemoveDir(tempDir);
+        return false;
+    }
+    project.SetProjectFile(projectFile);
+
+    std::string exportDir = GetExportDir(fs, options, projectIndex);
+    Exporter exporter(fs);
+    exporter.SetHashedFilenamesUsed(options.hashedFilenames);
+    exporter.SetServiceWorkerGenerated(options.serviceWorker);
+    exporter.SetWhileIterationsLimit(options.whileIterationsLimit);
+    if ( options.report ) exporter.SetExportReportFile(exportDir+"-report.json");
+    exporter.SetCodeSizeReportFile(GetCodeSizeReportFile(fs, options, projectIndex));
+
+    bool success = false;
+    if ( !options.layout.empty() )
+    {
+        if ( !project.HasLayoutNamed(options.layout) )
+            std::cerr << "The project " << projectFile << " has no layout called \"" << options.layout << "\"." << std::endl;
+        else
+            success = exporter.ExportLayoutForPreview(project, project.GetLayout(options.layout), exportDir);
+    }
+    else
+        success = exporter.ExportWholeProject(project, exportDir, options.minify, false, false, false);
+
+    if ( !success && !exporter.GetLastError().empty() )
+        std::cerr << "Error while exporting " << projectFile << ": " << exporter.GetLastError() << std::endl;
+
+    fs.RemoveDir(tempDir);
+    return success;
+}
+
+static void PrintResult(const Options & options, unsigned int projectIndex, bool success)
+{
+    HeadlessFileSystem fs("");
+    if ( success )
+        std::cout << "Exported " << options.projectFiles[projectIndex] << " to " << GetExportDir(fs, options, projectIndex) << std::endl;
+    else
+        std::cout << "FAILED to export " << options.projectFiles[projectIndex] << std::endl;
+}
+
+/**
+ * \brief Export all the projects, running at most options.jobs exports at the same time.
+ * \return The number of projects which could not be exported.
+ */
+static unsigned int ExportProjects(const Options & options)
+{
+    unsigned int failures = 0;
+    unsigned int next = 0;
+
+    #if !defined(WINDOWS)
+    //Each project is exported in a child process: the exports do not share any state, and the
+    //platform and its extensions, already loaded, are shared by all the processes.
+    std::map<pid_t, unsigned int> children;
+    while ( next < options.projectFiles.size() || !children.empty() )
+    {
+        while ( next < options.projectFiles.size() && children.size() < options.jobs )
+        {
+            std::cout.flush(); std::cerr.flush();
+            pid_t pid = fork();
+            if ( pid == 0 )
+            {
+                bool success = ExportProject(options, next);
+                std::cout.flush(); std::cerr.flush();
+                _exit(success ? 0 : 1);
+            }
+            else if ( pid < 0 ) //The project is exported by this process if a process can't be created.
+            {
+                bool success = ExportProject(options, next);
+                PrintResult(options, next, success);
+                if ( !success ) failures++;
+            }
+            else
+                children[pid] = next;
+
+            next++;
+        }
+
+        if ( children.empty() ) continue;
+
+        int status = 0;
+        pid_t pid = wait(&status);
+        if ( pid < 0 ) break;
+
+        std::map<pid_t, unsigned int>::iterator child = children.find(pid);
+        if ( child == children.end() ) continue;
+
+        bool success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        PrintResult(options, child->second, success);
+        if ( !success ) failures++;
+        children.erase(child);
+    }
+    #endif
+
+    //Without processes, the projects are exported one after the other.
+    for (;next<options.projectFiles.size();++next)
+    {
+        bool success = ExportProject(options, next);
+        PrintResult(options, next, success);
+        if ( !success ) failures++;
+    }
+
+    return failures;
+}
+
+int main(int argc, char ** argv)
+{
+    Options options;
+    bool showHelp = false;
+    if ( !ParseCommandLine(argc, argv, options, showHelp) )
+    {
+        PrintUsage();
+        return 2;
+    }
+    if ( showHelp )
+    {
+        PrintUsage();
+        return 0;
+    }
+
+    if ( !ChangeDir(options.gdDir) )
+    {
+        std::cerr << "Unable to go to the directory of Game Develop: " << options.gdDir << std::endl;
+        return 2;
+    }
+
+    //The platform must be known before loading the projects.
+    gd::PlatformManager::Get()->AddPlatform(boost::shared_ptr<gd::Platform>(&JsPlatform::Get(), PlatformDestroyer()));
+
+    unsigned int failures = ExportProjects(options);
+    std::cout << options.projectFiles.size()-failures << " project(s) exported, " << failures << " failed." << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
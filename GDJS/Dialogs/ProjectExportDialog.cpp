@@ -39,11 +39,6 @@ ProjectExportDialog::ProjectExportDialog(wxWindow* parent, gd::Project & project
     exportChoice->SetSelection(latestPage);
 
     hasJava = !Exporter::GetJavaExecutablePath().empty();
-    if ( !hasJava )
-    {
-        minifyCheck->Disable();
-        minifyCheck->SetValue(false);
-    }
 }
 
 ProjectExportDialog::~ProjectExportDialog()
@@ -107,9 +102,72 @@ std::string ProjectExportDialog::GetExportDir()
 
 bool ProjectExportDialog::RequestMinify()
 {
-    if (!hasJava) return false;
     return GetExportType() != Normal || minifyCheck->GetValue();
 }
 
+bool ProjectExportDialog::RequestClosureCompiler()
+{
+    bool useClosureCompiler = false;
+    wxConfigBase::Get()->Read("Export/JS platform/UseClosureCompiler", &useClosureCompiler, false);
+
+    return hasJava && useClosureCompiler;
+}
+
+bool ProjectExportDialog::RequestPrecompressedFiles()
+{
+    bool writePrecompressedFiles = false;
+    wxConfigBase::Get()->Read("Export/JS platform/WritePrecompressedFiles", &writePrecompressedFiles, false);
+
+    return GetExportType() == Normal && writePrecompressedFiles;
+}
+
+bool ProjectExportDialog::RequestTextureAtlases()
+{
+    bool useTextureAtlases = false;
+    wxConfigBase::Get()->Read("Export/JS platform/UseTextureAtlases", &useTextureAtlases, false);
+
+    return useTextureAtlases;
+}
+
+bool ProjectExportDialog::RequestHashedFilenames()
+{
+    bool useHashedFilenames = false;
+    wxConfigBase::Get()->Read("Export/JS platform/UseHashedFilenames", &useHashedFilenames, false);
+
+    return useHashedFilenames;
+}
+
+bool ProjectExportDialog::RequestServiceWorker()
+{
+    bool generateServiceWorker = false;
+    wxConfigBase::Get()->Read("Export/JS platform/GenerateServiceWorker", &generateServiceWorker, false);
+
+    return GetExportType() == Normal && generateServiceWorker;
+}
+
+unsigned int ProjectExportDialog::RequestWhileIterationsLimit()
+{
+    long whileIterationsLimit = 0;
+    wxConfigBase::Get()->Read("Export/JS platform/WhileIterationsLimit", &whileIterationsLimit, 0);
+
+    return whileIterationsLimit > 0 ? static_cast<unsigned int>(whileIterationsLimit) : 0;
+}
+
+std::string ProjectExportDialog::RequestExportReportFile()
+{
+    wxString exportReportFile;
+    wxConfigBase::Get()->Read("Export/JS platform/ExportReportFile", &exportReportFile, "");
+
+    return gd::ToString(exportReportFile);
+}
+
+std::string ProjectExportDialog::RequestCodeSizeReportFile()
+{
+    wxString codeSizeReportFile;
+    wxConfigBase::Get()->Read("Export/JS platform/CodeSizeReportFile", &codeSizeReportFile, "");
+
+    return gd::ToString(codeSizeReportFile);
+}
+
 }
 #endif
\ No newline at end of file
@@ -48,6 +48,64 @@ public:
      */
     bool RequestMinify();
 
+    /**
+     * \brief Check if the JS files must be minified with Google Closure Compiler rather than with
+     * the integrated minifier.
+     *
+     * Google Closure Compiler is used if Java is installed and if the "Export/JS platform/UseClosureCompiler"
+     * setting is enabled.
+     */
+    bool RequestClosureCompiler();
+
+    /**
+     * \brief Check if the gzip and brotli versions of the exported text files must be written.
+     *
+     * They are written for normal exports if the "Export/JS platform/WritePrecompressedFiles" setting is enabled.
+     */
+    bool RequestPrecompressedFiles();
+
+    /**
+     * \brief Check if the images of the sprites must be packed into texture atlases.
+     *
+     * They are packed if the "Export/JS platform/UseTextureAtlases" setting is enabled.
+     */
+    bool RequestTextureAtlases();
+
+    /**
+     * \brief Check if the hash of their content must be put in the filenames of the exported files.
+     *
+     * It is put if the "Export/JS platform/UseHashedFilenames" setting is enabled.
+     */
+    bool RequestHashedFilenames();
+
+    /**
+     * \brief Check if a service worker caching the files of the game must be generated.
+     *
+     * It is generated for normal exports if the "Export/JS platform/GenerateServiceWorker" setting is enabled.
+     */
+    bool RequestServiceWorker();
+
+    /**
+     * \brief Return the maximum number of iterations of the loops of While events ( see Exporter::SetWhileIterationsLimit ).
+     *
+     * It is set with the "Export/JS platform/WhileIterationsLimit" setting ( 0 by default: no limit ).
+     */
+    unsigned int RequestWhileIterationsLimit();
+
+    /**
+     * \brief Return the file where the report of the stages of the export must be written.
+     *
+     * It is set with the "Export/JS platform/ExportReportFile" setting ( empty by default: no report ).
+     */
+    std::string RequestExportReportFile();
+
+    /**
+     * \brief Return the file where the report of the size of the generated code must be written ( see Exporter::SetCodeSizeReportFile ).
+     *
+     * It is set with the "Export/JS platform/CodeSizeReportFile" setting ( empty by default: no report ).
+     */
+    std::string RequestCodeSizeReportFile();
+
 protected:
     virtual void OnBrowseBtClick(wxCommandEvent& event);
     virtual void OnCloseBtClicked(wxCommandEvent& event);
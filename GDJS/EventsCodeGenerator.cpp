@@ -3,6 +3,7 @@
  * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
  * This project is released under the GNU Lesser General Public License.
  */
+#include <algorithm>
 #include "GDCore/Events/EventsCodeGenerationContext.h"
 #include "GDCore/Events/EventMetadata.h"
 #include "GDCore/Events/InstructionMetadata.h"
@@ -10,6 +11,7 @@
 #include "GDCore/Events/ExpressionMetadata.h"
 #include "GDCore/IDE/MetadataProvider.h"
 #include "GDCore/IDE/SceneNameMangler.h"
+#include "GDCore/IDE/ArbitraryResourceWorker.h"
 #include "GDCore/PlatformDefinition/Object.h"
 #include "GDCore/PlatformDefinition/Automatism.h"
 #include "GDCore/PlatformDefinition/Project.h"
@@ -27,11 +29,30 @@ using namespace std;
 namespace gdjs
 {
 
+std::set<std::string> EventsCodeGenerator::pureObjectFunctions;
+
+static bool LongerStringFirst(const std::string & a, const std::string & b)
+{
+    return a.length() > b.length();
+}
+
+void EventsCodeSizes::AddInstructionsCode(const EventsCodeSizes & other)
+{
+    for (std::map<std::string, size_t>::const_iterator it = other.instructionsBytes.begin();it != other.instructionsBytes.end();++it)
+        instructionsBytes[it->first] += it->second;
+    for (std::map<std::string, size_t>::const_iterator it = other.instructionsCount.begin();it != other.instructionsCount.end();++it)
+        instructionsCount[it->first] += it->second;
+}
+
 std::string EventsCodeGenerator::GenerateSceneEventsCompleteCode(gd::Project & project,
                                                                  gd::Layout & scene,
                                                                  gd::EventsList & events,
                                                                  std::set < std::string > & includeFiles,
-                                                                 bool compilationForRuntime)
+                                                                 bool compilationForRuntime,
+                                                                 unsigned int whileIterationsLimit,
+                                                                 ExternalEventsFunctions * externalEventsFunctions,
+                                                                 EventsCodeSizes * codeSizes,
+                                                                 gd::ArbitraryResourceWorker * resourcesWorker)
 {
     string output = "gdjs."+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code = {};\n";
 
@@ -40,10 +61,32 @@ std::string EventsCodeGenerator::GenerateSceneEventsCompleteCode(gd::Project & p
     gd::EventsCodeGenerationContext context(&maxDepthLevelReached);
     EventsCodeGenerator codeGenerator(project, scene);
     codeGenerator.SetGenerateCodeForRuntime(compilationForRuntime);
+    codeGenerator.SetWhileIterationsLimit(whileIterationsLimit);
+    codeGenerator.externalEventsFunctions = externalEventsFunctions;
+    codeGenerator.rootEvents = &events;
+    codeGenerator.codeSizes = codeSizes;
+    codeGenerator.resourcesWorker = resourcesWorker;
     codeGenerator.PreprocessEventList(events);
+    codeGenerator.StoreEventsPaths(events, scene.GetName()+"/");
+    if ( resourcesWorker ) gd::LaunchResourceWorkerOnEvents(project, events, *resourcesWorker);
 
     //Generate whole events code
-    string wholeEventsCode = codeGenerator.GenerateEventsListCode(events, context);
+    string wholeEventsCode;
+    if ( !codeSizes )
+        wholeEventsCode = codeGenerator.GenerateEventsListCode(events, context);
+    else
+    {
+        //Generate the events one by one to know the size of the code of each of them.
+        for (unsigned int i = 0;i<events.GetEventsCount();++i)
+        {
+            gd::EventsList event;
+            event.InsertEvent(events.GetEventSmartPtr(i));
+
+            std::string eventCode = codeGenerator.GenerateEventsListCode(event, context);
+            codeSizes->AddEventCode(events.GetEvent(i).GetType(), eventCode.size());
+            wholeEventsCode += eventCode;
+        }
+    }
 
     //Extra declarations needed by events
     for ( set<string>::iterator declaration = codeGenerator.GetCustomGlobalDeclaration().begin() ;
@@ -53,88 +96,190 @@ std::string EventsCodeGenerator::GenerateSceneEventsCompleteCode(gd::Project & p
     //Global objects lists
     std::string globalObjectLists;
     std::string globalObjectListsReset;
-    for (unsigned int i = 0;i<project.GetObjectsCount();++i)
-    {
-        const gd::Object & object = project.GetObject(i);
+    codeGenerator.GenerateObjectsListsDeclarations(maxDepthLevelReached, "", globalObjectLists, globalObjectListsReset);
 
-        //Ensure needed files are included.
-        std::string type = gd::GetTypeOfObject(project, scene, object.GetName());
-        const gd::ObjectMetadata & metadata = gd::MetadataProvider::GetObjectMetadata(JsPlatform::Get(), type);
-        codeGenerator.AddIncludeFiles(metadata.includeFiles);
+    output +=
+    codeGenerator.GetCustomCodeOutsideMain()+"\n\n"
+    +globalObjectLists+"\n"
+    +codeGenerator.GenerateConditionsBooleansDeclarations()+"\n"
+    +"gdjs."+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code.func = function(runtimeScene, context) {\n"
+    +"context.startNewFrame();\n"
+    +globalObjectListsReset+"\n"
+	+codeGenerator.GetCustomCodeInMain()
+    +wholeEventsCode
+    +"return;\n"
+    +"}\n";
 
-        std::vector<std::string> automatisms = object.GetAllAutomatismNames();
-        for (unsigned int j = 0;j<automatisms.size();++j)
-        {
-            const gd::AutomatismMetadata & metadata = gd::MetadataProvider::GetAutomatismMetadata(JsPlatform::Get(),
-                                                                                                  object.GetAutomatism(automatisms[j]).GetTypeName());
-            codeGenerator.AddIncludeFiles(metadata.includeFiles);
-        }
+    //Export the symbols to avoid them being stripped by the Closure Compiler:
+    output += "gdjs['"+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code']"
+        +"= gdjs."+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code;\n";
 
-        //Generate declarations for the objects lists
-        for (unsigned int j = 1;j<=maxDepthLevelReached;++j)
-        {
-            globalObjectLists += codeGenerator.GetCodeNamespace()
-                                 +ManObjListName(object.GetName())+gd::ToString(j) + "= [];\n";
-            globalObjectListsReset += codeGenerator.GetCodeNamespace()
-                                      +ManObjListName(object.GetName())+gd::ToString(j) + ".length = 0;\n";
-        }
-    }
-    for (unsigned int i = 0;i<scene.GetObjectsCount();++i)
+    includeFiles.insert(codeGenerator.GetIncludeFiles().begin(), codeGenerator.GetIncludeFiles().end());
+    return output;
+}
+
+void EventsCodeGenerator::GenerateObjectsListsDeclarations(unsigned int maxDepthLevelReached, const std::string & generatedCode,
+                                                           std::string & declarations, std::string & reset)
+{
+    for (unsigned int i = 0;i<project.GetObjectsCount()+scene.GetObjectsCount();++i)
     {
-        const gd::Object & object = scene.GetObject(i);
+        const gd::Object & object = i < project.GetObjectsCount() ? project.GetObject(i)
+                                                                  : scene.GetObject(i-project.GetObjectsCount());
 
         //Ensure needed files are included.
         std::string type = gd::GetTypeOfObject(project, scene, object.GetName());
         const gd::ObjectMetadata & metadata = gd::MetadataProvider::GetObjectMetadata(JsPlatform::Get(), type);
-        codeGenerator.AddIncludeFiles(metadata.includeFiles);
+        AddIncludeFiles(metadata.includeFiles);
 
         std::vector<std::string> automatisms = object.GetAllAutomatismNames();
         for (unsigned int j = 0;j<automatisms.size();++j)
         {
             const gd::AutomatismMetadata & metadata = gd::MetadataProvider::GetAutomatismMetadata(JsPlatform::Get(),
                                                                                                   object.GetAutomatism(automatisms[j]).GetTypeName());
-            codeGenerator.AddIncludeFiles(metadata.includeFiles);
+            AddIncludeFiles(metadata.includeFiles);
         }
 
         //Generate declarations for the objects lists
         for (unsigned int j = 1;j<=maxDepthLevelReached;++j)
         {
-            globalObjectLists += codeGenerator.GetCodeNamespace()
-                                 +ManObjListName(object.GetName())+gd::ToString(j) + "= [];\n";
-            globalObjectListsReset += codeGenerator.GetCodeNamespace()
-                                      +ManObjListName(object.GetName())+gd::ToString(j) + ".length = 0;\n";
+            std::string listName = GetCodeNamespace()+ManObjListName(object.GetName())+gd::ToString(j);
+            if ( !generatedCode.empty() && generatedCode.find(listName) == std::string::npos )
+                continue;
+
+            declarations += listName + "= [];\n";
+            reset += listName + ".length = 0;\n";
         }
     }
+}
 
-    //Condition global booleans
+std::string EventsCodeGenerator::GenerateConditionsBooleansDeclarations()
+{
     std::string globalConditionsBooleans;
-    for (unsigned int i = 0;i<=codeGenerator.GetMaxCustomConditionsDepth();++i)
+    for (unsigned int i = 0;i<=GetMaxCustomConditionsDepth();++i)
     {
-        globalConditionsBooleans += codeGenerator.GetCodeNamespace()+"conditionTrue_"+gd::ToString(i)+" = {val:false};\n";
-        for (unsigned int j = 0;j<=codeGenerator.GetMaxConditionsListsSize();++j)
+        globalConditionsBooleans += GetCodeNamespace()+"conditionTrue_"+gd::ToString(i)+" = {val:false};\n";
+        for (unsigned int j = 0;j<=GetMaxConditionsListsSize();++j)
         {
-            globalConditionsBooleans += codeGenerator.GetCodeNamespace()+"condition"+gd::ToString(j)+"IsTrue_"+gd::ToString(i)+" = {val:false};\n";
+            globalConditionsBooleans += GetCodeNamespace()+"condition"+gd::ToString(j)+"IsTrue_"+gd::ToString(i)+" = {val:false};\n";
         }
     }
 
-    output +=
+    return globalConditionsBooleans;
+}
+
+void EventsCodeGenerator::StoreEventsPaths(gd::EventsList & events, const std::string & parentPath)
+{
+    for (unsigned int i = 0;i<events.GetEventsCount();++i)
+    {
+        std::string path = parentPath+gd::ToString(i+1);
+        eventsPaths[&events.GetEvent(i)] = path;
+        if ( events.GetEvent(i).CanHaveSubEvents() ) StoreEventsPaths(events.GetEvent(i).GetSubEvents(), path+".");
+    }
+}
+
+std::string EventsCodeGenerator::GetEventPath(const gd::BaseEvent & event) const
+{
+    std::map<const gd::BaseEvent*, std::string>::const_iterator path = eventsPaths.find(&event);
+    return path != eventsPaths.end() ? path->second : "";
+}
+
+std::string EventsCodeGenerator::GenerateUniqueVariableName(const std::string & prefix)
+{
+    return prefix+gd::ToString(++uniqueVariablesCount);
+}
+
+std::string EventsCodeGenerator::GenerateExternalEventsFunction(const std::string & externalEventsName)
+{
+    if ( !externalEventsFunctions || !project.HasExternalEventsNamed(externalEventsName) )
+        return "";
+
+    //The external events are preprocessed only once, so that the code generated
+    //( and in particular the identifiers of events like "Trigger once" ) is the same for all layouts.
+    boost::shared_ptr<gd::EventsList> & events = externalEventsFunctions->preprocessedEvents[externalEventsName];
+    bool mustBePreprocessed = !events;
+    if ( !events ) events = boost::shared_ptr<gd::EventsList>(new gd::EventsList(project.GetExternalEvents(externalEventsName).GetEvents()));
+
+    //Generate the function in a namespace containing a placeholder, replaced by the number of the variant.
+    const std::string mangledName = gd::SceneNameMangler::GetMangledSceneName(externalEventsName);
+    const std::string placeholderNamespace = "gdjs.externalEventsCode."+mangledName+"$VARIANT$.";
+
+    unsigned int maxDepthLevelReached = 0;
+    gd::EventsCodeGenerationContext context(&maxDepthLevelReached);
+    EventsCodeGenerator codeGenerator(project, scene);
+    codeGenerator.SetGenerateCodeForRuntime(GenerateCodeForRuntime());
+    codeGenerator.SetWhileIterationsLimit(whileIterationsLimit);
+    codeGenerator.SetCodeNamespace(placeholderNamespace);
+    EventsCodeSizes functionCodeSizes;
+    if ( codeSizes ) codeGenerator.codeSizes = &functionCodeSizes;
+    if ( mustBePreprocessed )
+    {
+        codeGenerator.PreprocessEventList(*events);
+        if ( resourcesWorker ) gd::LaunchResourceWorkerOnEvents(project, *events, *resourcesWorker);
+    }
+
+    codeGenerator.StoreEventsPaths(*events, externalEventsName+"/");
+    std::string wholeEventsCode = codeGenerator.GenerateEventsListCode(*events, context);
+
+    std::string objectLists;
+    std::string objectListsReset;
+    codeGenerator.GenerateObjectsListsDeclarations(maxDepthLevelReached, wholeEventsCode, objectLists, objectListsReset);
+
+    std::string functionCode;
+    for ( set<string>::iterator declaration = codeGenerator.GetCustomGlobalDeclaration().begin() ;
+        declaration != codeGenerator.GetCustomGlobalDeclaration().end(); ++declaration )
+        functionCode += *declaration+"\n";
+
+    functionCode +=
     codeGenerator.GetCustomCodeOutsideMain()+"\n\n"
-    +globalObjectLists+"\n"
-    +globalConditionsBooleans+"\n"
-    +"gdjs."+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code.func = function(runtimeScene, context) {\n"
-    +"context.startNewFrame();\n"
-    +globalObjectListsReset+"\n"
+    +objectLists+"\n"
+    +codeGenerator.GenerateConditionsBooleansDeclarations()+"\n"
+    +placeholderNamespace+"func = function(runtimeScene, context) {\n"
+    +objectListsReset+"\n"
 	+codeGenerator.GetCustomCodeInMain()
     +wholeEventsCode
     +"return;\n"
     +"}\n";
 
-    //Export the symbols to avoid them being stripped by the Closure Compiler:
-    output += "gdjs['"+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code']"
-        +"= gdjs."+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code;\n";
+    //Code referring to the layout ( for example, generated by an extension ignoring the namespace of the
+    //code generator ) can't be shared: the events will be copied into the events of the layout instead.
+    if ( functionCode.find("gdjs."+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code.") != std::string::npos )
+        return "";
 
-    includeFiles.insert(codeGenerator.GetIncludeFiles().begin(), codeGenerator.GetIncludeFiles().end());
-    return output;
+    //Reuse the function if the same code was already generated for another layout.
+    std::vector<std::string> & variants = externalEventsFunctions->variants[externalEventsName];
+    unsigned int variant = std::find(variants.begin(), variants.end(), functionCode) - variants.begin();
+    std::string variantNamespace = "gdjs.externalEventsCode."+mangledName+gd::ToString(variant);
+    if ( variant == variants.size() )
+    {
+        variants.push_back(functionCode);
+
+        std::string & code = externalEventsFunctions->code;
+        if ( code.empty() ) code += "gdjs.externalEventsCode = {};\n";
+        code += variantNamespace+" = {};\n";
+        std::string variantCode = functionCode;
+        size_t pos = variantCode.find(placeholderNamespace);
+        while ( pos != std::string::npos )
+        {
+            variantCode.replace(pos, placeholderNamespace.length(), variantNamespace+".");
+            pos = variantCode.find(placeholderNamespace, pos+variantNamespace.length()+1);
+        }
+        code += variantCode;
+        code += "\n";
+
+        externalEventsFunctions->includeFiles.insert(codeGenerator.GetIncludeFiles().begin(), codeGenerator.GetIncludeFiles().end());
+        if ( codeSizes ) codeSizes->AddInstructionsCode(functionCodeSizes);
+    }
+
+    sharedExternalEvents.insert(externalEventsName);
+    return variantNamespace+".func";
+}
+
+std::string EventsCodeGenerator::GenerateExternalEventsCall(const gd::BaseEvent & linkEvent) const
+{
+    std::map<const gd::BaseEvent*, std::string>::const_iterator call = externalEventsCalls.find(&linkEvent);
+    if ( call == externalEventsCalls.end() ) return "";
+
+    return call->second+"(runtimeScene, context);\n";
 }
 
 std::string EventsCodeGenerator::GenerateObjectFunctionCall(std::string objectListName,
@@ -149,7 +294,47 @@ std::string EventsCodeGenerator::GenerateObjectFunctionCall(std::string objectLi
     if ( context.GetCurrentObject() == objectListName && !context.GetCurrentObject().empty())
         return "("+GetObjectListName(objectListName, context)+"[i]."+codeInfo.functionCallName+"("+parametersStr+"))";
     else
-        return "(( "+GetObjectListName(objectListName, context)+".length === 0 ) ? "+defaultOutput+" :"+ GetObjectListName(objectListName, context)+"[0]."+codeInfo.functionCallName+"("+parametersStr+"))";
+    {
+        std::string call = "(( "+GetObjectListName(objectListName, context)+".length === 0 ) ? "+defaultOutput+" :"+ GetObjectListName(objectListName, context)+"[0]."+codeInfo.functionCallName+"("+parametersStr+"))";
+        if ( parametersStr.empty() && IsPureObjectFunction(codeInfo.functionCallName) )
+            AddCachableExpression(call);
+
+        return call;
+    }
+}
+
+std::string EventsCodeGenerator::GenerateCachedExpressionsDeclarations(std::vector<std::string> & arguments)
+{
+    //Longest expressions first, so that an expression containing another one is entirely cached.
+    std::vector<std::string> expressions(cachableExpressions.begin(), cachableExpressions.end());
+    std::stable_sort(expressions.begin(), expressions.end(), LongerStringFirst);
+    cachableExpressions.clear();
+
+    std::string declarationsCode;
+    unsigned int cachedCount = 0;
+    for (unsigned int i = 0;i<expressions.size();++i)
+    {
+        std::string variableName = "cachedExpression"+gd::ToString(cachedCount);
+        bool used = false;
+        for (unsigned int j = 0;j<arguments.size();++j)
+        {
+            size_t pos = arguments[j].find(expressions[i]);
+            while ( pos != std::string::npos )
+            {
+                used = true;
+                arguments[j].replace(pos, expressions[i].length(), variableName);
+                pos = arguments[j].find(expressions[i], pos+variableName.length());
+            }
+        }
+
+        if ( used )
+        {
+            declarationsCode += "var "+variableName+" = "+expressions[i]+";\n";
+            cachedCount++;
+        }
+    }
+
+    return declarationsCode;
 }
 
 std::string EventsCodeGenerator::GenerateObjectAutomatismFunctionCall(std::string objectListName,
@@ -207,13 +392,15 @@ std::string EventsCodeGenerator::GenerateFreeCondition(const std::vector<std::st
 
 std::string EventsCodeGenerator::GenerateObjectCondition(const std::string & objectName,
                                                          const gd::ObjectMetadata & objInfo,
-                                                         const std::vector<std::string> & arguments,
+                                                         const std::vector<std::string> & arguments_,
                                                          const gd::InstructionMetadata & instrInfos,
                                                          const std::string & returnBoolean,
                                                          bool conditionInverted,
                                                         gd::EventsCodeGenerationContext & context)
 {
-    std::string conditionCode;
+    //Pure expressions are evaluated only once, before iterating over the objects.
+    std::vector<std::string> arguments = arguments_;
+    std::string conditionCode = GenerateCachedExpressionsDeclarations(arguments);
 
     //Prepare call
     string objectFunctionCallNamePart = GetObjectListName(objectName, context)+"[i]."+instrInfos.codeExtraInformation.functionCallName;
@@ -253,13 +440,15 @@ std::string EventsCodeGenerator::GenerateObjectCondition(const std::string & obj
 std::string EventsCodeGenerator::GenerateAutomatismCondition(const std::string & objectName,
                                                              const std::string & automatismName,
                                                                    const gd::AutomatismMetadata & autoInfo,
-                                                                   const std::vector<std::string> & arguments,
+                                                                   const std::vector<std::string> & arguments_,
                                                                    const gd::InstructionMetadata & instrInfos,
                                                                    const std::string & returnBoolean,
                                                                    bool conditionInverted,
                                                       gd::EventsCodeGenerationContext & context)
 {
     std::string conditionCode;
+    std::vector<std::string> arguments = arguments_;
+    std::string cachedExpressionsCode = GenerateCachedExpressionsDeclarations(arguments);
 
     //Prepare call
     string objectFunctionCallNamePart = GetObjectListName(objectName, context)+"[i].getAutomatism(\""+automatismName+"\")."
@@ -292,6 +481,7 @@ std::string EventsCodeGenerator::GenerateAutomatismCondition(const std::string &
     }
     else
     {
+        conditionCode += cachedExpressionsCode;
         conditionCode += "for(var i = 0, k = 0, l = "+GetObjectListName(objectName, context)+".length;i<l;++i) {\n";
         conditionCode += "    if ( "+predicat+" ) {\n";
         conditionCode += "        "+GenerateBooleanFullName(returnBoolean, context)+".val = true;\n";
@@ -308,11 +498,13 @@ std::string EventsCodeGenerator::GenerateAutomatismCondition(const std::string &
 
 std::string EventsCodeGenerator::GenerateObjectAction(const std::string & objectName,
                                                                    const gd::ObjectMetadata & objInfo,
-                                                                   const std::vector<std::string> & arguments,
+                                                                   const std::vector<std::string> & arguments_,
                                                                    const gd::InstructionMetadata & instrInfos,
                                                       gd::EventsCodeGenerationContext & context)
 {
-    std::string actionCode;
+    //Pure expressions are evaluated only once, before iterating over the objects.
+    std::vector<std::string> arguments = arguments_;
+    std::string actionCode = GenerateCachedExpressionsDeclarations(arguments);
 
     //Prepare call
     string objectPart = GetObjectListName(objectName, context)+"[i]." ;
@@ -349,11 +541,13 @@ std::string EventsCodeGenerator::GenerateObjectAction(const std::string & object
 std::string EventsCodeGenerator::GenerateAutomatismAction(const std::string & objectName,
                                                                     const std::string & automatismName,
                                                                    const gd::AutomatismMetadata & autoInfo,
-                                                                   const std::vector<std::string> & arguments,
+                                                                   const std::vector<std::string> & arguments_,
                                                                    const gd::InstructionMetadata & instrInfos,
                                                       gd::EventsCodeGenerationContext & context)
 {
     std::string actionCode;
+    std::vector<std::string> arguments = arguments_;
+    std::string cachedExpressionsCode = GenerateCachedExpressionsDeclarations(arguments);
 
     //Prepare call
     //Add a static_cast if necessary
@@ -388,6 +582,7 @@ std::string EventsCodeGenerator::GenerateAutomatismAction(const std::string & ob
     }
     else
     {
+        actionCode += cachedExpressionsCode;
         actionCode += "for(var i = 0, len = "+GetObjectListName(objectName, context)+".length ;i < len;++i) {\n";
         actionCode += "    "+call+";\n";
         actionCode += "}\n";
@@ -457,6 +652,7 @@ string EventsCodeGenerator::GenerateConditionsListCode(vector < gd::Instruction
         string conditionCode = GenerateConditionCode(conditions[cId], "condition"+gd::ToString(cId)+"IsTrue", context);
         if ( !conditions[cId].GetType().empty() )
         {
+            if ( codeSizes ) codeSizes->AddInstructionCode(conditions[cId].GetType(), conditionCode.size());
             outputCode += "{\n";
             outputCode += conditionCode;
             outputCode += "}";
@@ -473,6 +669,25 @@ string EventsCodeGenerator::GenerateConditionsListCode(vector < gd::Instruction
     return outputCode;
 }
 
+string EventsCodeGenerator::GenerateActionsListCode(vector < gd::Instruction > & actions, gd::EventsCodeGenerationContext & context)
+{
+    string outputCode;
+    for (unsigned int aId =0;aId < actions.size();++aId)
+    {
+        string actionCode = GenerateActionCode(actions[aId], context);
+        if ( !actions[aId].GetType().empty() )
+        {
+            if ( codeSizes ) codeSizes->AddInstructionCode(actions[aId].GetType(), actionCode.size());
+
+            outputCode += "{";
+            outputCode += actionCode;
+            outputCode += "}";
+        }
+    }
+
+    return outputCode;
+}
+
 std::string EventsCodeGenerator::GenerateParameterCodes(const std::string & parameter, const gd::ParameterMetadata & metadata,
                                                         gd::EventsCodeGenerationContext & context,
                                                         const std::string & previousParameter,
@@ -598,11 +813,19 @@ std::string EventsCodeGenerator::GenerateBooleanFullName(const std::string & boo
 
 std::string EventsCodeGenerator::GetCodeNamespace()
 {
+    if ( !codeNamespace.empty() ) return codeNamespace;
+
     return "gdjs."+gd::SceneNameMangler::GetMangledSceneName(scene.GetName())+"Code.";
 }
 
 EventsCodeGenerator::EventsCodeGenerator(gd::Project & project, const gd::Layout & layout) :
-    gd::EventsCodeGenerator(project, layout, JsPlatform::Get())
+    gd::EventsCodeGenerator(project, layout, JsPlatform::Get()),
+    whileIterationsLimit(0),
+    uniqueVariablesCount(0),
+    externalEventsFunctions(NULL),
+    rootEvents(NULL),
+    codeSizes(NULL),
+    resourcesWorker(NULL)
 {
 }
 
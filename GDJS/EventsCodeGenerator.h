@@ -8,6 +8,8 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
+#include <boost/shared_ptr.hpp>
 #include "GDCore/Events/Event.h"
 #include "GDCore/Events/EventsCodeGenerator.h"
 namespace gd { class ObjectMetadata; }
@@ -15,10 +17,95 @@ namespace gd { class AutomatismMetadata; }
 namespace gd { class InstructionMetadata; }
 namespace gd { class ExpressionCodeGenerationInformation; }
 namespace gd { class EventsCodeGenerationContext; }
+namespace gd { class ArbitraryResourceWorker; }
 
 namespace gdjs
 {
 
+/**
+ * \brief Store the code of the external events generated as functions,
+ * so that layouts linking to the same external events share the same code.
+ *
+ * \see EventsCodeGenerator::GenerateSceneEventsCompleteCode
+ */
+class ExternalEventsFunctions
+{
+public:
+    ExternalEventsFunctions() {};
+    virtual ~ExternalEventsFunctions() {};
+
+    /**
+     * \brief Return the JS code declaring all the functions generated for external events.
+     */
+    const std::string & GetCode() const { return code; };
+
+    /**
+     * \brief Return the files needed by the code of the functions.
+     */
+    const std::set<std::string> & GetIncludeFiles() const { return includeFiles; };
+
+    /**
+     * \brief Return true if no function was generated.
+     */
+    bool IsEmpty() const { return code.empty(); };
+
+private:
+    friend class EventsCodeGenerator;
+
+    std::map<std::string, boost::shared_ptr<gd::EventsList> > preprocessedEvents; ///< Preprocessed copies of the external events, kept so that the code generated for all layouts is the same.
+    std::map<std::string, std::vector<std::string> > variants; ///< For each external events, the code of each function generated ( with a placeholder namespace ).
+    std::string code; ///< The code of all the functions.
+    std::set<std::string> includeFiles; ///< The includes files needed by the functions.
+};
+
+/**
+ * \brief Store the size of the code generated for the events and the instructions,
+ * to know which ones are responsible for the size of the exported games.
+ *
+ * \see EventsCodeGenerator::GenerateSceneEventsCompleteCode
+ */
+class EventsCodeSizes
+{
+public:
+    EventsCodeSizes() {};
+    virtual ~EventsCodeSizes() {};
+
+    /**
+     * \brief Add the size of the code generated for a top-level event.
+     */
+    void AddEventCode(const std::string & type, size_t bytes) { eventsBytes.push_back(std::make_pair(type, bytes)); };
+
+    /**
+     * \brief Add the size of the code generated for an instruction ( including its sub instructions ).
+     */
+    void AddInstructionCode(const std::string & type, size_t bytes) { instructionsBytes[type] += bytes; instructionsCount[type]++; };
+
+    /**
+     * \brief Add the sizes of the instructions of \a other.
+     */
+    void AddInstructionsCode(const EventsCodeSizes & other);
+
+    /**
+     * \brief Return the type and the size of the code of each top-level event, in the order of the events.
+     */
+    const std::vector< std::pair<std::string, size_t> > & GetEventsBytes() const { return eventsBytes; };
+
+    /**
+     * \brief Return the total size of the code generated for each type of instruction.
+     */
+    const std::map<std::string, size_t> & GetInstructionsBytes() const { return instructionsBytes; };
+
+    /**
+     * \brief Return the number of instructions generated for each type of instruction.
+     */
+    const std::map<std::string, size_t> & GetInstructionsCount() const { return instructionsCount; };
+
+private:
+    std::vector< std::pair<std::string, size_t> > eventsBytes; ///< Type and code size of each top-level event.
+    std::map<std::string, size_t> instructionsBytes; ///< Code size for each type of instruction.
+    std::map<std::string, size_t> instructionsCount; ///< Number of instructions of each type.
+};
+
 /**
  * \brief The class being responsible for generating Javascript code from events.
  *
@@ -35,13 +122,25 @@ public:
      * \param events events of the scene
      * \param compilationForRuntime Set this to true if the code is generated for runtime.
      * \param includeFiles A reference to a set of strings where needed includes files will be stored.
+     * \param whileIterationsLimit The maximum number of iterations of While events loops ( 0 for no limit ).
+     * \param externalEventsFunctions If not NULL, the external events linked at the root of the events of the scene
+     * are generated once as functions stored in this object, and the code of the scene only calls them
+     * ( except for the second and next links to the same external events, see CanShareExternalEvents ).
+     * Otherwise, external events are copied into the events of the scene.
+     * \param codeSizes If not NULL, will be filled with the size of the code generated for each event and instruction.
+     * \param resourcesWorker If not NULL, launched on the events once preprocessed ( i.e: with the linked events ),
+     * for example to update the filenames of the resources used by the events.
      * \return JS code
      */
     static std::string GenerateSceneEventsCompleteCode(gd::Project & project,
                                                        gd::Layout & scene,
                                                        gd::EventsList & events,
                                                        std::set < std::string > & includeFiles,
-                                                       bool compilationForRuntime = false);
+                                                       bool compilationForRuntime = false,
+                                                       unsigned int whileIterationsLimit = 0,
+                                                       ExternalEventsFunctions * externalEventsFunctions = NULL,
+                                                       EventsCodeSizes * codeSizes = NULL,
+                                                       gd::ArbitraryResourceWorker * resourcesWorker = NULL);
 
     /**
      * Generate code for executing a condition list
@@ -54,6 +153,15 @@ public:
      */
     virtual std::string GenerateConditionsListCode(std::vector < gd::Instruction > & conditions, gd::EventsCodeGenerationContext & context);
 
+    /**
+     * Generate code for executing an action list
+     *
+     * \param actions std::vector of actions
+     * \param context Context used for generation
+     * \return JS code.
+     */
+    virtual std::string GenerateActionsListCode(std::vector < gd::Instruction > & actions, gd::EventsCodeGenerationContext & context);
+
     /**
      * \brief Generate the full name for accessing to a boolean variable used for conditions.
      */
@@ -69,8 +177,104 @@ public:
      */
     virtual std::string GetObjectListName(const std::string & name, const gd::EventsCodeGenerationContext & context);
 
+    /**
+     * \brief Return the namespace in which the variables used by the generated code are declared
+     * ( "gdjs.<MangledSceneName>Code." by default ).
+     */
     std::string GetCodeNamespace();
 
+    /**
+     * \brief Change the namespace in which the variables used by the generated code are declared.
+     * \param codeNamespace_ The new namespace, including the trailing dot. Pass an empty string to use the default namespace.
+     */
+    void SetCodeNamespace(const std::string & codeNamespace_) { codeNamespace = codeNamespace_; };
+
+    /**
+     * \brief Return true if the external events called \a externalEventsName, linked by a link event
+     * of \a eventsList, can be generated as a shared function, instead of being copied into the events.
+     *
+     * \note Only the first link to external events at the root of the layout calls the shared function:
+     * the next links to the same external events are copied, so that their events ( "Trigger once" for
+     * example ) have their own state.
+     */
+    bool CanShareExternalEvents(const gd::EventsList & eventsList, const std::string & externalEventsName) const {
+        return externalEventsFunctions != NULL && &eventsList == rootEvents &&
+            sharedExternalEvents.find(externalEventsName) == sharedExternalEvents.end();
+    }
+
+    /**
+     * \brief Generate ( or reuse ) the function executing the external events called \a externalEventsName.
+     *
+     * \return The name of the function to call ( with runtimeScene and context as parameters ),
+     * or an empty string if the external events must be copied into the events instead.
+     * \see CanShareExternalEvents
+     */
+    std::string GenerateExternalEventsFunction(const std::string & externalEventsName);
+
+    /**
+     * \brief Mark a link event as calling the shared function of its external events, instead of
+     * being replaced by the linked events. The code of the link event is then the call to the function.
+     * \see GenerateExternalEventsCall
+     */
+    void SetExternalEventsFunction(const gd::BaseEvent & linkEvent, const std::string & functionName) {
+        externalEventsCalls[&linkEvent] = functionName;
+    }
+
+    /**
+     * \brief Generate the code calling the function of the external events linked by the link event.
+     * \return The code of the call, or an empty string if the link event was not marked with SetExternalEventsFunction.
+     */
+    std::string GenerateExternalEventsCall(const gd::BaseEvent & linkEvent) const;
+
+    /**
+     * \brief Set the maximum number of times the loop generated for a While event can be repeated.
+     * When the limit is reached, the loop is stopped and the runtime is notified
+     * (see gdjs.EventsContext.onWhileIterationsLimitReached).
+     *
+     * \param limit The maximum number of iterations, or 0 to generate unbounded loops ( default ).
+     */
+    void SetWhileIterationsLimit(unsigned int limit) { whileIterationsLimit = limit; };
+
+    /**
+     * \brief Return the maximum number of iterations of While events loops ( 0 if loops are not bounded ).
+     */
+    unsigned int GetWhileIterationsLimit() const { return whileIterationsLimit; };
+
+    /**
+     * \brief Return a stable identifier of an event being generated: the name of the layout ( or of the
+     * external events ) followed by the position of the event, starting at 1 ( "Level/3.2" is the second
+     * sub event of the third event of the layout "Level" ).
+     * \return The identifier, or an empty string if the event is not in the events being generated.
+     */
+    std::string GetEventPath(const gd::BaseEvent & event) const;
+
+    /**
+     * \brief Return a name, starting with \a prefix, which was never returned before by this code generator.
+     */
+    std::string GenerateUniqueVariableName(const std::string & prefix);
+
+    /**
+     * \brief Declare that the method of objects called \a functionName has no side effect.
+     *
+     * Calls to these methods made on objects which are not the object of the instruction
+     * ( for example Player.X() in an action on Enemy ) are then evaluated only once per instruction,
+     * before the loop iterating over the instances of the object of the instruction.
+     *
+     * \see AddCachableExpression
+     */
+    static void DeclarePureObjectFunction(const std::string & functionName) { pureObjectFunctions.insert(functionName); };
+
+    /**
+     * \brief Return true if the method of objects called \a functionName was declared as pure.
+     */
+    static bool IsPureObjectFunction(const std::string & functionName) { return pureObjectFunctions.find(functionName) != pureObjectFunctions.end(); };
+
+    /**
+     * \brief Notify the code generator that \a expression is the code of a pure expression,
+     * which can be evaluated only once by the instruction using it.
+     */
+    void AddCachableExpression(const std::string & expression) { cachableExpressions.insert(expression); };
+
 protected:
 
     virtual std::string GenerateParameterCodes(const std::string & parameter, const gd::ParameterMetadata & metadata,
@@ -136,11 +340,58 @@ protected:
 
     virtual std::string GenerateObjectsDeclarationCode(gd::EventsCodeGenerationContext & context);
 
+    /**
+     * \brief Replace the cachable expressions used by the arguments of an instruction by
+     * local variables, and return the code declaring these variables.
+     *
+     * \see AddCachableExpression
+     * \param arguments The arguments of the instruction, which will be updated to use the variables.
+     * \return The code to be inserted before the code of the instruction.
+     */
+    std::string GenerateCachedExpressionsDeclarations(std::vector<std::string> & arguments);
+
+    /**
+     * \brief Generate the declarations ( and the code resetting them ) of the objects lists used by the generated code.
+     *
+     * \param maxDepthLevelReached The maximum depth of the objects lists.
+     * \param generatedCode If not empty, only the lists used by this code are declared.
+     * \param declarations The string where the declarations are appended.
+     * \param reset The string where the code resetting the lists is appended.
+     */
+    void GenerateObjectsListsDeclarations(unsigned int maxDepthLevelReached, const std::string & generatedCode,
+                                          std::string & declarations, std::string & reset);
+
+    /**
+     * \brief Generate the declarations of the booleans used by the conditions.
+     */
+    std::string GenerateConditionsBooleansDeclarations();
+
     /**
      * \brief Construct a code generator for the specified project and layout.
      */
     EventsCodeGenerator(gd::Project & project, const gd::Layout & layout);
     virtual ~EventsCodeGenerator();
+
+private:
+    /**
+     * \brief Store the identifiers of the events and of their sub events (see GetEventPath).
+     * \param parentPath The identifier of the parent of the events, followed by the separator.
+     */
+    void StoreEventsPaths(gd::EventsList & events, const std::string & parentPath);
+
+    unsigned int whileIterationsLimit; ///< Maximum iterations of While events loops. 0 means no limit.
+    unsigned int uniqueVariablesCount; ///< The number of names returned by GenerateUniqueVariableName.
+    std::string codeNamespace; ///< If not empty, overrides the default namespace of the generated code.
+    ExternalEventsFunctions * externalEventsFunctions; ///< Where the functions of external events are stored ( can be NULL ).
+    const gd::EventsList * rootEvents; ///< The events list being generated, at the root of the scene.
+    std::map<const gd::BaseEvent*, std::string> externalEventsCalls; ///< The functions called by the link events to external events (see SetExternalEventsFunction).
+    std::set<std::string> sharedExternalEvents; ///< The external events already called as a shared function by the layout.
+    std::map<const gd::BaseEvent*, std::string> eventsPaths; ///< The identifiers of the events being generated (see GetEventPath).
+    EventsCodeSizes * codeSizes; ///< Where the sizes of the generated code are stored ( can be NULL ).
+    gd::ArbitraryResourceWorker * resourcesWorker; ///< Launched on the events once preprocessed ( can be NULL ).
+    std::set<std::string> cachableExpressions; ///< Pure expressions generated since the last instruction (see AddCachableExpression).
+
+    static std::set<std::string> pureObjectFunctions; ///< Objects methods without side effects (see DeclarePureObjectFunction).
 };
 
 }
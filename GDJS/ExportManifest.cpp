@@ -0,0 +1,214 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "GDCore/IDE/AbstractFileSystem.h"
+#include "GDCore/CommonTools.h"
+#include "GDJS/ExportManifest.h"
+#include "GDJS/FastFileCopy.h"
+#undef CopyFile //Disable an annoying macro
+
+namespace gdjs
+{
+
+const std::string ExportManifest::manifestFilename = "gdjs-manifest.txt";
+
+namespace
+{
+    //FNV-1a hash, fast enough to be computed on big resources.
+    const unsigned long long fnvOffsetBasis = 14695981039346656037ULL;
+    const unsigned long long fnvPrime = 1099511628211ULL;
+
+    void UpdateHash(unsigned long long & hash, const char * data, size_t size)
+    {
+        for (size_t i = 0;i<size;++i)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= fnvPrime;
+        }
+    }
+
+    std::string HashToString(unsigned long long hash)
+    {
+        std::ostringstream str;
+        str << std::hex << hash;
+        return str.str();
+    }
+}
+
+ExportManifest::ExportManifest(gd::AbstractFileSystem & fs_, const std::string & exportDir_) :
+    fs(fs_),
+    exportDir(exportDir_),
+    writtenFilesCount(0),
+    allowHardLinks(false)
+{
+}
+
+std::string ExportManifest::HashContent(const std::string & content)
+{
+    unsigned long long hash = fnvOffsetBasis;
+    UpdateHash(hash, content.c_str(), content.size());
+    return HashToString(hash);
+}
+
+std::string ExportManifest::HashFile(const std::string & filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if ( !file.is_open() ) return "";
+
+    unsigned long long hash = fnvOffsetBasis;
+    char buffer[64*1024];
+    while ( file.read(buffer, sizeof(buffer)) || file.gcount() > 0 )
+        UpdateHash(hash, buffer, file.gcount());
+
+    return HashToString(hash);
+}
+
+std::string ExportManifest::GetRelativeFilename(const std::string & filename) const
+{
+    std::string relativeFilename = filename;
+    fs.MakeRelative(relativeFilename, exportDir);
+    return relativeFilename;
+}
+
+bool ExportManifest::Load()
+{
+    previousEntries.clear();
+    entries.clear();
+    writtenFilesCount = 0;
+    writtenFiles.clear();
+
+    std::string manifestFile = exportDir+"/"+manifestFilename;
+    if ( !fs.FileExists(manifestFile) ) return false;
+
+    //Each line is: hash size modificationTime filename
+    std::istringstream manifest(fs.ReadFile(manifestFile));
+    std::string line;
+    while ( std::getline(manifest, line) )
+    {
+        std::istringstream lineStream(line);
+        Entry entry;
+        std::string filename;
+        if ( !(lineStream >> entry.hash >> entry.size >> entry.modificationTime) ) continue;
+
+        lineStream.get(); //Skip the separator
+        std::getline(lineStream, filename);
+        if ( !filename.empty() ) previousEntries[filename] = entry;
+    }
+
+    return true;
+}
+
+bool ExportManifest::Save()
+{
+    std::string manifest;
+    for (std::map<std::string, Entry>::const_iterator it = entries.begin();it != entries.end();++it)
+    {
+        manifest += (it->second.hash.empty() ? "0" : it->second.hash)+" "+gd::ToString(it->second.size)+" "
+            +gd::ToString(it->second.modificationTime)+" "+it->first+"\n";
+    }
+
+    return fs.WriteToFile(exportDir+"/"+manifestFilename, manifest);
+}
+
+void ExportManifest::SetEntry(const std::string & relativeFilename, const Entry & entry, bool written)
+{
+    #if !defined(GD_NO_WX_GUI)
+    wxMutexLocker lock(entriesMutex);
+    #endif
+
+    entries[relativeFilename] = entry;
+    if ( written )
+    {
+        writtenFilesCount++;
+        writtenFiles.insert(exportDir+"/"+relativeFilename);
+    }
+}
+
+bool ExportManifest::CopyFile(const std::string & source, const std::string & destination)
+{
+    Entry entry;
+    struct stat sourceStat;
+    if ( stat(source.c_str(), &sourceStat) == 0 )
+    {
+        entry.size = sourceStat.st_size;
+        entry.modificationTime = sourceStat.st_mtime;
+    }
+
+    //The file is not copied if the source has the same size and modification time,
+    //or the same content, as the file copied by the last export.
+    std::string relativeFilename = GetRelativeFilename(destination);
+    std::map<std::string, Entry>::const_iterator previous = previousEntries.find(relativeFilename);
+    if ( previous != previousEntries.end() && previous->second.size == entry.size && fs.FileExists(destination) )
+    {
+        if ( previous->second.modificationTime == entry.modificationTime )
+        {
+            SetEntry(relativeFilename, previous->second, false);
+            return true;
+        }
+
+        entry.hash = HashFile(source);
+        if ( !entry.hash.empty() && entry.hash == previous->second.hash )
+        {
+            SetEntry(relativeFilename, entry, false);
+            return true;
+        }
+    }
+
+    if ( !FastFileCopy::Copy(fs, source, destination, allowHardLinks) ) return false;
+
+    if ( entry.hash.empty() ) entry.hash = HashFile(source);
+    SetEntry(relativeFilename, entry, true);
+    return true;
+}
+
+bool ExportManifest::WriteToFile(const std::string & destination, const std::string & content)
+{
+    Entry entry;
+    entry.size = content.size();
+    entry.hash = HashContent(content);
+
+    std::string relativeFilename = GetRelativeFilename(destination);
+    std::map<std::string, Entry>::const_iterator previous = previousEntries.find(relativeFilename);
+    if ( previous != previousEntries.end() && previous->second.hash == entry.hash && fs.FileExists(destination) )
+    {
+        SetEntry(relativeFilename, entry, false);
+        return true;
+    }
+
+    if ( !fs.WriteToFile(destination, content) ) return false;
+
+    SetEntry(relativeFilename, entry, true);
+    return true;
+}
+
+void ExportManifest::RemoveStaleFiles()
+{
+    for (std::map<std::string, Entry>::const_iterator it = previousEntries.begin();it != previousEntries.end();++it)
+    {
+        if ( entries.find(it->first) == entries.end() )
+        {
+            std::string file = exportDir+"/"+it->first;
+            std::remove(file.c_str());
+            std::remove((file+".gz").c_str());
+            std::remove((file+".br").c_str());
+        }
+    }
+}
+
+std::vector<std::string> ExportManifest::GetExportedFiles() const
+{
+    std::vector<std::string> files;
+    for (std::map<std::string, Entry>::const_iterator it = entries.begin();it != entries.end();++it)
+        files.push_back(exportDir+"/"+it->first);
+
+    return files;
+}
+
+}
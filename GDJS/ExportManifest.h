@@ -0,0 +1,143 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef EXPORTMANIFEST_H
+#define EXPORTMANIFEST_H
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+#if !defined(GD_NO_WX_GUI)
+#include <wx/thread.h>
+#endif
+namespace gd { class AbstractFileSystem; }
+
+namespace gdjs
+{
+
+/**
+ * \brief Keep track of the files written in an export directory, so that a new export
+ * only writes the files which changed since the last one.
+ *
+ * The manifest is stored in the export directory and contains, for each file, the size,
+ * the modification time and the hash of its source. Usage:
+ * \code
+ * ExportManifest manifest(fs, exportDir);
+ * manifest.Load();
+ * manifest.CopyFile(source, exportDir+"/file.js"); //Only copied if source changed.
+ * manifest.WriteToFile(exportDir+"/index.html", content); //Only written if content changed.
+ * manifest.RemoveStaleFiles(); //Remove the files of the previous export which were not exported again.
+ * manifest.Save();
+ * \endcode
+ *
+ * CopyFile and WriteToFile can be called from several threads at the same time.
+ */
+class ExportManifest
+{
+public:
+    /**
+     * \brief Create a manifest for the specified export directory.
+     */
+    ExportManifest(gd::AbstractFileSystem & fs, const std::string & exportDir);
+    virtual ~ExportManifest() {};
+
+    /**
+     * \brief Load the manifest written by the last export.
+     * \return false if there is no manifest in the export directory.
+     */
+    bool Load();
+
+    /**
+     * \brief Save the manifest, with the files exported since the manifest was loaded.
+     * \return true if the manifest was successfully written.
+     */
+    bool Save();
+
+    /**
+     * \brief Copy \a source to \a destination, unless the destination is already up to date.
+     * \return false if the copy failed.
+     */
+    bool CopyFile(const std::string & source, const std::string & destination);
+
+    /**
+     * \brief Write \a content to \a destination, unless the destination already has this content.
+     * \return false if the file could not be written.
+     */
+    bool WriteToFile(const std::string & destination, const std::string & content);
+
+    /**
+     * \brief Allow the files copied to be hard links to their source ( see FastFileCopy ).
+     * Only use it if the exported files are never modified in place, like for previews.
+     */
+    void SetHardLinksAllowed(bool allow = true) { allowHardLinks = allow; };
+
+    /**
+     * \brief Remove the files listed by the manifest loaded which were not exported again, and their
+     * compressed versions ( see PrecompressedFilesWriter ).
+     */
+    void RemoveStaleFiles();
+
+    /**
+     * \brief Return the number of files written ( or copied ) since the manifest was loaded.
+     */
+    unsigned int GetWrittenFilesCount() const { return writtenFilesCount; };
+
+    /**
+     * \brief Return the files exported since the manifest was loaded, written or already up to date.
+     */
+    std::vector<std::string> GetExportedFiles() const;
+
+    /**
+     * \brief Return the files written ( or copied ) since the manifest was loaded.
+     */
+    const std::set<std::string> & GetWrittenFiles() const { return writtenFiles; };
+
+    /**
+     * \brief Return a hash of the content of the string.
+     */
+    static std::string HashContent(const std::string & content);
+
+    /**
+     * \brief Return a hash of the content of the file, or an empty string if the file can't be read.
+     */
+    static std::string HashFile(const std::string & filename);
+
+    static const std::string manifestFilename; ///< The name of the manifest file, in the export directory.
+
+private:
+    /**
+     * \brief Information about the source of an exported file.
+     */
+    struct Entry
+    {
+        Entry() : size(0), modificationTime(0) {};
+
+        unsigned long size; ///< Size of the source file.
+        long modificationTime; ///< Modification time of the source file ( 0 for generated content ).
+        std::string hash; ///< Hash of the content.
+    };
+
+    std::string GetRelativeFilename(const std::string & filename) const;
+
+    /**
+     * \brief Store the entry of an exported file.
+     * \param written true if the file was written, false if it was already up to date.
+     */
+    void SetEntry(const std::string & relativeFilename, const Entry & entry, bool written);
+
+    gd::AbstractFileSystem & fs;
+    std::string exportDir;
+    std::map<std::string, Entry> previousEntries; ///< The files of the last export, indexed by their filename relative to the export directory.
+    std::map<std::string, Entry> entries; ///< The files of the current export.
+    unsigned int writtenFilesCount;
+    std::set<std::string> writtenFiles; ///< The files written since the manifest was loaded.
+    bool allowHardLinks; ///< True if files can be copied as hard links.
+    #if !defined(GD_NO_WX_GUI)
+    wxMutex entriesMutex; ///< Protects entries, writtenFilesCount and writtenFiles.
+    #endif
+};
+
+}
+#endif // EXPORTMANIFEST_H
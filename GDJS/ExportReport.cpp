@@ -0,0 +1,223 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <sstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#if defined(WINDOWS)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#if !defined(GD_NO_WX_GUI)
+#include <wx/dir.h>
+#include <wx/arrstr.h>
+#endif
+#include "GDCore/IDE/AbstractFileSystem.h"
+#include "GDCore/Serialization/SerializerElement.h"
+#include "GDJS/ExportReport.h"
+
+namespace gdjs
+{
+
+/**
+ * \brief Return the current wall time, in milliseconds.
+ */
+static double GetTime()
+{
+    #if defined(WINDOWS)
+    return static_cast<double>(GetTickCount());
+    #else
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec*1000.0 + now.tv_usec/1000.0;
+    #endif
+}
+
+/**
+ * \brief Return the filename with slashes as separators and without repeated separators, so that
+ * the filenames listed by the file system can be compared to the filenames built by the exporter.
+ */
+static std::string NormalizeFilename(const std::string & filename)
+{
+    std::string normalized;
+    for (unsigned int i = 0;i<filename.size();++i)
+    {
+        char c = filename[i] == '\\' ? '/' : filename[i];
+        if ( c == '/' && !normalized.empty() && normalized[normalized.size()-1] == '/' ) continue;
+        normalized += c;
+    }
+
+    return normalized;
+}
+
+/**
+ * \brief Add to \a files all the files of the directory and of its sub directories.
+ */
+static void ListFiles(const std::string & directory, std::vector<std::string> & files)
+{
+    DIR * dir = opendir(directory.c_str());
+    if ( !dir ) return;
+
+    while ( struct dirent * entry = readdir(dir) )
+    {
+        std::string name = entry->d_name;
+        if ( name == "." || name == ".." ) continue;
+
+        std::string filename = directory+"/"+name;
+        struct stat fileInfo;
+        if ( stat(filename.c_str(), &fileInfo) != 0 ) continue;
+
+        if ( S_ISDIR(fileInfo.st_mode) )
+            ListFiles(filename, files);
+        else
+            files.push_back(filename);
+    }
+    closedir(dir);
+}
+
+/**
+ * \brief Return the number of bytes as a string: the sizes can be too big to be serialized as int.
+ */
+static std::string BytesToString(size_t bytes)
+{
+    std::ostringstream str;
+    str << bytes;
+    return str.str();
+}
+
+ExportReport::ExportReport(gd::AbstractFileSystem & fs_, const std::string & exportDir_, bool countFiles_) :
+    fs(fs_),
+    exportDir(exportDir_),
+    countFiles(countFiles_),
+    startTime(GetTime()),
+    duplicateFilesCount(0),
+    duplicateBytes(0)
+{
+    UpdateSnapshot(NULL);
+}
+
+double ExportReport::GetElapsedTime() const
+{
+    return GetTime()-startTime;
+}
+
+unsigned int ExportReport::BeginStage(const std::string & name)
+{
+    Stage stage;
+    stage.name = name;
+    stage.start = GetElapsedTime();
+    stages.push_back(stage);
+
+    return stages.size()-1;
+}
+
+void ExportReport::EndStage(unsigned int index)
+{
+    if ( index >= stages.size() || stages[index].finished ) return;
+
+    Stage & stage = stages[index];
+    stage.duration = GetElapsedTime()-stage.start;
+    stage.finished = true;
+    UpdateSnapshot(&stage);
+}
+
+void ExportReport::AddFiles(unsigned int index, const std::vector<std::string> & filenames)
+{
+    if ( index >= stages.size() ) return;
+
+    for (unsigned int i = 0;i<filenames.size();++i)
+    {
+        struct stat fileInfo;
+        if ( stat(filenames[i].c_str(), &fileInfo) != 0 ) continue;
+
+        stages[index].filesCount++;
+        stages[index].bytes += fileInfo.st_size;
+    }
+}
+
+void ExportReport::IgnoreFiles(const std::vector<std::string> & filenames)
+{
+    for (unsigned int i = 0;i<filenames.size();++i)
+        ignoredFiles.insert(NormalizeFilename(filenames[i]));
+}
+
+void ExportReport::UpdateSnapshot(Stage * stage)
+{
+    if ( !countFiles ) return;
+
+    std::vector<std::string> files;
+    #if !defined(GD_NO_WX_GUI)
+    wxArrayString allFiles;
+    if ( wxDirExists(exportDir) ) wxDir::GetAllFiles(exportDir, &allFiles);
+    for (unsigned int i = 0;i<allFiles.size();++i)
+        files.push_back(std::string(allFiles[i].mb_str()));
+    #else
+    ListFiles(exportDir, files);
+    #endif
+
+    std::map<std::string, std::pair<size_t, long> > newSnapshot;
+    for (unsigned int i = 0;i<files.size();++i)
+    {
+        struct stat fileInfo;
+        if ( stat(files[i].c_str(), &fileInfo) != 0 ) continue;
+
+        std::pair<size_t, long> info(fileInfo.st_size, static_cast<long>(fileInfo.st_mtime));
+        newSnapshot[files[i]] = info;
+
+        if ( !stage || ignoredFiles.find(NormalizeFilename(files[i])) != ignoredFiles.end() ) continue;
+        std::map<std::string, std::pair<size_t, long> >::const_iterator previous = snapshot.find(files[i]);
+        if ( previous == snapshot.end() || previous->second != info )
+        {
+            stage->filesCount++;
+            stage->bytes += info.first;
+        }
+    }
+
+    snapshot.swap(newSnapshot);
+}
+
+void ExportReport::SerializeTo(gd::SerializerElement & element) const
+{
+    unsigned int totalFiles = 0;
+    size_t totalBytes = 0;
+    gd::SerializerElement & stagesElement = element.AddChild("stages");
+    stagesElement.ConsiderAsArrayOf("stage");
+    for (unsigned int i = 0;i<stages.size();++i)
+    {
+        gd::SerializerElement & stageElement = stagesElement.AddChild("stage");
+        stageElement.SetAttribute("name", stages[i].name);
+        stageElement.SetAttribute("startMs", stages[i].start);
+        stageElement.SetAttribute("durationMs", stages[i].duration);
+        stageElement.SetAttribute("filesCount", (int)stages[i].filesCount);
+        stageElement.SetAttribute("bytes", BytesToString(stages[i].bytes));
+
+        totalFiles += stages[i].filesCount;
+        totalBytes += stages[i].bytes;
+    }
+
+    element.SetAttribute("totalDurationMs", GetElapsedTime());
+    element.SetAttribute("totalFilesCount", (int)totalFiles);
+    element.SetAttribute("totalBytes", BytesToString(totalBytes));
+    element.SetAttribute("duplicateFilesCount", (int)duplicateFilesCount);
+    element.SetAttribute("duplicateBytes", BytesToString(duplicateBytes));
+}
+
+std::string ExportReport::GetSummary() const
+{
+    std::ostringstream summary;
+    for (unsigned int i = 0;i<stages.size();++i)
+    {
+        summary << stages[i].name << ": " << static_cast<long>(stages[i].duration) << " ms, "
+            << stages[i].filesCount << " file(s), " << stages[i].bytes << " bytes" << std::endl;
+    }
+    if ( duplicateFilesCount != 0 )
+        summary << "duplicate files not written: " << duplicateFilesCount << " file(s), " << duplicateBytes << " bytes" << std::endl;
+
+    return summary.str();
+}
+
+}
@@ -0,0 +1,148 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef EXPORTREPORT_H
+#define EXPORTREPORT_H
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+namespace gd { class AbstractFileSystem; }
+namespace gd { class SerializerElement; }
+
+namespace gdjs
+{
+
+/**
+ * \brief Measure the stages of an export: the wall time spent in each stage, and the number of files
+ * ( and bytes ) written by each stage in the export directory.
+ *
+ * The files written are found by comparing the content of the export directory when a stage ends
+ * with its content when the previous stage ended: a file written by a stage running concurrently
+ * with another one is counted in the stage ending first, unless the file is ignored ( see IgnoreFiles )
+ * and added to its stage with AddFiles. Files written outside the export directory ( such as the
+ * generated code, written in a temporary directory ) can be added with AddFiles too.
+ *
+ * Usage example:
+ * \code
+ * ExportReport report(fs, exportDir);
+ * unsigned int stage = report.BeginStage("resources");
+ * //...
+ * report.EndStage(stage);
+ * std::cout << report.GetSummary();
+ * \endcode
+ *
+ * \see Exporter::SetExportReportFile
+ */
+class ExportReport
+{
+public:
+    /**
+     * \brief A stage of the export.
+     */
+    struct Stage
+    {
+        Stage() : start(0), duration(0), filesCount(0), bytes(0), finished(false) {};
+
+        std::string name;
+        double start; ///< The time the stage started, in milliseconds since the creation of the report.
+        double duration; ///< The wall time spent in the stage, in milliseconds.
+        unsigned int filesCount; ///< The number of files written ( or modified ) by the stage.
+        size_t bytes; ///< The total size of the files written by the stage.
+        bool finished;
+    };
+
+    /**
+     * \brief Create a report for an export in the directory. The content of the directory
+     * when the report is created is not counted in any stage.
+     * \param countFiles If false, only the time spent in each stage is measured ( the export directory is not scanned ).
+     */
+    ExportReport(gd::AbstractFileSystem & fs, const std::string & exportDir, bool countFiles = true);
+    virtual ~ExportReport() {};
+
+    /**
+     * \brief Start measuring a stage.
+     * \return The index of the stage, to be used with EndStage.
+     */
+    unsigned int BeginStage(const std::string & name);
+
+    /**
+     * \brief Stop measuring a stage, and count the files written in the export directory since
+     * the previous stage ended.
+     */
+    void EndStage(unsigned int stage);
+
+    /**
+     * \brief Count files, written outside the export directory, in a stage.
+     */
+    void AddFiles(unsigned int stage, const std::vector<std::string> & filenames);
+
+    /**
+     * \brief Don't count the files when they are found in the export directory, so that they can be counted
+     * in the stage which really wrote them with AddFiles ( for example, files written in the background ).
+     */
+    void IgnoreFiles(const std::vector<std::string> & filenames);
+
+    /**
+     * \brief Set the number of files not written because they have the same content as another file,
+     * and the number of bytes saved ( see Exporter::PrepareResourcesExport ).
+     */
+    void SetDuplicateFiles(unsigned int skippedFilesCount, size_t savedBytes) { duplicateFilesCount = skippedFilesCount; duplicateBytes = savedBytes; };
+
+    /**
+     * \brief Return the number of files not written because they have the same content as another file.
+     */
+    unsigned int GetDuplicateFilesCount() const { return duplicateFilesCount; };
+
+    /**
+     * \brief Return the number of bytes not written thanks to the files with the same content.
+     */
+    size_t GetDuplicateBytes() const { return duplicateBytes; };
+
+    /**
+     * \brief Return the number of stages.
+     */
+    unsigned int GetStagesCount() const { return stages.size(); };
+
+    /**
+     * \brief Return a stage.
+     */
+    const Stage & GetStage(unsigned int stage) const { return stages[stage]; };
+
+    /**
+     * \brief Return the wall time elapsed since the creation of the report, in milliseconds.
+     */
+    double GetElapsedTime() const;
+
+    /**
+     * \brief Serialize the report: the total time, files count and bytes, the duplicate files not written,
+     * and an array of the stages. The numbers of bytes are serialized as strings, as they can exceed the range of int.
+     */
+    void SerializeTo(gd::SerializerElement & element) const;
+
+    /**
+     * \brief Return a human readable summary of the report, one line per stage.
+     */
+    std::string GetSummary() const;
+
+private:
+    /**
+     * \brief Update the snapshot of the export directory, counting the new and modified files in the stage.
+     */
+    void UpdateSnapshot(Stage * stage);
+
+    gd::AbstractFileSystem & fs;
+    std::string exportDir;
+    bool countFiles;
+    double startTime; ///< The time the report was created, in milliseconds.
+    std::vector<Stage> stages;
+    std::map<std::string, std::pair<size_t, long> > snapshot; ///< The size and the modification time of each file of the export directory.
+    std::set<std::string> ignoredFiles; ///< The files not counted when found in the export directory ( see NormalizeFilename ).
+    unsigned int duplicateFilesCount; ///< The files not written because they have the same content as another file.
+    size_t duplicateBytes; ///< The size of the files not written because they have the same content as another file.
+};
+
+}
+#endif // EXPORTREPORT_H
@@ -7,29 +7,49 @@
 #include <fstream>
 #include <streambuf>
 #include <string>
+#include <cctype>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
 #if !defined(GD_NO_WX_GUI)
 #include <wx/filename.h>
 #include <wx/dir.h>
 #include <wx/msgdlg.h>
 #include <wx/config.h>
 #include <wx/progdlg.h>
-#include <wx/zipstrm.h>
-#include <wx/wfstream.h>
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+#include <wx/thread.h>
+#include <wx/image.h>
 #endif
 #include "GDCore/Tools/Localization.h"
 #include "GDCore/Tools/Log.h"
 #include "GDCore/TinyXml/tinyxml.h"
 #include "GDCore/PlatformDefinition/Project.h"
 #include "GDCore/PlatformDefinition/Layout.h"
+#include "GDCore/PlatformDefinition/Object.h"
+#include "GDCore/PlatformDefinition/ResourcesManager.h"
 #include "GDCore/IDE/AbstractFileSystem.h"
 #include "GDCore/Serialization/Serializer.h"
 #include "GDCore/Serialization/SerializerElement.h"
 #include "GDCore/PlatformDefinition/ExternalEvents.h"
+#include "GDCore/PlatformDefinition/ObjectGroup.h"
 #include "GDCore/IDE/wxTools/RecursiveMkDir.h"
-#include "GDCore/IDE/ProjectResourcesCopier.h"
+#include "GDCore/IDE/ResourcesMergingHelper.h"
+#include "GDCore/IDE/ArbitraryResourceWorker.h"
+#include "GDCore/Events/Event.h"
 #include "GDCore/CommonTools.h"
 #include "GDJS/Exporter.h"
 #include "GDJS/EventsCodeGenerator.h"
+#include "GDJS/ExportManifest.h"
+#include "GDJS/FastFileCopy.h"
+#include "GDJS/JsonFileWriter.h"
+#include "GDJS/JsMinifier.h"
+#include "GDJS/ZipPackager.h"
+#include "GDJS/PrecompressedFilesWriter.h"
+#include "GDJS/TextureAtlasPacker.h"
+#include "GDJS/PrecacheManifest.h"
+#include "GDJS/ExportReport.h"
 #include "GDJS/Dialogs/ProjectExportDialog.h"
 #include "GDJS/Dialogs/UploadOnlineDialog.h"
 #include "GDJS/Dialogs/CocoonJSUploadDialog.h"
@@ -45,6 +65,601 @@ static void InsertUnique(std::vector<std::string> & container, std::string str)
         container.push_back(str);
 }
 
+/**
+ * \brief Compute the filenames that the resources will have in the export directory,
+ * exactly like gd::ResourcesMergingHelper, but without modifying the project.
+ */
+class ResourcesRenamingHelper : public gd::ResourcesMergingHelper
+{
+public:
+    ResourcesRenamingHelper(gd::AbstractFileSystem & fs) : gd::ResourcesMergingHelper(fs) {};
+    virtual ~ResourcesRenamingHelper() {};
+
+    virtual void ExposeFile(std::string & resourceFilename)
+    {
+        std::string newFilename = resourceFilename;
+        gd::ResourcesMergingHelper::ExposeFile(newFilename);
+        if ( newFilename != resourceFilename ) renamedResources[resourceFilename] = newFilename;
+        newFilenames[resourceFilename] = newFilename;
+    }
+
+    /**
+     * \brief Return the filenames of the resources, as used in the project, associated to their new filenames.
+     */
+    const std::map<std::string, std::string> & GetRenamedResources() const { return renamedResources; };
+
+    /**
+     * \brief Return the filenames of all the resources, as used in the project, associated to their new filenames
+     * ( even if they are the same ).
+     */
+    const std::map<std::string, std::string> & GetNewFilenames() const { return newFilenames; };
+
+private:
+    std::map<std::string, std::string> renamedResources;
+    std::map<std::string, std::string> newFilenames;
+};
+
+/**
+ * \brief Return the size of the file, or 0 if it can't be opened.
+ */
+static size_t GetFileSize(const std::string & filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+    if ( !file.is_open() ) return 0;
+
+    std::streamoff size = file.tellg();
+    return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+/**
+ * \brief Return true if the two files can be read and have the same content.
+ */
+static bool HaveSameContent(const std::string & filename, const std::string & otherFilename)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    std::ifstream otherFile(otherFilename.c_str(), std::ios::in | std::ios::binary);
+    if ( !file.is_open() || !otherFile.is_open() ) return false;
+
+    std::vector<char> buffer(64*1024);
+    std::vector<char> otherBuffer(64*1024);
+    while ( file && otherFile )
+    {
+        file.read(&buffer[0], buffer.size());
+        otherFile.read(&otherBuffer[0], otherBuffer.size());
+        if ( file.gcount() != otherFile.gcount() ||
+            memcmp(&buffer[0], &otherBuffer[0], static_cast<size_t>(file.gcount())) != 0 )
+            return false;
+    }
+
+    return file.eof() && otherFile.eof();
+}
+
+/**
+ * \brief Insert the hash of a file content in its filename, before the extension
+ * ( "libs/pixi.js" becomes "libs/pixi.0123456789abcdef.js" ).
+ */
+static std::string AddHashToFilename(const std::string & filename, std::string hash)
+{
+    if ( hash.empty() ) return filename;
+    while ( hash.size() < 16 ) hash = "0"+hash; //Hashed filenames always have the same length.
+
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of("/\\");
+    if ( dot == std::string::npos || (slash != std::string::npos && dot < slash) ) return filename+"."+hash;
+
+    return filename.substr(0, dot)+"."+hash+filename.substr(dot);
+}
+
+/**
+ * \brief Rename a file written in the export directory so that its filename contains the hash of its content.
+ * \return The new filename, relative to the export directory, or the same filename if the file can't be renamed.
+ */
+static std::string RenameWithContentHash(const std::string & exportDir, const std::string & filename)
+{
+    std::string hashedFilename = AddHashToFilename(filename, ExportManifest::HashFile(exportDir+"/"+filename));
+    if ( hashedFilename == filename ) return filename;
+
+    remove((exportDir+"/"+hashedFilename).c_str());
+    if ( rename((exportDir+"/"+filename).c_str(), (exportDir+"/"+hashedFilename).c_str()) != 0 )
+    {
+        std::cout << "Unable to rename " << exportDir+"/"+filename << " to " << hashedFilename << "." << std::endl;
+        return filename;
+    }
+
+    return hashedFilename;
+}
+
+/**
+ * \brief Update the filenames of the resources using a table of renamed resources.
+ */
+class ResourcesRenamer : public gd::ArbitraryResourceWorker
+{
+public:
+    ResourcesRenamer(const std::map<std::string, std::string> & renamedResources_) : renamedResources(renamedResources_) {};
+    virtual ~ResourcesRenamer() {};
+
+    virtual void ExposeFile(std::string & resourceFilename)
+    {
+        std::map<std::string, std::string>::const_iterator it = renamedResources.find(resourceFilename);
+        if ( it != renamedResources.end() ) resourceFilename = it->second;
+    }
+
+private:
+    const std::map<std::string, std::string> & renamedResources;
+};
+
+/**
+ * \brief Store the names of the images and the filenames of the other resources exposed by objects or events.
+ */
+class ResourcesCollector : public gd::ArbitraryResourceWorker
+{
+public:
+    ResourcesCollector() {};
+    virtual ~ResourcesCollector() {};
+
+    virtual void ExposeImage(std::string & imageName) { images.insert(imageName); };
+    virtual void ExposeFile(std::string & resourceFilename) { files.insert(resourceFilename); };
+
+    std::set<std::string> images;
+    std::set<std::string> files;
+};
+
+/**
+ * \brief Replace, in the value and the attributes of the element and of its children, the filenames of the
+ * renamed resources which are in \a filenames. The "name" attributes are never replaced.
+ */
+static void RenameSerializedFilenames(gd::SerializerElement & element, const std::set<std::string> & filenames,
+    const std::map<std::string, std::string> & renamedResources)
+{
+    if ( !element.IsValueUndefined() )
+    {
+        std::string value = element.GetValue().GetString();
+        std::map<std::string, std::string>::const_iterator renamed = renamedResources.find(value);
+        if ( renamed != renamedResources.end() && filenames.find(value) != filenames.end() )
+            element.SetValue(renamed->second);
+    }
+
+    std::vector< std::pair<std::string, std::string> > renamedAttributes;
+    for (std::map<std::string, gd::SerializerValue>::const_iterator it = element.GetAllAttributes().begin();
+        it != element.GetAllAttributes().end();++it)
+    {
+        if ( it->first == "name" || filenames.find(it->second.GetString()) == filenames.end() ) continue;
+
+        std::map<std::string, std::string>::const_iterator renamed = renamedResources.find(it->second.GetString());
+        if ( renamed != renamedResources.end() ) renamedAttributes.push_back(std::make_pair(it->first, renamed->second));
+    }
+    for (unsigned int i = 0;i<renamedAttributes.size();++i)
+        element.SetAttribute(renamedAttributes[i].first, renamedAttributes[i].second);
+
+    for (unsigned int i = 0;i<element.GetAllChildren().size();++i)
+        RenameSerializedFilenames(*element.GetAllChildren()[i].second, filenames, renamedResources);
+}
+
+/**
+ * \brief Replace, in the serialized object, the filenames of the renamed resources used by the object.
+ * Only the filenames that the object exposes as files ( like the font of a text object ) are replaced.
+ */
+static void RenameSerializedObjectResources(gd::SerializerElement & objectElement, gd::Object & object,
+    const std::map<std::string, std::string> & renamedResources)
+{
+    ResourcesCollector objectResources;
+    object.ExposeResources(objectResources);
+    if ( !objectResources.files.empty() )
+        RenameSerializedFilenames(objectElement, objectResources.files, renamedResources);
+}
+
+/**
+ * \brief Replace the filenames of the renamed resources in the serialized project: the files of the
+ * resources and the filenames used by the objects. Other values ( names, texts, variables... ) are left as is,
+ * even if they are equal to a filename.
+ */
+static void RenameSerializedResources(gd::SerializerElement & projectElement, gd::Project & project,
+    const std::map<std::string, std::string> & renamedResources)
+{
+    gd::SerializerElement & resourcesElement = projectElement.GetChild("resources").GetChild("resources");
+    resourcesElement.ConsiderAsArrayOf("resource");
+    for (unsigned int i = 0;i<resourcesElement.GetChildrenCount();++i)
+    {
+        gd::SerializerElement & resourceElement = resourcesElement.GetChild(i);
+        std::map<std::string, std::string>::const_iterator renamed = renamedResources.find(resourceElement.GetStringAttribute("file"));
+        if ( renamed != renamedResources.end() ) resourceElement.SetAttribute("file", renamed->second);
+    }
+
+    gd::SerializerElement & objectsElement = projectElement.GetChild("objects");
+    objectsElement.ConsiderAsArrayOf("object");
+    for (unsigned int i = 0;i<project.GetObjectsCount() && i<objectsElement.GetChildrenCount();++i)
+        RenameSerializedObjectResources(objectsElement.GetChild(i), project.GetObject(i), renamedResources);
+
+    gd::SerializerElement & layoutsElement = projectElement.GetChild("layouts");
+    layoutsElement.ConsiderAsArrayOf("layout");
+    for (unsigned int i = 0;i<project.GetLayoutsCount() && i<layoutsElement.GetChildrenCount();++i)
+    {
+        gd::Layout & layout = project.GetLayout(i);
+        gd::SerializerElement & layoutObjectsElement = layoutsElement.GetChild(i).GetChild("objects");
+        layoutObjectsElement.ConsiderAsArrayOf("object");
+        for (unsigned int j = 0;j<layout.GetObjectsCount() && j<layoutObjectsElement.GetChildrenCount();++j)
+            RenameSerializedObjectResources(layoutObjectsElement.GetChild(j), layout.GetObject(j), renamedResources);
+    }
+}
+
+/**
+ * \brief Replace the element by an empty array.
+ */
+static void ClearSerializedArray(gd::SerializerElement & element, const std::string & childrenName)
+{
+    element = gd::SerializerElement();
+    element.ConsiderAsArrayOf(childrenName);
+}
+
+/**
+ * \brief Write the element in JSON in a file, between \a prefix and \a suffix.
+ */
+static bool WriteSerializedJSON(gd::AbstractFileSystem & fs, const gd::SerializerElement & element,
+    const std::string & filename, const std::string & prefix, const std::string & suffix)
+{
+    #if !defined(EMSCRIPTEN)
+    //Stream the JSON to the file, rather than building it in memory: the project can be huge.
+    JsonFileWriter writer;
+    if ( writer.Open(filename) )
+    {
+        writer.Write(prefix);
+        writer.WriteJSON(element);
+        writer.Write(suffix);
+
+        return writer.Close();
+    }
+    #endif
+
+    //The file system may not be the native one: write the file using it.
+    return fs.WriteToFile(filename, prefix + gd::Serializer::ToJSON(element) + suffix);
+}
+
+/**
+ * \brief Compute the size of the content once compressed with gzip.
+ * \return false if compression is not available ( builds without wxWidgets ).
+ */
+static bool GetGzippedSize(const std::string & content, size_t & size)
+{
+    #if !defined(GD_NO_WX_GUI)
+    wxMemoryOutputStream memoryStream;
+    {
+        wxZlibOutputStream zlibStream(memoryStream, 9, wxZLIB_GZIP);
+        zlibStream.Write(content.c_str(), content.size());
+        zlibStream.Close();
+    }
+
+    size = memoryStream.GetSize();
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+/**
+ * \brief Fill \a element with the size, raw and compressed, of \a content.
+ * The compressed size is omitted when it can't be computed.
+ */
+static void SerializeCodeSize(gd::SerializerElement & element, const std::string & content,
+    const std::string & bytesAttribute = "bytes", const std::string & gzipBytesAttribute = "gzipBytes")
+{
+    element.SetAttribute(bytesAttribute, (int)content.size());
+
+    size_t gzippedSize = 0;
+    if ( GetGzippedSize(content, gzippedSize) ) element.SetAttribute(gzipBytesAttribute, (int)gzippedSize);
+}
+
+/**
+ * \brief Fill \a element with the size of the code of each type of instruction.
+ */
+static void SerializeInstructionsSizes(gd::SerializerElement & element, const EventsCodeSizes & codeSizes)
+{
+    element.ConsiderAsArrayOf("instruction");
+    for (std::map<std::string, size_t>::const_iterator it = codeSizes.GetInstructionsBytes().begin();
+        it != codeSizes.GetInstructionsBytes().end();++it)
+    {
+        gd::SerializerElement & instructionElement = element.AddChild("instruction");
+        instructionElement.SetAttribute("type", it->first);
+        instructionElement.SetAttribute("bytes", (int)it->second);
+
+        std::map<std::string, size_t>::const_iterator count = codeSizes.GetInstructionsCount().find(it->first);
+        instructionElement.SetAttribute("count", count != codeSizes.GetInstructionsCount().end() ? (int)count->second : 0);
+    }
+}
+
+/**
+ * \brief Return the path of an include file, searched in the same directories as ExportIncludesAndLibs,
+ * or an empty string if the file does not exist.
+ */
+static std::string GetIncludeFilePath(gd::AbstractFileSystem & fs, const std::string & include)
+{
+    if ( fs.FileExists("./JsPlatform/Runtime/"+include) ) return "./JsPlatform/Runtime/"+include;
+    else if ( fs.FileExists("./JsPlatform/Runtime/Extensions/"+include) ) return "./JsPlatform/Runtime/Extensions/"+include;
+    else if ( fs.FileExists(include) ) return include;
+
+    return "";
+}
+
+/**
+ * \brief Add to \a namespaces the namespaces of the events tools ( "gdjs.evtTools.xxx" ) used by \a code.
+ * \param onlyDeclarations If true, only the namespaces declared by the code ( "gdjs.evtTools.xxx = " ) are added.
+ */
+static void FindEventsToolsUsed(const std::string & code, std::set<std::string> & namespaces, bool onlyDeclarations = false)
+{
+    const std::string prefix = "gdjs.evtTools.";
+    size_t pos = code.find(prefix);
+    while ( pos != std::string::npos )
+    {
+        size_t start = pos+prefix.size();
+        size_t end = start;
+        while ( end < code.size() && (isalnum(static_cast<unsigned char>(code[end])) || code[end] == '_' || code[end] == '$') )
+            ++end;
+
+        bool isDeclaration = false;
+        if ( onlyDeclarations )
+        {
+            size_t next = code.find_first_not_of(" \t", end);
+            isDeclaration = next != std::string::npos && code[next] == '=' && (next+1 >= code.size() || code[next+1] != '=');
+        }
+
+        if ( end > start && (!onlyDeclarations || isDeclaration) ) namespaces.insert(code.substr(start, end-start));
+        pos = code.find(prefix, end);
+    }
+}
+
+/**
+ * \brief Return the runtime files declaring events tools, associated to the namespaces of the tools they declare.
+ *
+ * The files of the runtime ( in the same directory as the one searched by ExportIncludesAndLibs ) are read to find
+ * the namespaces they declare, so that new tools don't have to be listed anywhere.
+ */
+static std::map<std::string, std::string> GetEventsToolsFiles(gd::AbstractFileSystem & fs)
+{
+    std::map<std::string, std::string> files;
+    std::vector<std::string> runtimeFiles = fs.ReadDir("./JsPlatform/Runtime", ".js");
+    std::sort(runtimeFiles.begin(), runtimeFiles.end());
+    for (unsigned int i = 0;i<runtimeFiles.size();++i)
+    {
+        std::set<std::string> declarations;
+        FindEventsToolsUsed(fs.ReadFile(runtimeFiles[i]), declarations, true);
+        for (std::set<std::string>::const_iterator it = declarations.begin();it != declarations.end();++it)
+        {
+            if ( files.find(*it) == files.end() ) files[*it] = fs.FileNameFrom(runtimeFiles[i]);
+        }
+    }
+
+    return files;
+}
+
+/**
+ * \brief Make the serialized image resources packed in texture atlases use their atlas page, and add to
+ * them the "atlasFrame" where the image is in the page.
+ */
+static void SetSerializedAtlasFrames(gd::SerializerElement & projectElement, const std::map<std::string, TextureAtlasFrame> & atlasFrames)
+{
+    gd::SerializerElement & resourcesElement = projectElement.GetChild("resources").GetChild("resources");
+    resourcesElement.ConsiderAsArrayOf("resource");
+    for (unsigned int i = 0;i<resourcesElement.GetChildrenCount();++i)
+    {
+        gd::SerializerElement & resourceElement = resourcesElement.GetChild(i);
+        std::map<std::string, gd::SerializerValue>::const_iterator name = resourceElement.GetAllAttributes().find("name");
+        if ( name == resourceElement.GetAllAttributes().end() ) continue;
+
+        std::map<std::string, TextureAtlasFrame>::const_iterator frame = atlasFrames.find(name->second.GetString());
+        if ( frame == atlasFrames.end() ) continue;
+
+        resourceElement.SetAttribute("file", frame->second.file);
+        gd::SerializerElement & frameElement = resourceElement.AddChild("atlasFrame");
+        frameElement.SetAttribute("x", (int)frame->second.x);
+        frameElement.SetAttribute("y", (int)frame->second.y);
+        frameElement.SetAttribute("width", (int)frame->second.width);
+        frameElement.SetAttribute("height", (int)frame->second.height);
+    }
+}
+
+/**
+ * \brief Add to each layout the names of the resources it uses ( see Exporter::GetLayoutsResources ).
+ */
+static void SetSerializedLayoutsResources(gd::SerializerElement & projectElement, const gd::Project & project,
+    const std::map<std::string, std::vector<std::string> > & layoutsResources)
+{
+    gd::SerializerElement & layoutsElement = projectElement.GetChild("layouts");
+    layoutsElement.ConsiderAsArrayOf("layout");
+    for (unsigned int i = 0;i<project.GetLayoutsCount() && i<layoutsElement.GetChildrenCount();++i)
+    {
+        std::map<std::string, std::vector<std::string> >::const_iterator resources = layoutsResources.find(project.GetLayout(i).GetName());
+        if ( resources == layoutsResources.end() ) continue;
+
+        gd::SerializerElement & usedResourcesElement = layoutsElement.GetChild(i).AddChild("usedResources");
+        usedResourcesElement.ConsiderAsArrayOf("resource");
+        for (unsigned int j = 0;j<resources->second.size();++j)
+            usedResourcesElement.AddChild("resource").SetAttribute("name", resources->second[j]);
+    }
+}
+
+/**
+ * \brief Add to the table the name of each element of the serialized array associated to its index.
+ * The first element with a name is the one kept, as the runtime searched them in this order.
+ */
+static void SerializeIndices(gd::SerializerElement & arrayElement, const std::string & childName,
+    gd::SerializerElement & indicesElement)
+{
+    std::set<std::string> namesAdded;
+    arrayElement.ConsiderAsArrayOf(childName);
+    for (unsigned int i = 0;i<arrayElement.GetChildrenCount();++i)
+    {
+        const gd::SerializerElement & element = arrayElement.GetChild(i);
+        std::map<std::string, gd::SerializerValue>::const_iterator name = element.GetAllAttributes().find("name");
+        if ( name == element.GetAllAttributes().end() ) continue;
+
+        if ( namesAdded.insert(name->second.GetString()).second )
+            indicesElement.SetAttribute(name->second.GetString(), (int)i);
+    }
+}
+
+/**
+ * \brief Add to the serialized project the tables associating the names of the layouts, external layouts
+ * and resources to their index, so that the runtime finds them without searching them ( see gdjs.RuntimeGame._indexOf ).
+ *
+ * Objects have no table, as the runtime scenes already store them in hash tables when they are loaded.
+ */
+static void SetSerializedIndices(gd::SerializerElement & projectElement)
+{
+    gd::SerializerElement & indicesElement = projectElement.AddChild("indices");
+    SerializeIndices(projectElement.GetChild("layouts"), "layout", indicesElement.AddChild("layouts"));
+    SerializeIndices(projectElement.GetChild("externalLayouts"), "externalLayout", indicesElement.AddChild("externalLayouts"));
+    SerializeIndices(projectElement.GetChild("resources").GetChild("resources"), "resource", indicesElement.AddChild("resources"));
+}
+
+/**
+ * \brief Move the custom hit boxes and the points of the frames of a serialized Sprite object to flat
+ * arrays stored in the "shapes" of the object ( see gdjs.SpriteRuntimeObject ):
+ *
+ * - "vertices" contains the coordinates of the vertices of all the hit boxes ( x1, y1, x2, y2... ),
+ * - "polygons" contains, for each hit box, the index of its first vertex and its number of vertices,
+ * - "points" contains the coordinates of all the points, and "pointsNames" their names.
+ *
+ * Each frame only stores the range of its hit boxes and points ( "hitBoxesStart", "hitBoxesCount",
+ * "pointsStart" and "pointsCount" ).
+ */
+static void SetSerializedFlatShapes(gd::SerializerElement & objectElement)
+{
+    gd::SerializerElement & shapesElement = objectElement.AddChild("shapes");
+    gd::SerializerElement & verticesElement = shapesElement.AddChild("vertices");
+    gd::SerializerElement & polygonsElement = shapesElement.AddChild("polygons");
+    gd::SerializerElement & pointsElement = shapesElement.AddChild("points");
+    gd::SerializerElement & pointsNamesElement = shapesElement.AddChild("pointsNames");
+    verticesElement.ConsiderAsArrayOf("value");
+    polygonsElement.ConsiderAsArrayOf("value");
+    pointsElement.ConsiderAsArrayOf("value");
+    pointsNamesElement.ConsiderAsArrayOf("value");
+
+    int verticesCount = 0;
+    int polygonsCount = 0;
+    int pointsCount = 0;
+    gd::SerializerElement & animationsElement = objectElement.GetChild("animations");
+    for (unsigned int a = 0;a<animationsElement.GetAllChildren().size();++a)
+    {
+        gd::SerializerElement & directionsElement = animationsElement.GetAllChildren()[a].second->GetChild("directions");
+        for (unsigned int d = 0;d<directionsElement.GetAllChildren().size();++d)
+        {
+            gd::SerializerElement & spritesElement = directionsElement.GetAllChildren()[d].second->GetChild("sprites");
+            for (unsigned int s = 0;s<spritesElement.GetAllChildren().size();++s)
+            {
+                gd::SerializerElement & spriteElement = *spritesElement.GetAllChildren()[s].second;
+
+                //Points
+                spriteElement.SetAttribute("pointsStart", pointsCount);
+                gd::SerializerElement & framePointsElement = spriteElement.GetChild("points");
+                for (unsigned int p = 0;p<framePointsElement.GetAllChildren().size();++p)
+                {
+                    const gd::SerializerElement & pointElement = *framePointsElement.GetAllChildren()[p].second;
+                    pointsNamesElement.AddChild("value").SetValue(pointElement.GetStringAttribute("name"));
+                    pointsElement.AddChild("value").SetValue(pointElement.GetDoubleAttribute("x"));
+                    pointsElement.AddChild("value").SetValue(pointElement.GetDoubleAttribute("y"));
+                    pointsCount++;
+                }
+                spriteElement.SetAttribute("pointsCount", pointsCount-spriteElement.GetIntAttribute("pointsStart"));
+                ClearSerializedArray(framePointsElement, "point");
+
+                //Custom hit boxes
+                spriteElement.SetAttribute("hitBoxesStart", polygonsCount);
+                gd::SerializerElement & maskElement = spriteElement.GetChild("customCollisionMask");
+                if ( spriteElement.GetBoolAttribute("hasCustomCollisionMask") )
+                {
+                    for (unsigned int p = 0;p<maskElement.GetAllChildren().size();++p)
+                    {
+                        const gd::SerializerElement & polygonElement = *maskElement.GetAllChildren()[p].second;
+                        polygonsElement.AddChild("value").SetValue(verticesCount);
+                        polygonsElement.AddChild("value").SetValue((int)polygonElement.GetAllChildren().size());
+                        for (unsigned int v = 0;v<polygonElement.GetAllChildren().size();++v)
+                        {
+                            const gd::SerializerElement & vertexElement = *polygonElement.GetAllChildren()[v].second;
+                            verticesElement.AddChild("value").SetValue(vertexElement.GetDoubleAttribute("x"));
+                            verticesElement.AddChild("value").SetValue(vertexElement.GetDoubleAttribute("y"));
+                            verticesCount++;
+                        }
+                        polygonsCount++;
+                    }
+                }
+                spriteElement.SetAttribute("hitBoxesCount", polygonsCount-spriteElement.GetIntAttribute("hitBoxesStart"));
+                ClearSerializedArray(maskElement, "polygon");
+            }
+        }
+    }
+}
+
+/**
+ * \brief Store the hit boxes and points of the Sprite objects of the serialized project and layouts
+ * in flat arrays ( see SetSerializedFlatShapes ), so that the runtime does not create arrays for each
+ * polygon, vertex and point of each frame.
+ */
+static void SetSerializedObjectsFlatShapes(gd::SerializerElement & projectElement)
+{
+    std::vector<gd::SerializerElement*> objectsElements;
+    objectsElements.push_back(&projectElement.GetChild("objects"));
+    gd::SerializerElement & layoutsElement = projectElement.GetChild("layouts");
+    layoutsElement.ConsiderAsArrayOf("layout");
+    for (unsigned int i = 0;i<layoutsElement.GetChildrenCount();++i)
+        objectsElements.push_back(&layoutsElement.GetChild(i).GetChild("objects"));
+
+    for (unsigned int i = 0;i<objectsElements.size();++i)
+    {
+        for (unsigned int j = 0;j<objectsElements[i]->GetAllChildren().size();++j)
+        {
+            gd::SerializerElement & objectElement = *objectsElements[i]->GetAllChildren()[j].second;
+            if ( objectElement.GetStringAttribute("type") == "Sprite" )
+                SetSerializedFlatShapes(objectElement);
+        }
+    }
+}
+
+#if !defined(GD_NO_WX_GUI)
+/**
+ * \brief Copy an image in an atlas page, repeating its border pixels in the padding around it.
+ */
+static void CopyImageToAtlasPage(const wxImage & image, wxImage & page, unsigned int x, unsigned int y, unsigned int padding)
+{
+    int width = image.GetWidth();
+    int height = image.GetHeight();
+    int pageWidth = page.GetWidth();
+    const unsigned char * data = image.GetData();
+    const unsigned char * alpha = image.GetAlpha();
+    unsigned char * pageData = page.GetData();
+    unsigned char * pageAlpha = page.GetAlpha();
+
+    for (int dy = -(int)padding;dy<height+(int)padding;++dy)
+    {
+        int sourceY = std::min(std::max(dy, 0), height-1);
+        for (int dx = -(int)padding;dx<width+(int)padding;++dx)
+        {
+            int sourceX = std::min(std::max(dx, 0), width-1);
+            size_t source = sourceY*width+sourceX;
+            size_t destination = (y+dy)*pageWidth+(x+dx);
+
+            pageData[destination*3] = data[source*3];
+            pageData[destination*3+1] = data[source*3+1];
+            pageData[destination*3+2] = data[source*3+2];
+            pageAlpha[destination] = alpha ? alpha[source] : 255;
+        }
+    }
+}
+
+/**
+ * \brief Add to the zip file all the files of the export directory which are not already in it.
+ */
+static void AddExportedFilesToZip(ZipPackager & zipPackager, const std::string & exportDir)
+{
+    wxArrayString files;
+    wxDir::GetAllFiles(exportDir, &files);
+    for (unsigned int i = 0; i < files.size(); ++i)
+    {
+        wxFileName filename(files[i]);
+        filename.MakeRelativeTo(exportDir);
+        zipPackager.AddFile(gd::ToString(files[i]), std::string(filename.GetFullPath(wxPATH_UNIX).ToUTF8().data()));
+    }
+}
+#endif
+
 static void GenerateFontsDeclaration(gd::AbstractFileSystem & fs, const std::string & outputDir, std::string & css, std::string & html)
 {
     std::vector<std::string> ttfFiles = fs.ReadDir(outputDir, ".TTF");
@@ -70,50 +685,185 @@ Exporter::~Exporter()
 bool Exporter::ExportLayoutForPreview(gd::Project & project, gd::Layout & layout, std::string exportDir)
 {
     fs.MkDir(exportDir);
-    fs.ClearDir(exportDir);
+
+    //Only the files which changed since the last preview are written.
+    ExportManifest manifest(fs, exportDir);
+    if ( !manifest.Load() ) fs.ClearDir(exportDir);
+    manifest.SetHardLinksAllowed(); //Files of previews are never modified.
+    exportManifest = &manifest;
+
     fs.MkDir(exportDir+"/libs");
     fs.MkDir(exportDir+"/Extensions");
     std::vector<std::string> includesFiles;
 
-    gd::Project exportedProject = project;
-
     //Export resources ( *before* generating events as some resources filenames may be updated )
-    ExportResources(fs, exportedProject, exportDir);
+    std::map<std::string, std::string> renamedResources;
+    ExportResources(fs, project, exportDir, renamedResources, NULL, &manifest, resourcesCopyCallback, useHashedFilenames);
     //Generate events code
-    if ( !ExportEventsCode(exportedProject, fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/", includesFiles) )
+    if ( !ExportEventsCode(project, fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/", includesFiles, &renamedResources) )
+    {
+        exportManifest = NULL;
         return false;
+    }
 
-    //Strip the project ( *after* generating events as the events may use strioped things ( objects groups... ) )
-    StripProject(exportedProject);
-    exportedProject.SetFirstLayout(layout.GetName());
-
-    //Export the project
-    std::string result = ExportToJSON(fs, exportedProject, fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/data.js",
-                                      "gdjs.projectData", false);
+    //Export the project, stripped and starting with the previewed layout
+    std::string firstLayout = project.GetFirstLayout();
+    project.SetFirstLayout(layout.GetName());
+    std::string result = ExportToJSON(fs, project, fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/data.js",
+                                      "gdjs.projectData", false, &renamedResources);
+    project.SetFirstLayout(firstLayout);
+    if ( !result.empty() )
+    {
+        lastError = result;
+        exportManifest = NULL;
+        return false;
+    }
     includesFiles.push_back(fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/data.js");
 
     //Copy all the dependencies
-    ExportIncludesAndLibs(includesFiles, exportDir, false);
+    if ( !ExportIncludesAndLibs(includesFiles, exportDir, false) )
+    {
+        exportManifest = NULL;
+        return false;
+    }
 
     //Create the index file
-    if ( !ExportStandardIndexFile(exportedProject, exportDir, includesFiles) ) return false;
+    bool indexFile = ExportStandardIndexFile(project, exportDir, includesFiles);
+    exportManifest = NULL;
+    if ( !indexFile ) return false;
+
+    #if !defined(GD_NO_WX_GUI)
+    //Write the compressed versions of the text files, sent by the preview server to the browsers accepting them.
+    //Only the files written by this preview, or without an up to date compressed version, are compressed.
+    PrecompressedFilesWriter precompressedFilesWriter(std::max(wxThread::GetCPUCount(), 1));
+    precompressedFilesWriter.SetBrotliQuality(5); //Fast enough not to delay the preview.
+    std::vector<std::string> exportedFiles = manifest.GetExportedFiles();
+    for (unsigned int i = 0;i<exportedFiles.size();++i)
+    {
+        if ( manifest.GetWrittenFiles().count(exportedFiles[i]) != 0 ||
+            !PrecompressedFilesWriter::HasUpToDateGzipFile(exportedFiles[i]) )
+            precompressedFilesWriter.AddFile(exportedFiles[i]);
+    }
+    if ( !precompressedFilesWriter.WriteAll() )
+        std::cout << "Some compressed versions of the files of the preview could not be written." << std::endl;
+    #endif
+
+    //Remove the files of the last preview which are not used anymore.
+    manifest.RemoveStaleFiles();
+    if ( !manifest.Save() ) std::cout << "Unable to write the manifest of the preview." << std::endl;
 
     return true;
 }
 
-std::string Exporter::ExportToJSON(gd::AbstractFileSystem & fs, const gd::Project & project,
-    std::string filename, std::string wrapIntoVariable, bool prettyPrinting)
+/**
+ * \brief Temporarily remove the events and the objects groups of a project, so that they are not serialized
+ * with the project. They are put back in the project when the detacher is destroyed.
+ */
+class EventsAndGroupsDetacher
+{
+public:
+    EventsAndGroupsDetacher(gd::Project & project_) : project(project_)
+    {
+        projectGroups.swap(project.GetObjectGroups());
+        layoutsGroups.resize(project.GetLayoutsCount());
+        layoutsEvents.resize(project.GetLayoutsCount());
+        for (unsigned int i = 0;i<project.GetLayoutsCount();++i)
+        {
+            layoutsGroups[i].swap(project.GetLayout(i).GetObjectGroups());
+            Detach(project.GetLayout(i).GetEvents(), layoutsEvents[i]);
+        }
+        externalEvents.resize(project.GetExternalEventsCount());
+        for (unsigned int i = 0;i<project.GetExternalEventsCount();++i)
+            Detach(project.GetExternalEvents(i).GetEvents(), externalEvents[i]);
+    }
+
+    ~EventsAndGroupsDetacher()
+    {
+        projectGroups.swap(project.GetObjectGroups());
+        for (unsigned int i = 0;i<project.GetLayoutsCount() && i<layoutsEvents.size();++i)
+        {
+            layoutsGroups[i].swap(project.GetLayout(i).GetObjectGroups());
+            Attach(layoutsEvents[i], project.GetLayout(i).GetEvents());
+        }
+        for (unsigned int i = 0;i<project.GetExternalEventsCount() && i<externalEvents.size();++i)
+            Attach(externalEvents[i], project.GetExternalEvents(i).GetEvents());
+    }
+
+private:
+    static void Detach(gd::EventsList & events, std::vector<gd::BaseEventSPtr> & detachedEvents)
+    {
+        for (unsigned int i = 0;i<events.GetEventsCount();++i)
+            detachedEvents.push_back(events.GetEventSmartPtr(i));
+        events.Clear();
+    }
+
+    static void Attach(const std::vector<gd::BaseEventSPtr> & detachedEvents, gd::EventsList & events)
+    {
+        for (unsigned int i = 0;i<detachedEvents.size();++i)
+            events.InsertEvent(detachedEvents[i]);
+    }
+
+    gd::Project & project;
+    std::vector<gd::ObjectGroup> projectGroups;
+    std::vector< std::vector<gd::ObjectGroup> > layoutsGroups;
+    std::vector< std::vector<gd::BaseEventSPtr> > layoutsEvents;
+    std::vector< std::vector<gd::BaseEventSPtr> > externalEvents;
+};
+
+std::string Exporter::ExportToJSON(gd::AbstractFileSystem & fs, gd::Project & project,
+    std::string filename, std::string wrapIntoVariable, bool prettyPrinting,
+    const std::map<std::string, std::string> * renamedResources, std::string layoutsDataDir,
+    const std::map<std::string, TextureAtlasFrame> * atlasFrames, bool hashedFilenames,
+    const std::map<std::string, std::vector<std::string> > * layoutsResources)
 {
     fs.MkDir(fs.DirNameFrom(filename));
 
     //Save the project to JSON
+    //( Events and objects groups are only used to generate the events code: they are not serialized at all,
+    //so that the project data is not built in memory only to be stripped afterwards. )
     gd::SerializerElement rootElement;
-    project.SerializeTo(rootElement);
+    {
+        EventsAndGroupsDetacher detacher(project);
+        project.SerializeTo(rootElement);
+    }
+    StripSerializedProject(rootElement);
+    if ( renamedResources ) RenameSerializedResources(rootElement, project, *renamedResources);
+    if ( atlasFrames && !atlasFrames->empty() ) SetSerializedAtlasFrames(rootElement, *atlasFrames);
+    if ( layoutsResources ) SetSerializedLayoutsResources(rootElement, project, *layoutsResources);
+    SetSerializedIndices(rootElement);
+    SetSerializedObjectsFlatShapes(rootElement);
+
+    //Move the layouts, except the one started first, to their own files.
+    if ( !layoutsDataDir.empty() && project.GetLayoutsCount() > 1 )
+    {
+        std::string firstLayout = project.HasLayoutNamed(project.GetFirstLayout()) ?
+            project.GetFirstLayout() : project.GetLayout(0).GetName();
 
-    std::string output = gd::Serializer::ToJSON(rootElement);
-    if (!wrapIntoVariable.empty()) output = wrapIntoVariable + " = " + output + ";";
+        gd::SerializerElement & layoutsElement = rootElement.GetChild("layouts");
+        layoutsElement.ConsiderAsArrayOf("layout");
+        for (unsigned int i = 0;i<project.GetLayoutsCount() && i<layoutsElement.GetChildrenCount();++i)
+        {
+            const std::string & layoutName = project.GetLayout(i).GetName();
+            if ( layoutName == firstLayout ) continue;
+
+            std::string dataFile = "data_layout"+gd::ToString(i)+".js";
+            gd::SerializerElement & layoutElement = layoutsElement.GetChild(i);
+            if ( !WriteSerializedJSON(fs, layoutElement, layoutsDataDir+"/"+dataFile, "gdjs.registerSceneData(", ");") )
+                return "Unable to write "+layoutsDataDir+"/"+dataFile;
+            if ( hashedFilenames ) dataFile = RenameWithContentHash(layoutsDataDir, dataFile);
+
+            //The runtime only needs the name of the layout and the file to load to get the layout ( and the
+            //resources used by the layout, to load them while the file is loaded ).
+            gd::SerializerElement usedResourcesElement = layoutElement.GetChild("usedResources");
+            layoutElement = gd::SerializerElement();
+            layoutElement.SetAttribute("name", layoutName);
+            layoutElement.SetAttribute("dataFile", dataFile);
+            if ( layoutsResources ) layoutElement.AddChild("usedResources") = usedResourcesElement;
+        }
+    }
 
-    if (!fs.WriteToFile(filename, output))
+    if ( !WriteSerializedJSON(fs, rootElement, filename, wrapIntoVariable.empty() ? "" : wrapIntoVariable + " = ",
+        wrapIntoVariable.empty() ? "" : ";") )
         return "Unable to write "+filename;
 
     return "";
@@ -193,13 +943,36 @@ bool Exporter::ExportStandardIndexFile(gd::Project & project, std::string export
     std::string customCss;
     std::string customHtml;
     GenerateFontsDeclaration(fs, exportDir, customCss, customHtml);
+    if ( generateServiceWorker ) customHtml += PrecacheManifest::GetRegistrationHTML();
 
     //Generate the file
     if ( !CompleteIndexFile(str, customCss, customHtml, exportDir, includesFiles, additionalSpec) )
         return false;
 
+    //Generate the service worker, caching the index file, the includes files and the resources.
+    if ( generateServiceWorker )
+    {
+        PrecacheManifest manifest(fs, exportDir);
+        manifest.AddContent("index.html", str);
+        manifest.AddFiles(includesFiles);
+        manifest.AddExportDirectoryFiles();
+
+        std::string serviceWorker = manifest.GenerateServiceWorker(fs.ReadFile("./JsPlatform/Runtime/"+PrecacheManifest::serviceWorkerFilename));
+        if ( serviceWorker.empty() )
+        {
+            lastError = "Unable to find {}/*GDJS_PRECACHE_MANIFEST*/ in the service worker.";
+            return false;
+        }
+        if ( !WriteExportedFile(exportDir+"/"+PrecacheManifest::manifestFilename, manifest.ToJSON()) ||
+             !WriteExportedFile(exportDir+"/"+PrecacheManifest::serviceWorkerFilename, serviceWorker) )
+        {
+            lastError = "Unable to write the service worker.";
+            return false;
+        }
+    }
+
     //Write the index.html file
-    if ( !fs.WriteToFile(exportDir+"/index.html", str) )
+    if ( !WriteExportedFile(exportDir+"/index.html", str) )
     {
         lastError = "Unable to write index file.";
         return false;
@@ -208,6 +981,16 @@ bool Exporter::ExportStandardIndexFile(gd::Project & project, std::string export
     return true;
 }
 
+bool Exporter::CopyExportedFile(const std::string & source, const std::string & destination)
+{
+    return exportManifest ? exportManifest->CopyFile(source, destination) : FastFileCopy::Copy(fs, source, destination);
+}
+
+bool Exporter::WriteExportedFile(const std::string & destination, const std::string & content)
+{
+    return exportManifest ? exportManifest->WriteToFile(destination, content) : fs.WriteToFile(destination, content);
+}
+
 bool Exporter::ExportIntelXDKIndexFile(gd::Project & project, std::string exportDir, const std::vector<std::string> & includesFiles, std::string additionalSpec)
 {
     #if !defined(GD_NO_WX_GUI)
@@ -256,273 +1039,826 @@ bool Exporter::ExportIntelXDKIndexFile(gd::Project & project, std::string export
             return false;
         }
 
-        //Write the file
-        if (!fs.WriteToFile(exportDir+"/XDKProject.xdk", str))
+        //Write the file
+        if (!fs.WriteToFile(exportDir+"/XDKProject.xdk", str))
+        {
+            lastError = "Unable to write the intel XDK project file.";
+            return false;
+        }
+    }
+    {
+        if ( !fs.CopyFile("./JsPlatform/Runtime/XDKProject.xdke", exportDir+"/XDKProject.xdke") )
+        {
+            lastError = "Unable to write the intel XDK second project file.";
+            return false;
+        }
+    }
+    #else
+        std::cout << "BAD USE: ExportIntelXDKIndexFile is not available." << std::endl;
+    #endif
+
+    return true;
+}
+
+bool Exporter::CompleteIndexFile(std::string & str, std::string customCss, std::string customHtml, std::string exportDir, const std::vector<std::string> & includesFiles, std::string additionalSpec)
+{
+    size_t pos = str.find("/* GDJS_CUSTOM_STYLE */");
+    if ( pos < str.length() )
+        str = str.replace(pos, 23, customCss);
+    else
+    {
+        std::cout << "Unable to find /* GDJS_CUSTOM_STYLE */ in index file." << std::endl;
+        lastError = "Unable to find /* GDJS_CUSTOM_STYLE */ in index file.";
+        return false;
+    }
+
+    pos = str.find("<!-- GDJS_CUSTOM_HTML -->");
+    if ( pos < str.length() )
+        str = str.replace(pos, 25, customHtml);
+    else
+    {
+        std::cout << "Unable to find <!-- GDJS_CUSTOM_HTML --> in index file." << std::endl;
+        lastError = "Unable to find <!-- GDJS_CUSTOM_HTML --> in index file.";
+        return false;
+    }
+
+    pos = str.find("<!-- GDJS_CODE_FILES -->");
+    if ( pos < str.length() )
+    {
+        std::string codeFilesIncludes;
+        for (std::vector<std::string>::const_iterator it = includesFiles.begin(); it != includesFiles.end(); ++it)
+        {
+            if ( !fs.FileExists(exportDir+"/"+*it) )
+            {
+                std::cout << "Warning: Unable to found " << exportDir+"/"+*it << "." << std::endl;
+                continue;
+            }
+
+            std::string relativeFile = exportDir+"/"+*it;
+            fs.MakeRelative(relativeFile, exportDir);
+            codeFilesIncludes += "\t<script src=\""+relativeFile+"\"></script>\n";
+        }
+
+        str = str.replace(pos, 24, codeFilesIncludes);
+    }
+    else
+    {
+        std::cout << "Unable to find <!-- GDJS_CODE_FILES --> in index file." << std::endl;
+        lastError = "Unable to find <!-- GDJS_CODE_FILES --> in index file.";
+        return false;
+    }
+
+    pos = str.find("{}/*GDJS_ADDITIONAL_SPEC*/");
+    if ( pos < str.length() )
+    {
+        if (additionalSpec.empty()) additionalSpec = "{}";
+
+        str = str.replace(pos, 26, additionalSpec);
+    }
+    else
+    {
+        std::cout << "Unable to find {}/*GDJS_ADDITIONAL_SPEC*/ in index file." << std::endl;
+        lastError = "Unable to find {}/*GDJS_ADDITIONAL_SPEC*/ in index file.";
+        return false;
+    }
+
+    return true;
+}
+
+bool Exporter::ExportEventsCode(gd::Project & project, std::string outputDir, std::vector<std::string> & includesFiles,
+    const std::map<std::string, std::string> * renamedResources)
+{
+    fs.MkDir(outputDir);
+
+    //First, do not forget common includes ( They must be included before events generated code files ).
+    InsertUnique(includesFiles, "libs/pixi.js");
+    InsertUnique(includesFiles, "libs/jshashtable.js");
+    InsertUnique(includesFiles, "gd.js");
+    InsertUnique(includesFiles, "libs/hshg.js");
+    InsertUnique(includesFiles, "commontools.js");
+    InsertUnique(includesFiles, "runtimeobject.js");
+    InsertUnique(includesFiles, "runtimescene.js");
+    InsertUnique(includesFiles, "polygon.js");
+    InsertUnique(includesFiles, "force.js");
+    InsertUnique(includesFiles, "layer.js");
+    InsertUnique(includesFiles, "timer.js");
+    InsertUnique(includesFiles, "imagemanager.js");
+    InsertUnique(includesFiles, "runtimegame.js");
+    InsertUnique(includesFiles, "variable.js");
+    InsertUnique(includesFiles, "variablescontainer.js");
+    InsertUnique(includesFiles, "eventscontext.js");
+    InsertUnique(includesFiles, "runtimescene.js");
+    InsertUnique(includesFiles, "runtimeautomatism.js");
+    InsertUnique(includesFiles, "runtimeobject.js");
+    InsertUnique(includesFiles, "spriteruntimeobject.js");
+    InsertUnique(includesFiles, "soundmanager.js");
+    size_t coreIncludesCount = includesFiles.size();
+
+    //The events tools ( "gdjs.evtTools.xxx" ) used by the events and the extensions, so that only
+    //the files declaring them are exported.
+    std::set<std::string> eventsToolsUsed;
+
+    //External events linked by several layouts are generated only once, as shared functions.
+    ExternalEventsFunctions externalEventsFunctions;
+
+    //The events use the new filenames of the resources.
+    std::map<std::string, std::string> noRenamedResources;
+    ResourcesRenamer resourcesRenamer(renamedResources ? *renamedResources : noRenamedResources);
+
+    //The sizes of the code are only computed if a report was requested.
+    bool generateCodeSizeReport = !codeSizeReportFile.empty();
+    gd::SerializerElement report;
+    gd::SerializerElement & layoutsElement = report.AddChild("layouts");
+    layoutsElement.ConsiderAsArrayOf("layout");
+    EventsCodeSizes projectCodeSizes;
+
+    for (unsigned int i = 0;i<project.GetLayoutsCount();++i)
+    {
+        std::set<std::string> eventsIncludes;
+        EventsCodeSizes codeSizes;
+        gd::Layout & exportedLayout = project.GetLayout(i);
+
+        //The code generation modifies the events ( links are replaced by the linked events... ): use a copy.
+        gd::EventsList events = exportedLayout.GetEvents();
+        std::string eventsOutput = EventsCodeGenerator::GenerateSceneEventsCompleteCode(project, exportedLayout,
+            events, eventsIncludes, false /*Export for edittime*/, whileIterationsLimit,
+            &externalEventsFunctions, generateCodeSizeReport ? &codeSizes : NULL,
+            renamedResources ? &resourcesRenamer : NULL);
+        FindEventsToolsUsed(eventsOutput, eventsToolsUsed);
+
+        //Export the code
+        if (fs.WriteToFile(outputDir+"code"+gd::ToString(i)+".js", eventsOutput))
+        {
+            for ( std::set<std::string>::iterator include = eventsIncludes.begin() ; include != eventsIncludes.end(); ++include )
+                InsertUnique(includesFiles, *include);
+
+            InsertUnique(includesFiles, std::string(outputDir+"code"+gd::ToString(i)+".js"));
+        }
+        else {
+            lastError = gd::ToString(_("Unable to write ")+outputDir+"code"+gd::ToString(i)+".js");
+            return false;
+        }
+
+        if ( generateCodeSizeReport )
+        {
+            gd::SerializerElement & layoutElement = layoutsElement.AddChild("layout");
+            layoutElement.SetAttribute("name", exportedLayout.GetName());
+            layoutElement.SetAttribute("file", "code"+gd::ToString(i)+".js");
+            SerializeCodeSize(layoutElement, eventsOutput);
+
+            gd::SerializerElement & eventsElement = layoutElement.AddChild("events");
+            eventsElement.ConsiderAsArrayOf("event");
+            for (unsigned int j = 0;j<codeSizes.GetEventsBytes().size();++j)
+            {
+                gd::SerializerElement & eventElement = eventsElement.AddChild("event");
+                eventElement.SetAttribute("index", (int)j);
+                eventElement.SetAttribute("type", codeSizes.GetEventsBytes()[j].first);
+                eventElement.SetAttribute("bytes", (int)codeSizes.GetEventsBytes()[j].second);
+            }
+
+            SerializeInstructionsSizes(layoutElement.AddChild("instructions"), codeSizes);
+            projectCodeSizes.AddInstructionsCode(codeSizes);
+        }
+    }
+
+    if ( !externalEventsFunctions.IsEmpty() )
+    {
+        FindEventsToolsUsed(externalEventsFunctions.GetCode(), eventsToolsUsed);
+        if (fs.WriteToFile(outputDir+"externalEventsCode.js", externalEventsFunctions.GetCode()))
+        {
+            for ( std::set<std::string>::const_iterator include = externalEventsFunctions.GetIncludeFiles().begin();
+                include != externalEventsFunctions.GetIncludeFiles().end(); ++include )
+                InsertUnique(includesFiles, *include);
+
+            InsertUnique(includesFiles, std::string(outputDir+"externalEventsCode.js"));
+        }
+        else {
+            lastError = gd::ToString(_("Unable to write ")+outputDir+"externalEventsCode.js");
+            return false;
+        }
+
+        if ( generateCodeSizeReport )
+            SerializeCodeSize(report.AddChild("externalEvents"), externalEventsFunctions.GetCode());
+    }
+
+    //Extensions files can use events tools too ( and declare their own ).
+    std::set<std::string> eventsToolsDeclaredByExtensions;
+    for (unsigned int i = coreIncludesCount;i<includesFiles.size();++i)
+    {
+        if ( includesFiles[i].find(outputDir) == 0 ) continue; //Generated code is already scanned.
+
+        std::string filename = GetIncludeFilePath(fs, includesFiles[i]);
+        if ( filename.empty() ) continue;
+
+        std::string code = fs.ReadFile(filename);
+        FindEventsToolsUsed(code, eventsToolsUsed);
+        FindEventsToolsUsed(code, eventsToolsDeclaredByExtensions, true);
+    }
+
+    //Add the files of the events tools used ( and of the tools they use ) before the extensions and events code.
+    std::map<std::string, std::string> runtimeEventsToolsFiles = GetEventsToolsFiles(fs);
+    bool unknownEventsToolsUsed = false;
+    std::vector<std::string> eventsToolsFiles;
+    std::vector<std::string> toolsNamespaces(eventsToolsUsed.begin(), eventsToolsUsed.end());
+    for (unsigned int i = 0;i<toolsNamespaces.size();++i)
+    {
+        std::map<std::string, std::string>::const_iterator declaringFile = runtimeEventsToolsFiles.find(toolsNamespaces[i]);
+        if ( declaringFile == runtimeEventsToolsFiles.end() )
+        {
+            if ( eventsToolsDeclaredByExtensions.find(toolsNamespaces[i]) == eventsToolsDeclaredByExtensions.end() )
+            {
+                gd::LogWarning(gd::ToString(_("No runtime or extension file declares the events tools "))+"gdjs.evtTools."+toolsNamespaces[i]
+                    +gd::ToString(_(": all the events tools of the runtime are exported.")));
+                unknownEventsToolsUsed = true;
+            }
+            continue;
+        }
+
+        const std::string & file = declaringFile->second;
+        if ( std::find(includesFiles.begin(), includesFiles.begin()+coreIncludesCount, file) != includesFiles.begin()+coreIncludesCount
+            || std::find(eventsToolsFiles.begin(), eventsToolsFiles.end(), file) != eventsToolsFiles.end() )
+            continue;
+
+        eventsToolsFiles.push_back(file);
+
+        std::string filename = GetIncludeFilePath(fs, file);
+        if ( filename.empty() ) continue;
+
+        std::set<std::string> dependencies;
+        FindEventsToolsUsed(fs.ReadFile(filename), dependencies);
+        for (std::set<std::string>::const_iterator it = dependencies.begin();it != dependencies.end();++it)
+        {
+            if ( eventsToolsUsed.insert(*it).second ) toolsNamespaces.push_back(*it);
+        }
+    }
+
+    //Tools which are not found may be declared in a way not recognized: rather export all the tools than a broken game.
+    if ( unknownEventsToolsUsed )
+    {
+        for (std::map<std::string, std::string>::const_iterator it = runtimeEventsToolsFiles.begin();it != runtimeEventsToolsFiles.end();++it)
+        {
+            if ( std::find(includesFiles.begin(), includesFiles.begin()+coreIncludesCount, it->second) == includesFiles.begin()+coreIncludesCount
+                && std::find(eventsToolsFiles.begin(), eventsToolsFiles.end(), it->second) == eventsToolsFiles.end() )
+                eventsToolsFiles.push_back(it->second);
+        }
+    }
+    for (unsigned int i = 0;i<eventsToolsFiles.size();++i)
+    {
+        std::vector<std::string>::iterator existing = std::find(includesFiles.begin(), includesFiles.end(), eventsToolsFiles[i]);
+        if ( existing != includesFiles.end() ) includesFiles.erase(existing); //Included by an extension: moved with the other tools.
+    }
+    includesFiles.insert(includesFiles.begin()+coreIncludesCount, eventsToolsFiles.begin(), eventsToolsFiles.end());
+
+    if ( generateCodeSizeReport )
+    {
+        SerializeInstructionsSizes(report.AddChild("instructions"), projectCodeSizes);
+
+        //Runtime and extensions files, searched in the same directories as ExportIncludesAndLibs.
+        gd::SerializerElement & includesElement = report.AddChild("includeFiles");
+        includesElement.ConsiderAsArrayOf("includeFile");
+        std::string allIncludes;
+        for ( std::vector<std::string>::const_iterator include = includesFiles.begin() ; include != includesFiles.end(); ++include )
+        {
+            std::string filename = GetIncludeFilePath(fs, *include);
+            if ( filename.empty() ) continue;
+
+            std::string content = fs.ReadFile(filename);
+            gd::SerializerElement & includeElement = includesElement.AddChild("includeFile");
+            includeElement.SetAttribute("file", fs.FileNameFrom(*include));
+            SerializeCodeSize(includeElement, content);
+
+            allIncludes += content;
+        }
+
+        SerializeCodeSize(report, allIncludes, "totalBytes", "totalGzipBytes");
+
+        if ( !fs.WriteToFile(codeSizeReportFile, gd::Serializer::ToJSON(report)) )
+            gd::LogWarning(gd::ToString(_("Unable to write the code size report to ")+codeSizeReportFile));
+    }
+
+    return true;
+}
+
+bool Exporter::ExportIncludesAndLibs(std::vector<std::string> & includesFiles, std::string exportDir, bool minify)
+{
+    if ( minify && ExportMinifiedIncludes(includesFiles, exportDir) )
+        return true;
+
+    //If the files could not be minified or minification was not requested, simply copy all the include files.
+    //All the files are copied even if one fails, so that the export directory is as complete as possible.
+    bool allFilesCopied = true;
+    for ( std::vector<std::string>::iterator include = includesFiles.begin() ; include != includesFiles.end(); ++include )
+    {
+        if ( fs.FileExists("./JsPlatform/Runtime/"+*include) )
+        {
+            std::string path = fs.DirNameFrom(exportDir+"/Extensions/"+*include);
+            if ( !fs.DirExists(path) ) fs.MkDir(path);
+
+            std::string source = "./JsPlatform/Runtime/"+*include;
+            if ( useHashedFilenames ) *include = AddHashToFilename(*include, ExportManifest::HashFile(source));
+            if ( !CopyExportedFile(source, exportDir+"/"+*include) )
+            {
+                lastError = gd::ToString(_("Unable to copy the include file "))+source;
+                allFilesCopied = false;
+            }
+            //Ok, the filename is relative to the export dir.
+        }
+        else if ( fs.FileExists("./JsPlatform/Runtime/Extensions/"+*include) )
+        {
+            std::string path = fs.DirNameFrom(exportDir+"/Extensions/"+*include);
+            if ( !fs.DirExists(path) ) fs.MkDir(path);
+
+            std::string source = "./JsPlatform/Runtime/Extensions/"+*include;
+            *include = "Extensions/"+*include; //Ensure filename is relative to the export dir.
+            if ( useHashedFilenames ) *include = AddHashToFilename(*include, ExportManifest::HashFile(source));
+            if ( !CopyExportedFile(source, exportDir+"/"+*include) )
+            {
+                lastError = gd::ToString(_("Unable to copy the include file "))+source;
+                allFilesCopied = false;
+            }
+        }
+        else if ( fs.FileExists(*include) )
+        {
+            std::string source = *include;
+            *include = fs.FileNameFrom(*include); //Ensure filename is relative to the export dir.
+            if ( useHashedFilenames ) *include = AddHashToFilename(*include, ExportManifest::HashFile(source));
+            if ( !CopyExportedFile(source, exportDir+"/"+*include) )
+            {
+                lastError = gd::ToString(_("Unable to copy the include file "))+source;
+                allFilesCopied = false;
+            }
+        }
+        else
+        {
+            std::cout << "Could not copy include file " << *include << " (File not found)." << std::endl;
+            lastError = gd::ToString(_("Include file not found: "))+*include;
+            allFilesCopied = false;
+        }
+    }
+
+    return allFilesCopied;
+}
+
+#if !defined(GD_NO_WX_GUI)
+bool Exporter::MinifyWithClosureCompiler(const std::vector<std::string> & files, std::string outputFile)
+{
+    std::string javaExec = GetJavaExecutablePath();
+    if ( javaExec.empty() || !fs.FileExists(javaExec) )
+    {
+        std::cout << "Java executable not found." << std::endl;
+        gd::LogWarning(_("The exported script could not be minified with Google Closure Compiler : Check that the Java Runtime Environment is installed."));
+        return false;
+    }
+
+    std::string jsPlatformDir = gd::ToString(wxGetCwd()+"/JsPlatform/");
+    std::string cmd = javaExec+" -jar \""+jsPlatformDir+"Tools/compiler.jar\" --js ";
+
+    std::string allJsFiles;
+    for ( std::vector<std::string>::const_iterator file = files.begin() ; file != files.end(); ++file )
+        allJsFiles += "\""+*file+"\" ";
+
+    cmd += allJsFiles;
+    cmd += "--js_output_file \""+outputFile+"\"";
+
+    wxArrayString output;
+    wxArrayString errors;
+    long res = wxExecute(cmd, output, errors);
+    if ( res != 0 )
+    {
+        std::cout << "Execution of the closure compiler failed ( Command line : " << cmd << ")." << std::endl;
+        std::cout << "Output: ";
+        bool outOfMemoryError = false;
+        for (size_t i = 0;i<output.size();++i)
+        {
+            outOfMemoryError |= output[i].find("OutOfMemoryError") < output[i].length();
+            std::cout << output[i] << std::endl;
+        }
+        for (size_t i = 0;i<errors.size();++i)
+        {
+            outOfMemoryError |= errors[i].find("OutOfMemoryError") < errors[i].length();
+            std::cout << errors[i] << std::endl;
+        }
+
+        if ( outOfMemoryError)
+            gd::LogWarning(_("The exported script could not be minified with Google Closure Compiler: It seems that the script is too heavy and need too much memory to be minified.\n\nThe integrated minifier will be used instead."));
+        else
+            gd::LogWarning(_("The exported script could not be minified with Google Closure Compiler.\n\nMay be an extension is triggering this error: Try to contact the developer if you think it is the case.\nThe integrated minifier will be used instead."));
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+bool Exporter::MinifyGeneratedFiles(std::vector<std::string> & files, JsMinifier & minifier, bool & closureCompilerUsed,
+    std::string & code)
+{
+    if ( files.empty() ) return true;
+
+    #if !defined(GD_NO_WX_GUI)
+    if ( closureCompilerUsed )
+    {
+        std::string outputFile = fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/closureOutput.js";
+        if ( MinifyWithClosureCompiler(files, outputFile) )
         {
-            lastError = "Unable to write the intel XDK project file.";
-            return false;
+            code += fs.ReadFile(outputFile);
+            code += ";\n";
+            files.clear();
+            return true;
         }
+
+        closureCompilerUsed = false; //Don't try again for the next files.
     }
+    #endif
+
+    for ( std::vector<std::string>::const_iterator file = files.begin() ; file != files.end(); ++file )
     {
-        if ( !fs.CopyFile("./JsPlatform/Runtime/XDKProject.xdke", exportDir+"/XDKProject.xdke") )
+        std::string minifiedCode;
+        if ( !minifier.Minify(fs.ReadFile(*file), minifiedCode) )
         {
-            lastError = "Unable to write the intel XDK second project file.";
+            std::cout << "Unable to minify " << *file << ": " << minifier.GetLastError() << std::endl;
             return false;
         }
+
+        //Files are minified separately, and separated by a semicolon in case a file does not end with one.
+        code += minifiedCode;
+        code += ";\n";
     }
-    #else
-        std::cout << "BAD USE: ExportIntelXDKIndexFile is not available." << std::endl;
-    #endif
 
+    files.clear();
     return true;
 }
 
-bool Exporter::CompleteIndexFile(std::string & str, std::string customCss, std::string customHtml, std::string exportDir, const std::vector<std::string> & includesFiles, std::string additionalSpec)
+bool Exporter::GetMinifiedRuntimeFile(const std::string & file, JsMinifier & minifier, std::string & minifiedCode)
 {
-    size_t pos = str.find("/* GDJS_CUSTOM_STYLE */");
-    if ( pos < str.length() )
-        str = str.replace(pos, 23, customCss);
-    else
+    std::string content = fs.ReadFile(file);
+
+    //The minified files are stored with the signature of the minifier ( its version and its options ) and
+    //the hash and the size of their content as filename.
+    std::string cacheDir = fs.GetTempDir()+"/GDTemporaries/MinifiedRuntime";
+    std::string cacheFile = cacheDir+"/"+minifier.GetSignature()+"_"+ExportManifest::HashContent(content)+"_"
+        +gd::ToString(content.size())+".js";
+    if ( fs.FileExists(cacheFile) )
     {
-        std::cout << "Unable to find /* GDJS_CUSTOM_STYLE */ in index file." << std::endl;
-        lastError = "Unable to find /* GDJS_CUSTOM_STYLE */ in index file.";
-        return false;
+        minifiedCode = fs.ReadFile(cacheFile);
+        return true;
     }
 
-    pos = str.find("<!-- GDJS_CUSTOM_HTML -->");
-    if ( pos < str.length() )
-        str = str.replace(pos, 25, customHtml);
-    else
+    if ( !minifier.Minify(content, minifiedCode) )
     {
-        std::cout << "Unable to find <!-- GDJS_CUSTOM_HTML --> in index file." << std::endl;
-        lastError = "Unable to find <!-- GDJS_CUSTOM_HTML --> in index file.";
+        std::cout << "Unable to minify " << file << ": " << minifier.GetLastError() << std::endl;
         return false;
     }
 
-    pos = str.find("<!-- GDJS_CODE_FILES -->");
-    if ( pos < str.length() )
+    if ( !fs.DirExists(cacheDir) ) fs.MkDir(cacheDir);
+    if ( !fs.WriteToFile(cacheFile, minifiedCode) )
+        std::cout << "Unable to store the minified file in the cache: " << cacheFile << std::endl;
+
+    return true;
+}
+
+bool Exporter::ExportMinifiedIncludes(std::vector<std::string> & includesFiles, std::string exportDir)
+{
+    //The files of the runtime and of the extensions don't change between exports: their minified code
+    //is cached. Only the generated files ( events code, project data... ) are minified at each export,
+    //by groups of consecutive files so as to keep the order of the files.
+    JsMinifier minifier;
+    bool closureCompilerUsed = useClosureCompiler;
+    std::string code;
+    std::vector<std::string> generatedFiles;
+    for ( std::vector<std::string>::iterator include = includesFiles.begin() ; include != includesFiles.end(); ++include )
     {
-        std::string codeFilesIncludes;
-        for (std::vector<std::string>::const_iterator it = includesFiles.begin(); it != includesFiles.end(); ++it)
+        std::string runtimeFile;
+        if ( fs.FileExists("./JsPlatform/Runtime/"+*include) ) runtimeFile = "./JsPlatform/Runtime/"+*include;
+        else if ( fs.FileExists("./JsPlatform/Runtime/Extensions/"+*include) ) runtimeFile = "./JsPlatform/Runtime/Extensions/"+*include;
+        else if ( fs.FileExists(*include) )
         {
-            if ( !fs.FileExists(exportDir+"/"+*it) )
-            {
-                std::cout << "Warning: Unable to found " << exportDir+"/"+*it << "." << std::endl;
-                continue;
-            }
-
-            std::string relativeFile = exportDir+"/"+*it;
-            fs.MakeRelative(relativeFile, exportDir);
-            codeFilesIncludes += "\t<script src=\""+relativeFile+"\"></script>\n";
+            generatedFiles.push_back(*include);
+            continue;
+        }
+        else
+        {
+            std::cout << "Could not minify include file " << *include << " (File not found)." << std::endl;
+            continue;
         }
 
-        str = str.replace(pos, 24, codeFilesIncludes);
+        if ( !MinifyGeneratedFiles(generatedFiles, minifier, closureCompilerUsed, code) ) return false;
+
+        std::string minifiedCode;
+        if ( !GetMinifiedRuntimeFile(runtimeFile, minifier, minifiedCode) ) return false;
+        code += minifiedCode;
+        code += ";\n";
     }
-    else
+    if ( !MinifyGeneratedFiles(generatedFiles, minifier, closureCompilerUsed, code) ) return false;
+
+    std::string codeFile = useHashedFilenames ? AddHashToFilename("code.js", ExportManifest::HashContent(code)) : "code.js";
+    if ( !WriteExportedFile(exportDir+"/"+codeFile, code) ) return false;
+
+    includesFiles.clear();
+    InsertUnique(includesFiles, codeFile);
+    return true;
+}
+
+void Exporter::StripSerializedProject(gd::SerializerElement & projectElement)
+{
+    ClearSerializedArray(projectElement.GetChild("objectsGroups"), "group");
+    ClearSerializedArray(projectElement.GetChild("externalEvents"), "externalEvents");
+
+    gd::SerializerElement & layoutsElement = projectElement.GetChild("layouts");
+    layoutsElement.ConsiderAsArrayOf("layout");
+    for (unsigned int i = 0;i<layoutsElement.GetChildrenCount();++i)
     {
-        std::cout << "Unable to find <!-- GDJS_CODE_FILES --> in index file." << std::endl;
-        lastError = "Unable to find <!-- GDJS_CODE_FILES --> in index file.";
-        return false;
+        gd::SerializerElement & layoutElement = layoutsElement.GetChild(i);
+        ClearSerializedArray(layoutElement.GetChild("objectsGroups"), "group");
+        ClearSerializedArray(layoutElement.GetChild("events"), "event");
     }
+}
 
-    pos = str.find("{}/*GDJS_ADDITIONAL_SPEC*/");
-    if ( pos < str.length() )
-    {
-        if (additionalSpec.empty()) additionalSpec = "{}";
+#if !defined(GD_NO_WX_GUI)
+/**
+ * \brief Update a wxProgressDialog with the progress of the copy of the resources.
+ */
+class ProgressDialogUpdater
+{
+public:
+    ProgressDialogUpdater(wxProgressDialog & dialog_) : dialog(dialog_) {};
 
-        str = str.replace(pos, 26, additionalSpec);
+    void operator()(unsigned int copiedFiles, unsigned int filesCount, const std::string & filename)
+    {
+        dialog.Update(copiedFiles/static_cast<float>(filesCount)*100.0f, _("Exporting ")+filename);
     }
-    else
+
+private:
+    wxProgressDialog & dialog;
+};
+#endif
+
+/**
+ * \brief Log a warning for each file the copier failed to copy.
+ * \return A message telling how many files could not be copied.
+ */
+static std::string LogFailedCopies(const ParallelFilesCopier & copier)
+{
+    for (unsigned int i = 0;i<copier.GetFailedFiles().size();++i)
     {
-        std::cout << "Unable to find {}/*GDJS_ADDITIONAL_SPEC*/ in index file." << std::endl;
-        lastError = "Unable to find {}/*GDJS_ADDITIONAL_SPEC*/ in index file.";
-        return false;
+        const std::pair<std::string, std::string> & file = copier.GetFailedFiles()[i];
+        gd::LogWarning(gd::ToString(_("Unable to copy \"")+file.first+_("\" to \"")+file.second+_("\".")));
     }
 
-    return true;
+    return gd::ToString(_("Unable to copy "))+gd::ToString(copier.GetFailedFiles().size())+gd::ToString(_(" resource file(s)."));
 }
 
-bool Exporter::ExportEventsCode(gd::Project & project, std::string outputDir, std::vector<std::string> & includesFiles)
+size_t Exporter::ExportResources(gd::AbstractFileSystem & fs, gd::Project & project, std::string exportDir,
+    std::map<std::string, std::string> & renamedResources, wxProgressDialog * progressDialog, ExportManifest * manifest,
+    ParallelFilesCopier::ProgressCallback callback, bool hashedFilenames)
 {
-    fs.MkDir(outputDir);
+    ParallelFilesCopier copier(fs);
+    copier.SetManifest(manifest);
+    size_t savedBytes = PrepareResourcesExport(fs, project, exportDir, renamedResources, copier, hashedFilenames);
 
-    //First, do not forget common includes ( They must be included before events generated code files ).
-    InsertUnique(includesFiles, "libs/pixi.js");
-    InsertUnique(includesFiles, "libs/jshashtable.js");
-    InsertUnique(includesFiles, "gd.js");
-    InsertUnique(includesFiles, "libs/hshg.js");
-    InsertUnique(includesFiles, "commontools.js");
-    InsertUnique(includesFiles, "runtimeobject.js");
-    InsertUnique(includesFiles, "runtimescene.js");
-    InsertUnique(includesFiles, "polygon.js");
-    InsertUnique(includesFiles, "force.js");
-    InsertUnique(includesFiles, "layer.js");
-    InsertUnique(includesFiles, "timer.js");
-    InsertUnique(includesFiles, "imagemanager.js");
-    InsertUnique(includesFiles, "runtimegame.js");
-    InsertUnique(includesFiles, "variable.js");
-    InsertUnique(includesFiles, "variablescontainer.js");
-    InsertUnique(includesFiles, "eventscontext.js");
-    InsertUnique(includesFiles, "runtimescene.js");
-    InsertUnique(includesFiles, "runtimeautomatism.js");
-    InsertUnique(includesFiles, "runtimeobject.js");
-    InsertUnique(includesFiles, "spriteruntimeobject.js");
-    InsertUnique(includesFiles, "soundmanager.js");
+    #if !defined(GD_NO_WX_GUI)
+    if ( progressDialog ) callback = ProgressDialogUpdater(*progressDialog);
+    #endif
 
-    //Common includes for events only.
-    InsertUnique(includesFiles, "runtimescenetools.js");
-    InsertUnique(includesFiles, "inputtools.js");
-    InsertUnique(includesFiles, "objecttools.js");
-    InsertUnique(includesFiles, "cameratools.js");
-    InsertUnique(includesFiles, "soundtools.js");
-    InsertUnique(includesFiles, "storagetools.js");
-    InsertUnique(includesFiles, "stringtools.js");
-    InsertUnique(includesFiles, "windowtools.js");
+    if ( !copier.CopyAll(callback) ) LogFailedCopies(copier);
 
-    for (unsigned int i = 0;i<project.GetLayoutsCount();++i)
+    return savedBytes;
+}
+
+size_t Exporter::PrepareResourcesExport(gd::AbstractFileSystem & fs, gd::Project & project, std::string exportDir,
+    std::map<std::string, std::string> & renamedResources, ParallelFilesCopier & copier, bool hashedFilenames,
+    unsigned int * skippedFilesCount_)
+{
+    //Compute the new filenames like gd::ProjectResourcesCopier does, without modifying the project. This is done
+    //before copying any file, so that the new filenames do not depend on the order the files are copied.
+    ResourcesRenamingHelper resourcesMergingHelper(fs);
+    resourcesMergingHelper.SetBaseDirectory(fs.DirNameFrom(project.GetProjectFile()));
+    resourcesMergingHelper.PreserveDirectoriesStructure(false);
+    project.ExposeResources(resourcesMergingHelper);
+    renamedResources = resourcesMergingHelper.GetRenamedResources();
+
+    //Files with the same content are copied only once: the first file found with a content is the one copied,
+    //and the resources using the other files are renamed to use it. Only the files having the same size as another
+    //file can have the same content: the other files are not read ( unless their hash is needed for their filename ).
+    std::map<std::string, std::string> & resourcesNewFilename = resourcesMergingHelper.GetAllResourcesOldAndNewFilename();
+    std::map<std::string, size_t> filesSize;
+    std::map<size_t, unsigned int> sizesCount;
+    for (std::map<std::string, std::string>::const_iterator it = resourcesNewFilename.begin(); it != resourcesNewFilename.end(); ++it)
     {
-        std::set<std::string> eventsIncludes;
-        gd::Layout & exportedLayout = project.GetLayout(i);
-        std::string eventsOutput = EventsCodeGenerator::GenerateSceneEventsCompleteCode(project, exportedLayout,
-            exportedLayout.GetEvents(), eventsIncludes, false /*Export for edittime*/);
-        //Export the code
-        if (fs.WriteToFile(outputDir+"code"+gd::ToString(i)+".js", eventsOutput))
-        {
-            for ( std::set<std::string>::iterator include = eventsIncludes.begin() ; include != eventsIncludes.end(); ++include )
-                InsertUnique(includesFiles, *include);
+        if ( it->first.empty() ) continue;
 
-            InsertUnique(includesFiles, std::string(outputDir+"code"+gd::ToString(i)+".js"));
+        size_t size = GetFileSize(it->first);
+        filesSize[it->first] = size;
+        sizesCount[size]++;
+    }
+
+    std::map<std::string, std::string> exportedFilenames; //New filenames associated to the filename of the file really exported, if different.
+    std::map<std::pair<std::string, size_t>, std::vector< std::pair<std::string, std::string> > > filesByContent; //Hash and size of the files associated to the files copied ( and their exported filename ).
+    size_t savedBytes = 0;
+    unsigned int skippedFilesCount = 0;
+    for (std::map<std::string, std::string>::const_iterator it = resourcesNewFilename.begin(); it != resourcesNewFilename.end(); ++it)
+    {
+        if ( it->first.empty() ) continue;
+
+        std::string exportedFilename = it->second;
+        bool duplicate = false;
+        size_t size = filesSize[it->first];
+        bool sizeShared = sizesCount[size] > 1;
+        std::string hash = sizeShared || hashedFilenames ? ExportManifest::HashFile(it->first) : "";
+        if ( hashedFilenames ) exportedFilename = AddHashToFilename(it->second, hash);
+        if ( sizeShared && !hash.empty() ) //Files which can't be read are never considered as duplicates.
+        {
+            //Files with the same hash are compared, so that a collision of the hashes can't alias different files.
+            std::vector< std::pair<std::string, std::string> > & candidates = filesByContent[std::make_pair(hash, size)];
+            for (unsigned int i = 0;i<candidates.size() && !duplicate;++i)
+            {
+                if ( HaveSameContent(candidates[i].first, it->first) )
+                {
+                    exportedFilename = candidates[i].second;
+                    duplicate = true;
+                    savedBytes += size;
+                    skippedFilesCount++;
+                }
+            }
+            if ( !duplicate ) candidates.push_back(std::make_pair(it->first, exportedFilename));
         }
-        else {
-            lastError = gd::ToString(_("Unable to write ")+outputDir+"code"+gd::ToString(i)+".js");
-            return false;
+
+        if ( exportedFilename != it->second ) exportedFilenames[it->second] = exportedFilename;
+        if ( !duplicate ) copier.AddFile(it->first, exportDir+"/"+exportedFilename);
+    }
+
+    if ( !exportedFilenames.empty() )
+    {
+        const std::map<std::string, std::string> & newFilenames = resourcesMergingHelper.GetNewFilenames();
+        for (std::map<std::string, std::string>::const_iterator it = newFilenames.begin(); it != newFilenames.end(); ++it)
+        {
+            std::map<std::string, std::string>::const_iterator exported = exportedFilenames.find(it->second);
+            if ( exported != exportedFilenames.end() ) renamedResources[it->first] = exported->second;
         }
     }
 
-    return true;
+    if ( skippedFilesCount_ ) *skippedFilesCount_ = skippedFilesCount;
+    return savedBytes;
 }
 
-bool Exporter::ExportIncludesAndLibs(std::vector<std::string> & includesFiles, std::string exportDir, bool minify)
+void Exporter::GetLayoutsResources(gd::Project & project, std::map<std::string, std::vector<std::string> > & layoutsResources)
 {
-    #if !defined(GD_NO_WX_GUI)
-    //Includes files :
-    if ( minify )
+    //Global objects can be used by any layout, as well as external events ( which can be linked by any layout ).
+    ResourcesCollector globalResources;
+    for (unsigned int i = 0;i<project.GetObjectsCount();++i)
+        project.GetObject(i).ExposeResources(globalResources);
+    for (unsigned int i = 0;i<project.GetExternalEventsCount();++i)
+        gd::LaunchResourceWorkerOnEvents(project, project.GetExternalEvents(i).GetEvents(), globalResources);
+
+    gd::ResourcesManager & resources = project.GetResourcesManager();
+    std::vector<std::string> allResources = resources.GetAllResourcesList();
+    for (unsigned int i = 0;i<project.GetLayoutsCount();++i)
     {
-        std::string javaExec = GetJavaExecutablePath();
-        if ( javaExec.empty() || !fs.FileExists(javaExec) )
+        gd::Layout & layout = project.GetLayout(i);
+        ResourcesCollector layoutResources = globalResources;
+        for (unsigned int j = 0;j<layout.GetObjectsCount();++j)
+            layout.GetObject(j).ExposeResources(layoutResources);
+        gd::LaunchResourceWorkerOnEvents(project, layout.GetEvents(), layoutResources);
+
+        //Images are exposed with their names, other resources ( sounds, fonts... ) with their filenames.
+        std::vector<std::string> & usedResources = layoutsResources[layout.GetName()];
+        usedResources.clear();
+        for (unsigned int j = 0;j<allResources.size();++j)
         {
-            std::cout << "Java executable not found." << std::endl;
-            gd::LogWarning(_("The exported script could not be minified : Check that the Java Runtime Environment is installed."));
-            minify = false;
+            if ( layoutResources.images.count(allResources[j]) ||
+                 layoutResources.files.count(resources.GetResource(allResources[j]).GetFile()) )
+                usedResources.push_back(allResources[j]);
         }
-        else
-        {
-            std::string jsPlatformDir = gd::ToString(wxGetCwd()+"/JsPlatform/");
-            std::string cmd = javaExec+" -jar \""+jsPlatformDir+"Tools/compiler.jar\" --js ";
-
-            std::string allJsFiles;
-            for ( std::vector<std::string>::iterator include = includesFiles.begin() ; include != includesFiles.end(); ++include )
-            {
-                if ( fs.FileExists(jsPlatformDir+"Runtime/"+*include) )
-                    allJsFiles += "\""+jsPlatformDir+"Runtime/"+*include+"\" ";
-                else if ( fs.FileExists(jsPlatformDir+"Runtime/Extensions/"+*include) )
-                    allJsFiles += "\""+jsPlatformDir+"Runtime/Extensions/"+*include+"\" ";
-                else if ( fs.FileExists(*include) )
-                    allJsFiles += "\""+*include+"\" ";
-            }
+    }
+}
 
-            cmd += allJsFiles;
-            cmd += "--js_output_file \""+exportDir+"/code.js\"";
+void Exporter::ExportTextureAtlases(gd::Project & project, std::string exportDir,
+    const std::map<std::string, std::string> & renamedResources, std::map<std::string, TextureAtlasFrame> & atlasFrames)
+{
+    #if !defined(GD_NO_WX_GUI)
+    const unsigned int pageSize = 2048;
+    const unsigned int padding = 2;
+
+    //Only the images used by Sprite objects can be packed: other objects and the events could need the whole texture.
+    ResourcesCollector spritesImages;
+    ResourcesCollector otherImages;
+    for (unsigned int i = 0;i<project.GetObjectsCount();++i)
+        project.GetObject(i).ExposeResources(project.GetObject(i).GetType() == "Sprite" ? spritesImages : otherImages);
+    for (unsigned int i = 0;i<project.GetLayoutsCount();++i)
+    {
+        gd::Layout & layout = project.GetLayout(i);
+        for (unsigned int j = 0;j<layout.GetObjectsCount();++j)
+            layout.GetObject(j).ExposeResources(layout.GetObject(j).GetType() == "Sprite" ? spritesImages : otherImages);
 
-            wxArrayString output;
-            wxArrayString errors;
-            long res = wxExecute(cmd, output, errors);
-            if ( res != 0 )
-            {
-                std::cout << "Execution of the closure compiler failed ( Command line : " << cmd << ")." << std::endl;
-                std::cout << "Output: ";
-                bool outOfMemoryError = false;
-                for (size_t i = 0;i<output.size();++i)
-                {
-                    outOfMemoryError |= output[i].find("OutOfMemoryError") < output[i].length();
-                    std::cout << output[i] << std::endl;
-                }
-                for (size_t i = 0;i<errors.size();++i)
-                {
-                    outOfMemoryError |= errors[i].find("OutOfMemoryError") < errors[i].length();
-                    std::cout << errors[i] << std::endl;
-                }
+        gd::LaunchResourceWorkerOnEvents(project, layout.GetEvents(), otherImages);
+    }
+    for (unsigned int i = 0;i<project.GetExternalEventsCount();++i)
+        gd::LaunchResourceWorkerOnEvents(project, project.GetExternalEvents(i).GetEvents(), otherImages);
+
+    //Load the images to be packed, from the export directory.
+    gd::ResourcesManager & resources = project.GetResourcesManager();
+    std::vector<std::string> packedNames;
+    std::vector<std::string> packedFiles;
+    std::vector<wxImage> packedImages;
+    std::map<std::string, std::string> firstResourceUsingFile;
+    std::map<std::string, std::string> resourcesSharingFile; //Resources associated to the packed resource using the same file.
+    TextureAtlasPacker packer(pageSize, padding);
+    for (std::set<std::string>::const_iterator it = spritesImages.images.begin();it != spritesImages.images.end();++it)
+    {
+        const std::string & name = *it;
+        if ( otherImages.images.count(name) || resourcesExcludedFromAtlases.count(name) ) continue;
+        if ( !resources.HasResource(name) || resources.GetResource(name).GetKind() != "image" ) continue;
+
+        //JPEG images would be bigger once stored in a PNG page.
+        std::string file = resources.GetResource(name).GetFile();
+        std::map<std::string, std::string>::const_iterator renamed = renamedResources.find(file);
+        if ( renamed != renamedResources.end() ) file = renamed->second;
+        std::string extension = gd::ToString(wxFileName(file).GetExt().Lower());
+        if ( extension == "jpg" || extension == "jpeg" ) continue;
+
+        //Resources can share the same file ( see ExportResources ): the image is packed only once.
+        std::map<std::string, std::string>::const_iterator firstResource = firstResourceUsingFile.find(file);
+        if ( firstResource != firstResourceUsingFile.end() )
+        {
+            resourcesSharingFile[name] = firstResource->second;
+            continue;
+        }
+        firstResourceUsingFile[file] = name;
 
-                if ( outOfMemoryError)
-                    gd::LogWarning(_("The exported script could not be minified: It seems that the script is too heavy and need too much memory to be minified.\n\nTry using sub events and reduce the number of events."));
-                else
-                    gd::LogWarning(_("The exported script could not be minified.\n\nMay be an extension is triggering this error: Try to contact the developer if you think it is the case."));
-                minify = false;
-            }
-            else
-            {
-                includesFiles.clear();
-                InsertUnique(includesFiles, "code.js");
-                return true;
-            }
+        wxImage image;
+        if ( !wxFileExists(exportDir+"/"+file) || !image.LoadFile(exportDir+"/"+file) ) continue;
+        if ( image.GetWidth() > (int)pageSize/2 || image.GetHeight() > (int)pageSize/2 ) continue;
+        if ( !image.HasAlpha() ) image.InitAlpha();
 
-        }
+        packer.AddRectangle(image.GetWidth(), image.GetHeight());
+        packedNames.push_back(name);
+        packedFiles.push_back(file);
+        packedImages.push_back(image);
     }
-    #else
-    minify = false;
-    #endif
+    if ( packedImages.size() < 2 ) return;
+
+    packer.Pack();
 
-    //If the closure compiler failed or was not request, simply copy all the include files.
-    if ( !minify )
+    //Write the pages
+    std::vector<std::string> pagesFiles;
+    for (unsigned int i = 0;i<packer.GetPagesCount();++i)
     {
-        for ( std::vector<std::string>::iterator include = includesFiles.begin() ; include != includesFiles.end(); ++include )
-        {
-            if ( fs.FileExists("./JsPlatform/Runtime/"+*include) )
-            {
-                std::string path = fs.DirNameFrom(exportDir+"/Extensions/"+*include);
-                if ( !fs.DirExists(path) ) fs.MkDir(path);
+        std::string pageFile = "textureAtlas"+gd::ToString(i)+".png";
+        while ( fs.FileExists(exportDir+"/"+pageFile) ) pageFile = "_"+pageFile; //Don't overwrite a resource.
 
-                fs.CopyFile("./JsPlatform/Runtime/"+*include, exportDir+"/"+*include);
-                //Ok, the filename is relative to the export dir.
-            }
-            else if ( fs.FileExists("./JsPlatform/Runtime/Extensions/"+*include) )
-            {
-                std::string path = fs.DirNameFrom(exportDir+"/Extensions/"+*include);
-                if ( !fs.DirExists(path) ) fs.MkDir(path);
+        wxImage page(packer.GetPageWidth(i), packer.GetPageHeight(i), true);
+        page.SetAlpha();
+        memset(page.GetAlpha(), 0, page.GetWidth()*page.GetHeight());
+        for (unsigned int j = 0;j<packedImages.size();++j)
+        {
+            const TextureAtlasPacker::Placement & placement = packer.GetPlacement(j);
+            if ( placement.packed && placement.page == i )
+                CopyImageToAtlasPage(packedImages[j], page, placement.x, placement.y, padding);
+        }
 
-                fs.CopyFile("./JsPlatform/Runtime/Extensions/"+*include, exportDir+"/Extensions/"+*include);
-                *include = "Extensions/"+*include; //Ensure filename is relative to the export dir.
-            }
-            else if ( fs.FileExists(*include) )
-            {
-                fs.CopyFile(*include, exportDir+"/"+fs.FileNameFrom(*include));
-                *include = fs.FileNameFrom(*include); //Ensure filename is relative to the export dir.
-            }
-            else
-            {
-                std::cout << "Could not copy include file " << *include << " (File not found)." << std::endl;
-            }
+        if ( !page.SaveFile(exportDir+"/"+pageFile, wxBITMAP_TYPE_PNG) )
+        {
+            gd::LogWarning(gd::ToString(_("Unable to write the texture atlas ")+exportDir+"/"+pageFile));
+            return;
         }
+        if ( useHashedFilenames ) pageFile = RenameWithContentHash(exportDir, pageFile);
+        pagesFiles.push_back(pageFile);
     }
 
-    return true;
-}
+    for (unsigned int i = 0;i<packedImages.size();++i)
+    {
+        const TextureAtlasPacker::Placement & placement = packer.GetPlacement(i);
+        if ( !placement.packed ) continue;
+
+        TextureAtlasFrame & frame = atlasFrames[packedNames[i]];
+        frame.file = pagesFiles[placement.page];
+        frame.x = placement.x;
+        frame.y = placement.y;
+        frame.width = packedImages[i].GetWidth();
+        frame.height = packedImages[i].GetHeight();
+    }
+    for (std::map<std::string, std::string>::const_iterator it = resourcesSharingFile.begin();it != resourcesSharingFile.end();++it)
+    {
+        if ( atlasFrames.count(it->second) ) atlasFrames[it->first] = atlasFrames[it->second];
+    }
 
-void Exporter::StripProject(gd::Project & strippedProject)
-{
-    strippedProject.GetObjectGroups().clear();
-    while ( strippedProject.GetExternalEventsCount() > 0 ) strippedProject.RemoveExternalEvents(strippedProject.GetExternalEvents(0).GetName());
+    //Remove the images now in the atlases, unless their files are also used by other resources.
+    std::set<std::string> filesStillUsed;
+    std::vector<std::string> allResources = resources.GetAllResourcesList();
+    for (unsigned int i = 0;i<allResources.size();++i)
+    {
+        if ( atlasFrames.count(allResources[i]) ) continue;
 
-    for (unsigned int i = 0;i<strippedProject.GetLayoutsCount();++i)
+        std::string file = resources.GetResource(allResources[i]).GetFile();
+        std::map<std::string, std::string>::const_iterator renamed = renamedResources.find(file);
+        filesStillUsed.insert(renamed != renamedResources.end() ? renamed->second : file);
+    }
+    for (unsigned int i = 0;i<packedFiles.size();++i)
     {
-        strippedProject.GetLayout(i).GetObjectGroups().clear();
-        strippedProject.GetLayout(i).GetEvents().Clear();
+        if ( atlasFrames.count(packedNames[i]) && !filesStillUsed.count(packedFiles[i]) )
+            wxRemoveFile(exportDir+"/"+packedFiles[i]);
     }
-}
-
-void Exporter::ExportResources(gd::AbstractFileSystem & fs, gd::Project & project, std::string exportDir, wxProgressDialog * progressDialog)
-{
-    gd::ProjectResourcesCopier::CopyAllResourcesTo(project, fs, exportDir, true, progressDialog, false, false);
+    #endif
 }
 
 void Exporter::ShowProjectExportDialog(gd::Project & project)
@@ -534,6 +1870,14 @@ void Exporter::ShowProjectExportDialog(gd::Project & project)
     bool exportForGDShare = dialog.GetExportType() == ProjectExportDialog::GameDevShare;
     bool exportForCocoonJS = dialog.GetExportType() == ProjectExportDialog::CocoonJS;
     bool exportForIntelXDK = dialog.GetExportType() == ProjectExportDialog::IntelXDK;
+    SetClosureCompilerUsed(dialog.RequestClosureCompiler());
+    SetPrecompressedFilesWritten(dialog.RequestPrecompressedFiles());
+    SetTextureAtlasesUsed(dialog.RequestTextureAtlases());
+    SetHashedFilenamesUsed(dialog.RequestHashedFilenames());
+    SetServiceWorkerGenerated(dialog.RequestServiceWorker());
+    SetExportReportFile(dialog.RequestExportReportFile());
+    SetCodeSizeReportFile(dialog.RequestCodeSizeReportFile());
+    SetWhileIterationsLimit(dialog.RequestWhileIterationsLimit());
 
     ExportWholeProject(project, dialog.GetExportDir(), dialog.RequestMinify(),
         exportForGDShare, exportForCocoonJS, exportForIntelXDK);
@@ -547,54 +1891,122 @@ bool Exporter::ExportWholeProject(gd::Project & project, std::string exportDir,
 {
     bool exportToZipFile = exportForGDShare || exportForCocoonJS;
 
+    //The time spent in each stage is always measured, the files written only if a report is requested.
+    ExportReport report(fs, exportDir, !exportReportFile.empty());
     {
         #if !defined(GD_NO_WX_GUI)
         wxProgressDialog progressDialog(_("Export in progress ( 1/2 )"), _("Exporting the project..."));
         #endif
 
         //Prepare the export directory
+        unsigned int stage = report.BeginStage("prepareDirectory");
         fs.MkDir(exportDir);
         fs.ClearDir(exportDir);
         fs.MkDir(exportDir+"/libs");
         fs.MkDir(exportDir+"/Extensions");
         std::vector<std::string> includesFiles;
-
-        gd::Project exportedProject = project;
-
-        //Export the resources ( before generating events as some resources filenames may be updated )
-        #if !defined(GD_NO_WX_GUI)
-        ExportResources(fs, exportedProject, exportDir, &progressDialog);
-        #else
-        ExportResources(fs, exportedProject, exportDir, NULL);
-        #endif
+        report.EndStage(stage);
+
+        //Compute the new filenames of the resources ( before generating events as some resources filenames
+        //may be updated ), then copy the resources in the background while the events are generated.
+        unsigned int resourcesStage = report.BeginStage("resources");
+        std::map<std::string, std::string> renamedResources;
+        ParallelFilesCopier resourcesCopier(fs);
+        unsigned int skippedFilesCount = 0;
+        size_t savedBytes = PrepareResourcesExport(fs, project, exportDir, renamedResources, resourcesCopier,
+            useHashedFilenames, &skippedFilesCount);
+        report.SetDuplicateFiles(skippedFilesCount, savedBytes);
+        if ( skippedFilesCount != 0 )
+            gd::LogStatus(gd::ToString(skippedFilesCount)+gd::ToString(_(" resource file(s) with the same content as another one not copied, "))
+                +gd::ToString(savedBytes)+gd::ToString(_(" bytes saved.")));
+        std::vector<std::string> resourcesFiles; //Counted in the resources stage, though written during the other stages.
+        for (unsigned int i = 0;i<resourcesCopier.GetFiles().size();++i)
+            resourcesFiles.push_back(resourcesCopier.GetFiles()[i].second);
+        report.IgnoreFiles(resourcesFiles);
+        resourcesCopier.Start();
 
         #if !defined(GD_NO_WX_GUI)
-        progressDialog.SetTitle(_("Export in progress ( 2/2 )"));
-        progressDialog.Update(50, _("Exporting events..."));
+        progressDialog.Update(10, _("Exporting events..."));
         #endif
 
         //Export events
-        if ( !ExportEventsCode(exportedProject, fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/", includesFiles) )
+        stage = report.BeginStage("events");
+        std::string codeOutputDir = fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/";
+        if ( !ExportEventsCode(project, codeOutputDir, includesFiles, &renamedResources) )
         {
+            resourcesCopier.Wait();
             gd::LogError(_("Error during exporting: Unable to export events ( "+lastError+")."));
             return false;
         }
+        report.EndStage(stage);
 
+        std::vector<std::string> generatedFiles; //The code generated is written in a temporary directory.
+        for (unsigned int i = 0;i<includesFiles.size();++i)
+        {
+            if ( includesFiles[i].compare(0, codeOutputDir.size(), codeOutputDir) == 0 )
+                generatedFiles.push_back(includesFiles[i]);
+        }
+        report.AddFiles(stage, generatedFiles);
+
+        ParallelFilesCopier::ProgressCallback resourcesCallback = resourcesCopyCallback;
         #if !defined(GD_NO_WX_GUI)
-        progressDialog.Update(60, _("Preparing the project..."));
+        resourcesCallback = ProgressDialogUpdater(progressDialog);
         #endif
+        if ( !resourcesCopier.Wait(resourcesCallback) )
+        {
+            lastError = LogFailedCopies(resourcesCopier);
+            gd::LogError(_("Error during export:\n")+lastError);
+            return false;
+        }
+        report.EndStage(resourcesStage);
+        report.AddFiles(resourcesStage, resourcesFiles); //The files which could not be copied are not counted.
+
+        //Pack the images of the sprites into texture atlases ( before zipping, as packed images are removed ).
+        std::map<std::string, TextureAtlasFrame> atlasFrames;
+        if ( useTextureAtlases )
+        {
+            #if !defined(GD_NO_WX_GUI)
+            progressDialog.Update(45, _("Packing images into texture atlases..."));
+            #endif
+            stage = report.BeginStage("textureAtlases");
+            ExportTextureAtlases(project, exportDir, renamedResources, atlasFrames);
+            report.EndStage(stage);
+        }
 
-        //Strip the project (*after* generating events as the events may use stripped things like objects groups...)...
-        StripProject(exportedProject);
+        //Exporting for online upload requires to zip the whole game: the files are added to the zip file
+        //as soon as they are exported, so that the text files are compressed while the export continues.
+        #if !defined(GD_NO_WX_GUI)
+        wxString zipTempName = fs.GetTempDir()+"/GDTemporaries/zipped_"+ToString(&project)+".zip";
+        ZipPackager zipPackager(std::max(wxThread::GetCPUCount(), 1));
+        if ( exportToZipFile && zipPackager.Open(gd::ToString(zipTempName)) )
+            AddExportedFilesToZip(zipPackager, exportDir);
+        #endif
 
         #if !defined(GD_NO_WX_GUI)
+        progressDialog.SetTitle(_("Export in progress ( 2/2 )"));
         progressDialog.Update(70, _("Exporting files..."));
         #endif
 
-        //...and export it
-        std::string result = ExportToJSON(fs, exportedProject, fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/data.js",
-                                          "gdjs.projectData", false);
-        includesFiles.push_back(fs.GetTempDir()+"/GDTemporaries/JSCodeTemp/data.js");
+        //Export the project, without the events and the objects groups which are only used by the events.
+        //The layouts are exported in their own files, loaded when needed, except for Game Dev Share where
+        //the game is not launched from the export directory. The resources of each layout are listed so that
+        //they are only loaded when the layout is started.
+        stage = report.BeginStage("projectData");
+        std::map<std::string, std::vector<std::string> > layoutsResources;
+        GetLayoutsResources(project, layoutsResources);
+        std::string result = ExportToJSON(fs, project, codeOutputDir+"data.js",
+                                          "gdjs.projectData", false, &renamedResources,
+                                          exportForGDShare ? "" : exportDir, &atlasFrames, useHashedFilenames,
+                                          &layoutsResources);
+        if ( !result.empty() )
+        {
+            lastError = result;
+            gd::LogError(_("Error during export:\n")+lastError);
+            return false;
+        }
+        includesFiles.push_back(codeOutputDir+"data.js");
+        report.EndStage(stage);
+        report.AddFiles(stage, std::vector<std::string>(1, codeOutputDir+"data.js"));
 
         #if !defined(GD_NO_WX_GUI)
         progressDialog.Update(80, minify ? _("Exporting files and minifying them...") : _("Exporting files..."));
@@ -602,11 +2014,23 @@ bool Exporter::ExportWholeProject(gd::Project & project, std::string exportDir,
 
         //Copy all dependencies and the index (or metadata) file.
         std::string additionalSpec = exportForCocoonJS ? "{forceFullscreen:true}" : "";
-        ExportIncludesAndLibs(includesFiles, exportDir, minify);
+        stage = report.BeginStage("includes");
+        if ( !ExportIncludesAndLibs(includesFiles, exportDir, minify) )
+        {
+            gd::LogError(_("Error during export:\n")+lastError);
+            return false;
+        }
+        #if !defined(GD_NO_WX_GUI)
+        if ( exportToZipFile ) AddExportedFilesToZip(zipPackager, exportDir);
+        #endif
+        report.EndStage(stage);
+
+        stage = report.BeginStage("index");
         bool indexFile = false;
-        if (exportForIntelXDK) indexFile = ExportIntelXDKIndexFile(exportedProject, exportDir, includesFiles, additionalSpec);
-        else if (exportForGDShare) indexFile = ExportMetadataFile(exportedProject, exportDir, includesFiles);
-        else indexFile = ExportStandardIndexFile(exportedProject, exportDir, includesFiles, additionalSpec);
+        if (exportForIntelXDK) indexFile = ExportIntelXDKIndexFile(project, exportDir, includesFiles, additionalSpec);
+        else if (exportForGDShare) indexFile = ExportMetadataFile(project, exportDir, includesFiles);
+        else indexFile = ExportStandardIndexFile(project, exportDir, includesFiles, additionalSpec);
+        report.EndStage(stage);
 
         if ( !indexFile)
         {
@@ -614,47 +2038,63 @@ bool Exporter::ExportWholeProject(gd::Project & project, std::string exportDir,
             return false;
         }
 
-        //Exporting for online upload requires to zip the whole game.
-        if ( exportToZipFile )
+        //Write the compressed versions of the text files, for the web servers able to send them as is.
+        if ( writePrecompressedFiles && !exportToZipFile )
         {
             #if !defined(GD_NO_WX_GUI)
-            progressDialog.Update(90, _("Creating the zip file..."));
+            progressDialog.Update(90, _("Compressing files..."));
 
-            //Getting all the files to includes in the directory
+            stage = report.BeginStage("precompressedFiles");
             wxArrayString files;
             wxDir::GetAllFiles(exportDir, &files);
+            PrecompressedFilesWriter precompressedFilesWriter(std::max(wxThread::GetCPUCount(), 1));
+            for (unsigned int i = 0; i < files.size(); ++i)
+                precompressedFilesWriter.AddFile(gd::ToString(files[i]));
 
-            wxString zipTempName = fs.GetTempDir()+"/GDTemporaries/zipped_"+ToString(&project)+".zip";
-            wxFFileOutputStream out(zipTempName);
-            wxZipOutputStream zip(out);
-            for(unsigned int i = 0; i < files.size(); ++i)
-            {
-                wxFileName filename(files[i]);
-                filename.MakeRelativeTo(exportDir);
-                wxFileInputStream file(files[i]);
-                if ( file.IsOk() )
-                {
-                    zip.PutNextEntry(filename.GetFullPath());
-                    zip.Write(file);
-                }
-            }
+            if ( !precompressedFilesWriter.WriteAll() )
+                gd::LogWarning(_("Some compressed versions of the exported files could not be written."));
+            report.EndStage(stage);
+            #endif
+        }
+
+        if ( exportToZipFile )
+        {
+            #if !defined(GD_NO_WX_GUI)
+            progressDialog.Update(90, _("Creating the zip file..."));
 
-            if ( !zip.Close() || !out.Close() )
+            stage = report.BeginStage("zip");
+            AddExportedFilesToZip(zipPackager, exportDir);
+            if ( !zipPackager.Close() )
                 gd::LogWarning(_("Unable to finalize the creation of the zip file!\n\nThe exported project won't be put in a zip file."));
             else
             {
                 progressDialog.Update(95, _("Cleaning files..."));
 
                 fs.ClearDir(exportDir);
-                fs.CopyFile(gd::ToString(zipTempName), exportDir+"/packaged_game.zip");
-                wxRemoveFile(zipTempName);
+                if ( !wxRenameFile(zipTempName, exportDir+"/packaged_game.zip") )
+                {
+                    report.EndStage(stage);
+                    lastError = gd::ToString(_("Unable to move the zip file of the game to ")+exportDir+"/packaged_game.zip"
+                        +_(" ( the zip file is ")+zipTempName+" ).");
+                    gd::LogError(_("Error during export:\n")+lastError);
+                    return false;
+                }
             }
+            report.EndStage(stage);
             #else
             gd::LogError("BAD USE: Trying to export to a zip file, but this feature is not available when wxWidgets support is disabled.");
             #endif
         }
     }
 
+    if ( !exportReportFile.empty() )
+    {
+        gd::SerializerElement reportElement;
+        report.SerializeTo(reportElement);
+        if ( !fs.WriteToFile(exportReportFile, gd::Serializer::ToJSON(reportElement)) )
+            gd::LogWarning(gd::ToString(_("Unable to write the export report to ")+exportReportFile));
+    }
+
     //Finished!
     #if !defined(GD_NO_WX_GUI)
     if ( exportForGDShare )
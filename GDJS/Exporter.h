@@ -8,10 +8,16 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
 #include "GDCore/IDE/ProjectExporter.h"
+#include "GDJS/ParallelFilesCopier.h"
 namespace gd { class Project; }
 namespace gd { class Layout; }
 namespace gd { class AbstractFileSystem; }
+namespace gd { class SerializerElement; }
+namespace gdjs { class ExportManifest; }
+namespace gdjs { class JsMinifier; }
+namespace gdjs { struct TextureAtlasFrame; }
 class wxProgressDialog;
 
 namespace gdjs
@@ -23,7 +29,7 @@ namespace gdjs
 class Exporter : public gd::ProjectExporter
 {
 public:
-    Exporter(gd::AbstractFileSystem & fileSystem) : fs(fileSystem) {};
+    Exporter(gd::AbstractFileSystem & fileSystem) : fs(fileSystem), whileIterationsLimit(0), useClosureCompiler(false), writePrecompressedFiles(false), useTextureAtlases(false), useHashedFilenames(false), generateServiceWorker(false), exportManifest(NULL) {};
     virtual ~Exporter();
 
     /**
@@ -41,6 +47,10 @@ public:
      * \brief Create a preview for the specified layout.
      * \note The preview is not launched, it is the caller responsibility to open a browser pointing to the preview.
      *
+     * A manifest of the exported files is kept in the export directory, so that the next
+     * preview only copies the files which changed and removes the files not used anymore.
+     * The compressed versions of the text files written are written too, for the preview server ( see HttpServer ).
+     *
      * \param layout The layout to be previewed.
      * \param exportDir The directory where the preview must be created.
      * \return true if export was successful.
@@ -50,7 +60,9 @@ public:
     /**
      * \brief Export the specified project.
      *
-     * Called by ShowProjectExportDialog if the user clicked on Ok.
+     * Called by ShowProjectExportDialog if the user clicked on Ok.<br>
+     * The export is made of stages, measured if a report was requested ( see SetExportReportFile ).
+     * The resources are copied while the events are generated.
      */
     bool ExportWholeProject(gd::Project & project, std::string exportDir,
         bool minify, bool exportForGDShare, bool exportForCocoonJS, bool exportForIntelXDK);
@@ -60,6 +72,101 @@ public:
      */
     const std::string & GetLastError() const { return lastError; };
 
+    /**
+     * \brief Bound the number of iterations of the loops generated for While events.
+     *
+     * When a While event reaches the limit, its loop is stopped and
+     * gdjs.EventsContext.onWhileIterationsLimitReached is called at runtime.<br>
+     * The limit is set by the "Export/JS platform/WhileIterationsLimit" setting for exports from the IDE,
+     * by the --while-limit option of gdjs-export, and is always used for previews.
+     * \param limit The maximum number of iterations, or 0 for no limit ( default ).
+     */
+    void SetWhileIterationsLimit(unsigned int limit) { whileIterationsLimit = limit; };
+
+    /**
+     * \brief Make the export write a JSON report of the size of the generated code.
+     *
+     * The report contains the size, raw and compressed with gzip, of the code of each layout and
+     * of each include file, as well as the size of the code generated for each top-level event
+     * and for each type of instruction. The compressed sizes are omitted in builds without wxWidgets.
+     * \param filename The file where the report must be written, or an empty string to disable the report ( default ).
+     */
+    void SetCodeSizeReportFile(const std::string & filename) { codeSizeReportFile = filename; };
+
+    /**
+     * \brief Make ExportWholeProject write a JSON report of the stages of the export.
+     *
+     * The report contains, for each stage ( resources, events, texture atlases... ), the wall time spent
+     * in the stage and the number of files and bytes it wrote. A summary is also written in the console.
+     * \param filename The file where the report must be written, or an empty string to disable the report ( default ).
+     * \see ExportReport
+     */
+    void SetExportReportFile(const std::string & filename) { exportReportFile = filename; };
+
+    /**
+     * \brief Minify the exported files with Google Closure Compiler rather than with the integrated minifier.
+     *
+     * Google Closure Compiler compresses the code better but is much slower, requires Java and
+     * can fail on big games. The integrated minifier is used if it fails.
+     */
+    void SetClosureCompilerUsed(bool enable = true) { useClosureCompiler = enable; };
+
+    /**
+     * \brief Write, along with the exported text files, their gzip and brotli versions ( "file.js.gz"
+     * and "file.js.br" ), so that web servers can send them without compressing them.
+     *
+     * Only used by ExportWholeProject, when the game is not packaged in a zip file. Previews always have
+     * the compressed versions of their text files ( see ExportLayoutForPreview ).
+     * \see PrecompressedFilesWriter
+     */
+    void SetPrecompressedFilesWritten(bool enable = true) { writePrecompressedFiles = enable; };
+
+    /**
+     * \brief Pack the images used by Sprite objects into texture atlases when exporting the whole project.
+     *
+     * The runtime then uses parts of the atlases pages as textures, rather than loading each image.
+     * \see ExportTextureAtlases
+     */
+    void SetTextureAtlasesUsed(bool enable = true) { useTextureAtlases = enable; };
+
+    /**
+     * \brief Exclude ( or include again ) an image resource from the texture atlases.
+     * \param resourceName The name of the image resource.
+     * \param excluded If true, the image is always exported in its own file.
+     */
+    void SetResourceExcludedFromAtlases(const std::string & resourceName, bool excluded = true)
+    {
+        if ( excluded ) resourcesExcludedFromAtlases.insert(resourceName);
+        else resourcesExcludedFromAtlases.erase(resourceName);
+    };
+
+    /**
+     * \brief Put the hash of their content in the filenames of the exported JS files and resources
+     * ( "libs/pixi.js" is exported as "libs/pixi.0123456789abcdef.js" ).
+     *
+     * A file changes of name when its content changes: browsers can keep the files in their cache forever
+     * and only download the files which changed. The index file keeps its name.
+     */
+    void SetHashedFilenamesUsed(bool enable = true) { useHashedFilenames = enable; };
+
+    /**
+     * \brief Generate, with the standard index file, a service worker storing all the files of the game
+     * in the cache of the browsers, and the manifest of these files ( "precache-manifest.json" ).
+     *
+     * The game is then loaded from the cache, even offline, until it is exported again.
+     * \see PrecacheManifest
+     */
+    void SetServiceWorkerGenerated(bool enable = true) { generateServiceWorker = enable; };
+
+    /**
+     * \brief Set a function to be called after each resource copied during an export.
+     *
+     * The function is called with the number of resources copied, the total number of
+     * resources and the filename of the last resource copied.
+     * \note When a wxProgressDialog is shown by the export, it is updated instead.
+     */
+    void SetResourcesCopyProgressCallback(ParallelFilesCopier::ProgressCallback callback) { resourcesCopyCallback = callback; };
+
     #if !defined(GD_NO_WX_GUI)
     /**
      * \brief Try to locate the Java Executable. ( The JRE must be installed ).
@@ -71,15 +178,18 @@ public:
 private:
 
     /**
-     * \brief Create a stripped version of the project for export: Objects groups are deleted as well as all events.
+     * \brief Strip the serialized project for export: objects groups and events, which are only used
+     * to generate the events code, are removed.
      *
-     * \param project The project to be stripped.
-     * \param layout Optional layout name. If not empty, all layouts will be removed except this layout.
+     * \param projectElement The serialized project to be stripped.
      */
-    static void StripProject(gd::Project & project);
+    static void StripSerializedProject(gd::SerializerElement & projectElement);
 
     /**
-     * \brief Export a project to JSON
+     * \brief Export a project to JSON. The project is stripped ( see StripSerializedProject ): its events and
+     * its objects groups are detached from the project while it is serialized, so they are never serialized.
+     * The JSON is streamed to the file when the file is on the native file system.
+     * The hit boxes and the points of the frames of Sprite objects are stored in flat arrays ( see gdjs.SpriteAnimationFrame ).
      *
      * \param fs The abstract file system to use to write the file
      * \param project The project to be exported.
@@ -87,20 +197,96 @@ private:
      * \param wrapIntoVariable If not empty, the resulting json will be wrapped in this javascript
      * variable allowing to use it as a classical javascript object.
      * \param prettyPrinting If set to true, the JSON will be nicely indented
+     * \param renamedResources Optional table of the resources filenames to be replaced by new filenames.
+     * \param layoutsDataDir If not empty, each layout, except the first layout, is written in its own file
+     * in this directory ( "data_layoutX.js" ) and only its name and its file are kept in the project data.
+     * The runtime loads these files when the layouts are needed ( see gdjs.RuntimeGame.loadSceneData ).
+     * \param atlasFrames Optional table of the image resources packed in texture atlases ( see ExportTextureAtlases ).
+     * \param hashedFilenames If true, the hash of their content is put in the filenames of the layouts files.
+     * \param layoutsResources Optional table of the resources used by each layout ( see GetLayoutsResources ),
+     * stored in the "usedResources" array of the layouts so that the runtime only loads the resources of a layout
+     * when the layout is started.
      * \return Empty string if everthing is ok, description of the error otherwise.
      */
-    static std::string ExportToJSON(gd::AbstractFileSystem & fs, const gd::Project & project, std::string filename, std::string wrapIntoVariable = "", bool prettyPrinting = false);
+    static std::string ExportToJSON(gd::AbstractFileSystem & fs, gd::Project & project, std::string filename,
+        std::string wrapIntoVariable = "", bool prettyPrinting = false,
+        const std::map<std::string, std::string> * renamedResources = NULL, std::string layoutsDataDir = "",
+        const std::map<std::string, TextureAtlasFrame> * atlasFrames = NULL, bool hashedFilenames = false,
+        const std::map<std::string, std::vector<std::string> > * layoutsResources = NULL);
 
     /**
-     * \brief Copy all the resources of the project to to the export directory, updating the resources filenames.
+     * \brief Compute the names of the resources used by each layout: the resources used by its objects
+     * and its events, and by the global objects and the external events.
+     * \param project The project.
+     * \param layoutsResources Filled with the name of each layout, associated to the names of the resources it uses.
+     */
+    static void GetLayoutsResources(gd::Project & project, std::map<std::string, std::vector<std::string> > & layoutsResources);
+
+    /**
+     * \brief Copy all the resources of the project to to the export directory.
+     *
+     * The project is not modified: the new filenames of the resources are stored in \a renamedResources.
+     * Resources are copied in parallel ( see ParallelFilesCopier ).<br>
+     * Files with the same content are copied only once, and all the resources using them are renamed
+     * to use the copied file.
      *
      * \param fs The abstract file system to use
      * \param project The project with resources to be exported.
      * \param exportDir The directory where the preview must be created.
+     * \param renamedResources Filled with the filenames of the resources associated to their new filenames.
      * \param progressDlg Optional wxProgressDialog which will be updated with the progress.
+     * \param manifest Optional manifest of the export directory. If set, only the resources which changed are copied.
+     * \param callback Optional function called with the progress, if \a progressDlg is NULL.
+     * \param hashedFilenames If true, the hash of their content is put in the new filenames of the resources.
+     * \return The number of bytes not written thanks to the files with the same content.
+     */
+    static size_t ExportResources(gd::AbstractFileSystem & fs, gd::Project & project, std::string exportDir,
+        std::map<std::string, std::string> & renamedResources,
+        wxProgressDialog * progressDlg = NULL, ExportManifest * manifest = NULL,
+        ParallelFilesCopier::ProgressCallback callback = ParallelFilesCopier::ProgressCallback(),
+        bool hashedFilenames = false);
+
+    /**
+     * \brief Compute the new filenames of the resources of the project, and add the files to be copied
+     * to the copier, without copying them. Used by ExportResources, and by ExportWholeProject to copy
+     * the resources while the events are generated.
+     *
+     * \param fs The abstract file system to use
+     * \param project The project with resources to be exported.
+     * \param exportDir The directory where the resources must be copied.
+     * \param renamedResources Filled with the filenames of the resources associated to their new filenames.
+     * \param copier The copier where the files to be copied are added.
+     * \param hashedFilenames If true, the hash of their content is put in the new filenames of the resources.
+     * \param skippedFilesCount If not NULL, set to the number of files not copied because they have the same content as another file.
+     * \return The number of bytes not written thanks to the files with the same content.
+     */
+    static size_t PrepareResourcesExport(gd::AbstractFileSystem & fs, gd::Project & project, std::string exportDir,
+        std::map<std::string, std::string> & renamedResources, ParallelFilesCopier & copier, bool hashedFilenames = false,
+        unsigned int * skippedFilesCount = NULL);
+
+    /**
+     * \brief Pack the images used only by Sprite objects into texture atlases pages ( "textureAtlasX.png" ),
+     * and remove the packed images from the export directory.
+     *
+     * JPEG images, big images ( more than half of a page ) and the resources excluded with
+     * SetResourceExcludedFromAtlases are not packed.
+     * \param project The project being exported.
+     * \param exportDir The export directory, where the resources were already exported.
+     * \param renamedResources The new filenames of the resources ( see ExportResources ).
+     * \param atlasFrames Filled with the name of each image packed, associated to its location in the atlases.
+     */
+    void ExportTextureAtlases(gd::Project & project, std::string exportDir,
+        const std::map<std::string, std::string> & renamedResources, std::map<std::string, TextureAtlasFrame> & atlasFrames);
+
+    /**
+     * \brief Copy a file to the export directory, using the manifest of the current export if any.
+     */
+    bool CopyExportedFile(const std::string & source, const std::string & destination);
+
+    /**
+     * \brief Write a file in the export directory, using the manifest of the current export if any.
      */
-    static void ExportResources(gd::AbstractFileSystem & fs, gd::Project & project, std::string exportDir,
-        wxProgressDialog * progressDlg = NULL);
+    bool WriteExportedFile(const std::string & destination, const std::string & content);
 
     /**
      * \brief Copy all the includes files and the standard libraries files to the export directory.
@@ -110,21 +296,61 @@ private:
      *
      * \param includesFiles A vector with filenames to be copied.
      * \param exportDir The directory where the preview must be created.
-     * \param minify If true, the includes files must be merged into one file using Google Closure Compiler.
+     * \param minify If true, the includes files must be minified and merged into one file ( see SetClosureCompilerUsed ).
      * ( includesFiles parameter will be updated with the new filename )
+     * \return false if a file could not be copied ( the other files are still copied, and the error is stored in lastError ).
+     * \see SetHashedFilenamesUsed
      */
     bool ExportIncludesAndLibs(std::vector<std::string> & includesFiles, std::string exportDir, bool minify);
 
+    /**
+     * \brief Minify the includes files and merge them into "code.js".
+     *
+     * The files of the runtime and of the extensions are minified with the integrated minifier, and the
+     * result is cached ( see GetMinifiedRuntimeFile ). The other files are minified at each export, with
+     * Google Closure Compiler if it is used ( see SetClosureCompilerUsed ).
+     * \return false if a file could not be minified ( in this case, nothing is written ).
+     */
+    bool ExportMinifiedIncludes(std::vector<std::string> & includesFiles, std::string exportDir);
+
+    /**
+     * \brief Minify the files and append the result to \a code. \a files is emptied.
+     * \param closureCompilerUsed True to use Google Closure Compiler. Set to false if it failed.
+     */
+    bool MinifyGeneratedFiles(std::vector<std::string> & files, JsMinifier & minifier, bool & closureCompilerUsed,
+        std::string & code);
+
+    /**
+     * \brief Get the minified code of a file of the runtime or of an extension.
+     *
+     * The minified code is stored in a cache in the temporary directory, using the hash of the
+     * content of the file and the signature of the minifier ( see JsMinifier::GetSignature ), so that
+     * the file is only minified again when it or the minifier changes.
+     */
+    bool GetMinifiedRuntimeFile(const std::string & file, JsMinifier & minifier, std::string & minifiedCode);
+
+    #if !defined(GD_NO_WX_GUI)
+    /**
+     * \brief Minify and merge the files into \a outputFile using Google Closure Compiler.
+     */
+    bool MinifyWithClosureCompiler(const std::vector<std::string> & files, std::string outputFile);
+    #endif
+
     /**
      * \brief Generate the events JS code, and save them to the export directory.
      *
      * Files are named "codeX.js", X being the number of the layout in the project.
+     * External events linked by the layouts are generated once in "externalEventsCode.js".
+     * Only the runtime files declaring the events tools used by the events and the extensions are included.
+     * If a code size report file was set, the report is written too ( see SetCodeSizeReportFile ).
      * \param project The project with resources to be exported.
      * \param outputDir The directory where the events code must be generated.
      * \param includesFiles A reference to a vector that will be filled with JS files to be exported along with the project.
      * ( including "codeX.js" files ).
+     * \param renamedResources Optional table of the resources filenames to be replaced by new filenames in the events.
      */
-    bool ExportEventsCode(gd::Project & project, std::string outputDir, std::vector<std::string> & includesFiles);
+    bool ExportEventsCode(gd::Project & project, std::string outputDir, std::vector<std::string> & includesFiles,
+        const std::map<std::string, std::string> * renamedResources = NULL);
 
     /**
      * \brief Generate the standard index file and save it to the export directory.
@@ -135,6 +361,9 @@ private:
      * \param exportDir The directory where the preview must be created.
      * \param includesFiles The JS files to be included in the HTML file. Order is important.
      * \param additionalSpec JSON string that will be passed to the gdjs.RuntimeGame object.
+     *
+     * \note If SetServiceWorkerGenerated was called, the service worker and its manifest are generated
+     * from the includes files and the files at the root of the export directory ( the resources ).
      */
     bool ExportStandardIndexFile(gd::Project & project, std::string exportDir, const std::vector<std::string> & includesFiles, std::string additionalSpec = "");
 
@@ -176,6 +405,17 @@ private:
 
     gd::AbstractFileSystem & fs; ///< The abstract file system to be used for exportation.
     std::string lastError; ///< The last error that occurred.
+    unsigned int whileIterationsLimit; ///< The maximum number of iterations of While events. 0 means no limit.
+    bool useClosureCompiler; ///< True to minify the files with Google Closure Compiler.
+    bool writePrecompressedFiles; ///< True to write the gzip and brotli versions of the exported text files.
+    bool useTextureAtlases; ///< True to pack the images of the sprites into texture atlases.
+    bool useHashedFilenames; ///< True to put the hash of their content in the filenames of the exported files.
+    bool generateServiceWorker; ///< True to generate a service worker caching the files of the game.
+    std::set<std::string> resourcesExcludedFromAtlases; ///< The image resources never packed into texture atlases.
+    std::string codeSizeReportFile; ///< If not empty, the file where the code size report is written.
+    std::string exportReportFile; ///< If not empty, the file where the report of the stages of the export is written.
+    ExportManifest * exportManifest; ///< The manifest of the export being done, if the export is incremental ( can be NULL ).
+    ParallelFilesCopier::ProgressCallback resourcesCopyCallback; ///< Optional function called with the progress of the copy of resources.
 };
 
 }
@@ -0,0 +1,135 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#if defined(__linux__) && !defined(EMSCRIPTEN)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <linux/fs.h>
+#endif
+#include "GDCore/IDE/AbstractFileSystem.h"
+#include "GDJS/FastFileCopy.h"
+#undef CopyFile //Disable an annoying macro
+
+namespace gdjs
+{
+
+#if defined(__linux__) && !defined(EMSCRIPTEN)
+namespace
+{
+    /**
+     * \brief Copy the content of a file using copy_file_range.
+     * \return false if nothing could be copied because copy_file_range is not supported.
+     */
+    bool CopyFileRange(int sourceFd, int destinationFd, off_t size, bool & error)
+    {
+        #if defined(__NR_copy_file_range)
+        off_t copied = 0;
+        while ( copied < size )
+        {
+            ssize_t result = syscall(__NR_copy_file_range, sourceFd, NULL, destinationFd, NULL, size-copied, 0);
+            if ( result < 0 && errno == EINTR ) continue;
+            if ( result <= 0 )
+            {
+                //Not supported ( old kernel, or files on different file systems ): let another method copy the file.
+                if ( copied == 0 && (result == 0 || errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP) )
+                    return false;
+
+                error = true;
+                return true;
+            }
+
+            copied += result;
+        }
+
+        return true;
+        #else
+        return false;
+        #endif
+    }
+
+    /**
+     * \brief Copy the content of a file using sendfile.
+     * \return false if nothing could be copied because sendfile is not supported.
+     */
+    bool SendFile(int sourceFd, int destinationFd, off_t size, bool & error)
+    {
+        off_t offset = 0;
+        while ( offset < size )
+        {
+            ssize_t result = sendfile(destinationFd, sourceFd, &offset, size-offset);
+            if ( result < 0 && errno == EINTR ) continue;
+            if ( result <= 0 )
+            {
+                if ( offset == 0 && (result == 0 || errno == ENOSYS || errno == EINVAL) ) return false;
+
+                error = true;
+                return true;
+            }
+        }
+
+        return true;
+    }
+}
+#endif
+
+bool FastFileCopy::CopyWithKernel(const std::string & source, const std::string & destination, bool allowHardLinks)
+{
+    #if defined(__linux__) && !defined(EMSCRIPTEN)
+    struct stat sourceStat;
+    if ( stat(source.c_str(), &sourceStat) != 0 || !S_ISREG(sourceStat.st_mode) ) return false;
+
+    //Remove the destination first: it may be a hard link to the source, made by a previous export.
+    unlink(destination.c_str());
+    if ( allowHardLinks && link(source.c_str(), destination.c_str()) == 0 )
+        return true;
+
+    int sourceFd = open(source.c_str(), O_RDONLY);
+    if ( sourceFd < 0 ) return false;
+    int destinationFd = open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC, sourceStat.st_mode & 0777);
+    if ( destinationFd < 0 )
+    {
+        close(sourceFd);
+        return false;
+    }
+
+    bool error = false;
+    bool copied = sourceStat.st_size == 0;
+    #if defined(FICLONE)
+    if ( !copied ) copied = ioctl(destinationFd, FICLONE, sourceFd) == 0;
+    #endif
+    if ( !copied ) copied = CopyFileRange(sourceFd, destinationFd, sourceStat.st_size, error);
+    if ( !copied ) copied = SendFile(sourceFd, destinationFd, sourceStat.st_size, error);
+
+    close(sourceFd);
+    if ( close(destinationFd) != 0 ) error = true;
+
+    if ( !copied || error )
+    {
+        unlink(destination.c_str());
+        return false;
+    }
+
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+bool FastFileCopy::Copy(gd::AbstractFileSystem & fs, const std::string & source, const std::string & destination,
+    bool allowHardLinks)
+{
+    if ( source == destination ) return true;
+    if ( CopyWithKernel(source, destination, allowHardLinks) ) return true;
+
+    return fs.CopyFile(source, destination);
+}
+
+}
@@ -0,0 +1,44 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef FASTFILECOPY_H
+#define FASTFILECOPY_H
+#include <string>
+namespace gd { class AbstractFileSystem; }
+
+namespace gdjs
+{
+
+/**
+ * \brief Tools to copy files without reading them into memory, when the files are on the native file system.
+ *
+ * On Linux, files are copied using ( in this order, the first one supported by the kernel
+ * and the file system being used ): reflinks ( copy-on-write clones ), copy_file_range and sendfile.
+ * Hard links can also be used if the destination is never modified ( like for previews ).
+ * If none of these methods work, or on other platforms, the copy is done using gd::AbstractFileSystem::CopyFile.
+ */
+class FastFileCopy
+{
+public:
+    /**
+     * \brief Copy \a source to \a destination.
+     *
+     * \param fs The file system used if the file can't be copied by the kernel.
+     * \param allowHardLinks If true, \a destination can be a hard link to \a source. Only use it
+     * if the destination is never modified in place.
+     * \return true if the file was copied.
+     */
+    static bool Copy(gd::AbstractFileSystem & fs, const std::string & source, const std::string & destination,
+        bool allowHardLinks = false);
+
+    /**
+     * \brief Copy \a source to \a destination using only the copy methods provided by the kernel.
+     * \return false if the file could not be copied this way ( nothing is written in this case ).
+     */
+    static bool CopyWithKernel(const std::string & source, const std::string & destination, bool allowHardLinks);
+};
+
+}
+#endif // FASTFILECOPY_H
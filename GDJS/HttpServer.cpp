@@ -7,21 +7,165 @@
 #include "HttpServer.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include <vector>
 #include "mongoose/mongoose.h"
 
 namespace gdjs
 {
 
+/**
+ * \brief Return true if the Accept-Encoding header allows the encoding ( and does not forbid it with q=0 ).
+ */
+static bool AcceptsEncoding(const char * acceptEncoding, const std::string & encoding)
+{
+    std::string header = acceptEncoding;
+    size_t start = 0;
+    while ( start < header.size() )
+    {
+        size_t end = header.find(',', start);
+        if ( end == std::string::npos ) end = header.size();
+
+        std::string token = header.substr(start, end-start);
+        size_t parameters = token.find(';');
+        std::string name = token.substr(0, parameters);
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t")+1);
+
+        if ( name == encoding )
+        {
+            if ( parameters == std::string::npos ) return true;
+
+            std::string quality = token.substr(parameters+1);
+            size_t q = quality.find("q=");
+            return q == std::string::npos || atof(quality.c_str()+q+2) > 0;
+        }
+
+        start = end+1;
+    }
+
+    return false;
+}
+
+/**
+ * \brief Return true if the filename contains the hash of its content ( "file.0123456789abcdef.js" ),
+ * in which case the content of the file never changes.
+ */
+static bool IsHashedFilename(const std::string & path)
+{
+    size_t slash = path.find_last_of('/');
+    std::string filename = slash == std::string::npos ? path : path.substr(slash+1);
+
+    size_t dot = filename.find_last_of('.');
+    if ( dot == std::string::npos ) dot = filename.size();
+    size_t hashDot = filename.find_last_of('.', dot-1);
+    if ( dot == 0 || hashDot == std::string::npos || dot-hashDot-1 != 16 ) return false;
+
+    for (size_t i = hashDot+1;i<dot;++i)
+    {
+        if ( !isxdigit(static_cast<unsigned char>(filename[i])) ) return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Send the file as the content of the requested file.
+ * \param encoding The encoding of the file ( "br", "gzip" ), or NULL if it is the requested file itself.
+ * \return false if the file can't be opened.
+ */
+static bool SendFile(struct mg_connection * conn, const std::string & requestedPath, const std::string & path,
+    const char * encoding)
+{
+    struct stat fileStat;
+    if ( stat(path.c_str(), &fileStat) != 0 ) return false;
+    FILE * file = fopen(path.c_str(), "rb");
+    if ( !file ) return false;
+
+    //Files with a hashed filename can be cached forever: a new content would have another filename.
+    mg_printf(conn,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: %s\r\n"
+        "%s%s%s"
+        "Content-Length: %ld\r\n"
+        "Vary: Accept-Encoding\r\n"
+        "Cache-Control: %s\r\n\r\n",
+        mg_get_builtin_mime_type(requestedPath.c_str()),
+        encoding ? "Content-Encoding: " : "", encoding ? encoding : "", encoding ? "\r\n" : "",
+        (long)fileStat.st_size,
+        IsHashedFilename(requestedPath) ? "public, max-age=31536000, immutable" : "no-cache");
+
+    if ( strcmp(mg_get_request_info(conn)->request_method, "HEAD") != 0 )
+    {
+        std::vector<char> buffer(64*1024);
+        size_t read = 0;
+        while ( (read = fread(&buffer[0], 1, buffer.size(), file)) > 0 )
+        {
+            if ( mg_write(conn, &buffer[0], read) <= 0 ) break;
+        }
+    }
+    fclose(file);
+
+    return true;
+}
+
+/**
+ * \brief Send the brotli or gzip version of the requested file ( "file.js.br" or "file.js.gz" ), if it exists,
+ * is up to date and is accepted by the client. Files with a hashed filename are sent with headers allowing
+ * the browsers to cache them forever.
+ * \return 1 if the file was sent, 0 to let mongoose handle the request.
+ */
+static int SendExportedFile(struct mg_connection * conn)
+{
+    const struct mg_request_info * request = mg_get_request_info(conn);
+    if ( !request->user_data || !request->uri ) return 0;
+    if ( strcmp(request->request_method, "GET") != 0 && strcmp(request->request_method, "HEAD") != 0 ) return 0;
+    if ( mg_get_header(conn, "Range") != NULL ) return 0; //Ranges are expressed in the uncompressed file.
+
+    std::string uri = request->uri;
+    if ( uri.empty() || uri[0] != '/' || uri.find("..") != std::string::npos ) return 0;
+    if ( uri[uri.size()-1] == '/' ) uri += "index.html";
+
+    std::string path = *static_cast<const std::string*>(request->user_data) + uri;
+    struct stat fileStat;
+    if ( stat(path.c_str(), &fileStat) != 0 ) return 0;
+
+    const char * acceptEncoding = mg_get_header(conn, "Accept-Encoding");
+    const char * encodings[] = {"br", "gzip"};
+    const char * extensions[] = {".br", ".gz"};
+    for (unsigned int i = 0;i<2 && acceptEncoding;++i)
+    {
+        if ( !AcceptsEncoding(acceptEncoding, encodings[i]) ) continue;
+
+        //The compressed file must not be older than the file ( it would be outdated ).
+        std::string compressedPath = path+extensions[i];
+        struct stat compressedStat;
+        if ( stat(compressedPath.c_str(), &compressedStat) != 0 || compressedStat.st_mtime < fileStat.st_mtime )
+            continue;
+
+        if ( SendFile(conn, path, compressedPath, encodings[i]) ) return 1;
+    }
+
+    if ( IsHashedFilename(path) && SendFile(conn, path, path, NULL) ) return 1;
+
+    return 0;
+}
+
 void HttpServer::Run(std::string indexDirectory)
 {
+    documentRoot = indexDirectory;
+
     //Some options ( Last option must be NULL )
-    const char *options[] = {"listening_ports", "2828", "document_root", indexDirectory.c_str(), NULL};
+    const char *options[] = {"listening_ports", "2828", "document_root", documentRoot.c_str(), NULL};
 
-    //Setup callbacks, i.e. nothing to do :)
+    //Serve the compressed versions of the files when they exist, and let browsers cache the hashed files.
     struct mg_callbacks callbacks;
     memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.begin_request = &SendExportedFile;
 
-    ctx = mg_start(&callbacks, NULL, options);
+    ctx = mg_start(&callbacks, &documentRoot, options);
 }
 
 void HttpServer::Stop()
@@ -15,7 +15,13 @@ namespace gdjs
 /**
  * \brief A very simple web server.
  *
- * Basically a wrapper around mongoose ( https://github.com/valenok/mongoose ).
+ * Basically a wrapper around mongoose ( https://github.com/valenok/mongoose ).<br>
+ * When a file has a brotli or gzip version ( "file.js.br" or "file.js.gz" ) which is up to date,
+ * this version is sent to the clients accepting it.<br>
+ * Files with the hash of their content in their filename ( see Exporter::SetHashedFilenamesUsed ) are sent
+ * with headers allowing browsers to cache them forever.
+ *
+ * \see PrecompressedFilesWriter
  */
 class HttpServer
 {
@@ -45,6 +51,7 @@ public:
 
 private:
     struct mg_context * ctx;
+    std::string documentRoot;
 };
 
 }
@@ -6,6 +6,7 @@
 #include "JsCodeEvent.h"
 #include <iostream>
 #include <fstream>
+#include <cctype>
 #if !defined(GD_NO_WX_GUI)
 #include <wx/filename.h>
 #include <wx/dcmemory.h>
@@ -89,8 +90,7 @@ std::string JsCodeEvent::GenerateAssociatedFileCode() const
 {
     std::string output;
 
-    output += "gdjs.customCode = gdjs.customCode || {};\n";
-    output += "gdjs.customCode."+GetFunctionToCall()+" = function(";
+    output += GetFunctionToCall()+" = function(";
     if (passSceneAsParameter) output += "scene";
     if (passObjectListAsParameter) output += std::string(passSceneAsParameter ? ", " : "") + "objectsList";
 
@@ -101,6 +101,130 @@ std::string JsCodeEvent::GenerateAssociatedFileCode() const
     return output;
 }
 
+/**
+ * \brief Return true if the word prevents the code from being inlined in the events function:
+ * keywords only valid inside a function, declarations ( which are scoped to the whole events
+ * function, not to the block of the event ) and the names of the variables of the events function.
+ */
+static bool PreventsInlining(const std::string & word)
+{
+    static const char * forbiddenWords[] = {
+        "return", "this", "arguments", //Only valid inside a function.
+        "var", "let", "const", "function", "eval", //Declarations would leak into the events function.
+        "runtimeScene", "context", "i", "j", "k", "l", "len", "jLen" //Variables of the events function.
+    };
+    for (unsigned int i = 0;i<sizeof(forbiddenWords)/sizeof(forbiddenWords[0]);++i)
+        if ( word == forbiddenWords[i] ) return true;
+
+    return word.compare(0, 16, "cachedExpression") == 0; //See EventsCodeGenerator::GenerateCachedExpressionsDeclarations
+}
+
+/**
+ * \brief Find the identifiers of the code which are not properties ( i.e: not preceded by a dot ),
+ * skipping strings and comments.
+ *
+ * \return false if the code contains something which can't be classified without a real Javascript
+ * parser ( a "/" which could be a division or a regular expression, a template literal... ).
+ */
+static bool FindIdentifiers(const std::string & code, std::vector<size_t> & identifiersStart, std::vector<size_t> & identifiersLength)
+{
+    for (size_t i = 0;i<code.length();)
+    {
+        char c = code[i];
+        if ( c == '"' || c == '\'' )
+        {
+            for (++i;i<code.length() && code[i] != c;++i)
+                if ( code[i] == '\\' ) ++i;
+            ++i;
+        }
+        else if ( c == '/' && i+1 < code.length() && code[i+1] == '/' )
+        {
+            i = code.find('\n', i);
+            if ( i == std::string::npos ) break;
+        }
+        else if ( c == '/' && i+1 < code.length() && code[i+1] == '*' )
+        {
+            i = code.find("*/", i+2);
+            if ( i == std::string::npos ) break;
+            i += 2;
+        }
+        else if ( c == '/' || c == '`' ) //Regular expression, division or template literal.
+            return false;
+        else if ( isalpha(c) || c == '_' || c == '$' )
+        {
+            size_t start = i;
+            while ( i < code.length() && (isalnum(code[i]) || code[i] == '_' || code[i] == '$') ) ++i;
+
+            if ( start == 0 || code[start-1] != '.' )
+            {
+                identifiersStart.push_back(start);
+                identifiersLength.push_back(i-start);
+            }
+        }
+        else
+            ++i;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Return true if the identifier at the given position is used as the name of a property
+ * in an object literal ( like "scene" in "{scene: 1}" ).
+ */
+static bool IsPropertyName(const std::string & code, size_t identifierEnd)
+{
+    size_t next = code.find_first_not_of(" \t\r\n", identifierEnd);
+    return next != std::string::npos && code[next] == ':';
+}
+
+bool JsCodeEvent::CanBeInlined() const
+{
+    if ( !codeInlined ) return false;
+
+    std::vector<size_t> identifiersStart;
+    std::vector<size_t> identifiersLength;
+    if ( !FindIdentifiers(inlineCode, identifiersStart, identifiersLength) ) return false;
+
+    for (unsigned int i = 0;i<identifiersStart.size();++i)
+    {
+        std::string word = inlineCode.substr(identifiersStart[i], identifiersLength[i]);
+        if ( PreventsInlining(word) ) return false;
+
+        //The parameters are renamed when inlined: they must only be used as variables.
+        if ( ((passSceneAsParameter && word == "scene") || (passObjectListAsParameter && word == "objectsList"))
+             && IsPropertyName(inlineCode, identifiersStart[i]+identifiersLength[i]) )
+            return false;
+    }
+
+    return true;
+}
+
+std::string JsCodeEvent::GetInlinedCode(const std::string & sceneName, const std::string & objectsListName) const
+{
+    std::vector<size_t> identifiersStart;
+    std::vector<size_t> identifiersLength;
+    if ( !FindIdentifiers(inlineCode, identifiersStart, identifiersLength) ) return inlineCode;
+
+    std::string code;
+    size_t copiedUntil = 0;
+    for (unsigned int i = 0;i<identifiersStart.size();++i)
+    {
+        std::string word = inlineCode.substr(identifiersStart[i], identifiersLength[i]);
+        std::string newName;
+        if ( passSceneAsParameter && word == "scene" ) newName = sceneName;
+        else if ( passObjectListAsParameter && word == "objectsList" ) newName = objectsListName;
+        else continue;
+
+        code += inlineCode.substr(copiedUntil, identifiersStart[i]-copiedUntil);
+        code += newName;
+        copiedUntil = identifiersStart[i]+identifiersLength[i];
+    }
+    code += inlineCode.substr(copiedUntil);
+
+    return code;
+}
+
 /**
  * Render the event in the bitmap
  */
@@ -178,6 +302,7 @@ void JsCodeEvent::SerializeTo(gd::SerializerElement & element) const
     element.AddChild("passObjectListAsParameter").SetValue(passObjectListAsParameter);
     element.AddChild("objectToPassAsParameter").SetValue(objectToPassAsParameter);
 
+    element.AddChild("codeInlined").SetValue(codeInlined);
     element.AddChild("codeDisplayedInEditor").SetValue(codeDisplayedInEditor);
     element.AddChild("displayedName").SetValue(displayedName);
 
@@ -196,6 +321,8 @@ void JsCodeEvent::UnserializeFrom(gd::Project & project, const gd::SerializerEle
     passObjectListAsParameter = element.GetChild("passObjectListAsParameter").GetValue().GetBool();
     objectToPassAsParameter = element.GetChild("objectToPassAsParameter").GetValue().GetString();
 
+    //Events saved before the inlining was added keep their code in a function.
+    codeInlined = element.HasChild("codeInlined") ? element.GetChild("codeInlined").GetValue().GetBool() : false;
     codeDisplayedInEditor = element.GetChild("codeDisplayedInEditor").GetValue().GetBool();
     displayedName = element.GetChild("displayedName").GetValue().GetString();
 
@@ -238,6 +365,7 @@ void JsCodeEvent::Init(const JsCodeEvent & event)
     passObjectListAsParameter = event.passObjectListAsParameter;
     objectToPassAsParameter = event.objectToPassAsParameter;
 
+    codeInlined = event.codeInlined;
     codeDisplayedInEditor = event.codeDisplayedInEditor;
     displayedName = event.displayedName;
 }
@@ -270,6 +398,7 @@ JsCodeEvent::JsCodeEvent() :
     inlineCode("scene.setBackgroundColor(100,100,240);\n"),
     passSceneAsParameter(true),
     passObjectListAsParameter(false),
+    codeInlined(true),
     codeDisplayedInEditor(true)
 {
 }
@@ -54,6 +54,40 @@ public:
     std::string GetObjectToPassAsParameter() const { return objectToPassAsParameter; };
     void SetObjectToPassAsParameter(std::string objectName) { objectToPassAsParameter = objectName; };
 
+    /**
+     * \brief Return true if the code must be inserted directly into the events generated code
+     * instead of being wrapped into a function called by the events.
+     */
+    bool IsCodeInlined() const { return codeInlined; };
+    void EnableCodeInlining(bool enable) { codeInlined = enable; };
+
+    /**
+     * \brief Return true if the code can be inserted directly into the events generated code.
+     *
+     * This is the case if inlining is enabled and if the code does not use statements
+     * which are only valid inside a function ( "return", "this" or "arguments" ), does not
+     * declare variables or functions ( which would be visible in the whole events function )
+     * and does not use the names of the variables of the events function ( "runtimeScene",
+     * "context" and the loops counters ).
+     * Code containing regular expressions, divisions or template literals is never inlined.
+     */
+    bool CanBeInlined() const;
+
+    /**
+     * \brief Return the code of the event, with the parameters renamed so that they are
+     * not shared with the other events inlined in the same events function.
+     *
+     * \param sceneName The name of the variable containing the scene passed as parameter.
+     * \param objectsListName The name of the variable containing the objects passed as parameter.
+     */
+    std::string GetInlinedCode(const std::string & sceneName, const std::string & objectsListName) const;
+
+    /**
+     * \brief Generate the Javascript code declaring the function containing the code of the event.
+     * \note The function is named after GetFunctionToCall().
+     */
+    std::string GenerateAssociatedFileCode() const;
+
     bool IsCodeDisplayedInEditor() const { return codeDisplayedInEditor; };
     void EnableCodeDisplayedInEditor(bool enable) { codeDisplayedInEditor = enable; eventHeightNeedUpdate = true; };
 
@@ -80,7 +114,6 @@ public:
 
 private:
     void Init(const JsCodeEvent & event);
-    std::string GenerateAssociatedFileCode() const;
     void AutogenerateFunctionName() const;
 
     std::vector<std::string> includeFiles;
@@ -93,6 +126,7 @@ private:
     bool passObjectListAsParameter;
     std::string objectToPassAsParameter;
 
+    bool codeInlined; ///< If true, the code is generated inside the events code (when possible, see CanBeInlined).
     bool codeDisplayedInEditor;
     std::string displayedName;
 
@@ -0,0 +1,554 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include "GDJS/JsMinifier.h"
+
+namespace gdjs
+{
+
+namespace
+{
+    bool IsIdentifierChar(unsigned char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            c == '_' || c == '$' || c == '\\' || c >= 0x80;
+    }
+
+    bool IsDigit(unsigned char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    /**
+     * \brief Keywords, reserved words and names that must never be used as new names.
+     */
+    const char * reservedWords[] = {"break", "case", "catch", "class", "const", "continue", "debugger",
+        "default", "delete", "do", "else", "enum", "export", "extends", "false", "finally", "for", "function",
+        "if", "implements", "import", "in", "instanceof", "interface", "let", "new", "null", "package",
+        "private", "protected", "public", "return", "static", "super", "switch", "this", "throw", "true",
+        "try", "typeof", "var", "void", "while", "with", "yield", "undefined", "NaN", "Infinity", "arguments",
+        "eval", "abstract", "boolean", "byte", "char", "double", "final", "float", "goto", "int", "long",
+        "native", "short", "synchronized", "throws", "transient", "volatile", NULL};
+
+    bool IsReservedWord(const std::string & name)
+    {
+        for (unsigned int i = 0;reservedWords[i] != NULL;++i)
+            if ( name == reservedWords[i] ) return true;
+
+        return false;
+    }
+
+    /**
+     * \brief Keywords after which an expression is expected.
+     */
+    const char * operatorKeywords[] = {"return", "typeof", "instanceof", "in", "new", "delete", "void",
+        "throw", "case", "do", "else", NULL};
+
+    /**
+     * \brief Punctuators, sorted by decreasing length so that the longest one is always matched.
+     */
+    const char * punctuators[] = {">>>=", "===", "!==", "<<=", ">>=", ">>>", "<=", ">=", "==", "!=",
+        "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "&&", "||", "++", "--", "<<", ">>", NULL};
+}
+
+const unsigned int JsMinifier::version = 1;
+
+JsMinifier::JsMinifier() :
+    source(NULL),
+    nextNameCandidate(0),
+    renameLocals(true)
+{
+}
+
+std::string JsMinifier::GetSignature() const
+{
+    std::ostringstream signature;
+    signature << "v" << version << (renameLocals ? "r" : "");
+    return signature.str();
+}
+
+bool JsMinifier::Is(size_t i, const char * text) const
+{
+    if ( i >= tokens.size() ) return false;
+
+    const Token & token = tokens[i];
+    return token.length == strlen(text) && source->compare(token.start, token.length, text) == 0;
+}
+
+bool JsMinifier::Minify(const std::string & source_, std::string & output)
+{
+    source = &source_;
+    tokens.clear();
+    preservedComments.clear();
+    scopes.clear();
+    tokensScope.clear();
+    tokensNewName.clear();
+    usedNames.clear();
+    newNames.clear();
+    nextNameCandidate = 0;
+    lastError.clear();
+
+    if ( !Tokenize() ) return false;
+
+    tokensNewName.assign(tokens.size(), NULL);
+    if ( renameLocals )
+    {
+        AnalyzeScopes();
+        RenameLocals();
+    }
+
+    WriteOutput(output);
+    return true;
+}
+
+bool JsMinifier::IsRegexAllowed(bool lastClosedBraceIsBlock) const
+{
+    if ( tokens.empty() ) return true;
+
+    size_t last = tokens.size()-1;
+    const Token & token = tokens[last];
+    if ( token.type == Number || token.type == String || token.type == Regex ) return false;
+    if ( token.type == Identifier )
+    {
+        for (unsigned int i = 0;operatorKeywords[i] != NULL;++i)
+            if ( Is(last, operatorKeywords[i]) ) return true;
+
+        return false;
+    }
+
+    if ( Is(last, ")") || Is(last, "]") || Is(last, "++") || Is(last, "--") ) return false;
+    if ( Is(last, "}") ) return lastClosedBraceIsBlock;
+    return true;
+}
+
+bool JsMinifier::IsObjectLiteralBrace() const
+{
+    if ( tokens.empty() ) return false;
+
+    size_t last = tokens.size()-1;
+    if ( tokens[last].type == Identifier )
+    {
+        for (unsigned int i = 0;operatorKeywords[i] != NULL;++i)
+            if ( Is(last, operatorKeywords[i]) ) return !Is(last, "do") && !Is(last, "else");
+
+        return false;
+    }
+    if ( tokens[last].type != Punctuator ) return false;
+
+    return !Is(last, ")") && !Is(last, ";") && !Is(last, "{") && !Is(last, "}");
+}
+
+bool JsMinifier::Tokenize()
+{
+    const std::string & s = *source;
+    size_t n = s.size();
+    size_t i = 0;
+    bool newline = false;
+    std::vector<bool> bracesAreBlocks;
+    bool lastClosedBraceIsBlock = true;
+
+    while ( i < n )
+    {
+        unsigned char c = s[i];
+
+        //Whitespaces and line terminators ( including the UTF-8 BOM, non breaking spaces and U+2028/U+2029 ).
+        if ( c == '\n' || c == '\r' ) { newline = true; ++i; continue; }
+        if ( c == ' ' || c == '\t' || c == '\v' || c == '\f' ) { ++i; continue; }
+        if ( c == 0xEF && i+2 < n && (unsigned char)s[i+1] == 0xBB && (unsigned char)s[i+2] == 0xBF ) { i += 3; continue; }
+        if ( c == 0xC2 && i+1 < n && (unsigned char)s[i+1] == 0xA0 ) { i += 2; continue; }
+        if ( c == 0xE2 && i+2 < n && (unsigned char)s[i+1] == 0x80 &&
+            ((unsigned char)s[i+2] == 0xA8 || (unsigned char)s[i+2] == 0xA9) ) { newline = true; i += 3; continue; }
+
+        //Comments
+        if ( c == '/' && i+1 < n && s[i+1] == '/' )
+        {
+            while ( i < n && s[i] != '\n' && s[i] != '\r' ) ++i;
+            continue;
+        }
+        if ( c == '/' && i+1 < n && s[i+1] == '*' )
+        {
+            size_t end = s.find("*/", i+2);
+            if ( end == std::string::npos )
+            {
+                lastError = "Unterminated comment";
+                return false;
+            }
+
+            std::string comment = s.substr(i, end+2-i);
+            if ( comment.find_first_of("\n\r") != std::string::npos ) newline = true;
+            if ( (comment.size() > 2 && comment[2] == '!') || comment.find("@license") != std::string::npos ||
+                comment.find("@preserve") != std::string::npos )
+                preservedComments.push_back(std::make_pair(tokens.size(), comment));
+
+            i = end+2;
+            continue;
+        }
+
+        Token token;
+        token.start = i;
+        token.newlineBefore = newline;
+        newline = false;
+
+        if ( IsIdentifierChar(c) && !IsDigit(c) )
+        {
+            token.type = Identifier;
+            while ( i < n && IsIdentifierChar(s[i]) ) ++i;
+        }
+        else if ( IsDigit(c) || (c == '.' && i+1 < n && IsDigit(s[i+1])) )
+        {
+            token.type = Number;
+            if ( c == '0' && i+1 < n && (s[i+1] == 'x' || s[i+1] == 'X') ) i += 2;
+            while ( i < n )
+            {
+                //Exponents can have a sign ( but not hexadecimal numbers, which can't have an exponent ).
+                if ( (s[i] == '+' || s[i] == '-') && (s[i-1] == 'e' || s[i-1] == 'E') &&
+                    !(s[token.start] == '0' && i > token.start+1 && (s[token.start+1] == 'x' || s[token.start+1] == 'X')) )
+                    ++i;
+                else if ( IsIdentifierChar(s[i]) || s[i] == '.' )
+                    ++i;
+                else
+                    break;
+            }
+        }
+        else if ( c == '"' || c == '\'' )
+        {
+            token.type = String;
+            ++i;
+            while ( true )
+            {
+                if ( i >= n || s[i] == '\n' || s[i] == '\r' )
+                {
+                    lastError = "Unterminated string";
+                    return false;
+                }
+                if ( s[i] == '\\' ) i += 2;
+                else if ( (unsigned char)s[i] == c ) { ++i; break; }
+                else ++i;
+            }
+        }
+        else if ( c == '/' && IsRegexAllowed(lastClosedBraceIsBlock) )
+        {
+            token.type = Regex;
+            ++i;
+            bool inClass = false;
+            while ( true )
+            {
+                if ( i >= n || s[i] == '\n' || s[i] == '\r' )
+                {
+                    lastError = "Unterminated regular expression";
+                    return false;
+                }
+                if ( s[i] == '\\' ) { i += 2; continue; }
+
+                char regexChar = s[i++];
+                if ( regexChar == '[' ) inClass = true;
+                else if ( regexChar == ']' ) inClass = false;
+                else if ( regexChar == '/' && !inClass ) break;
+            }
+            while ( i < n && IsIdentifierChar(s[i]) ) ++i; //Flags
+        }
+        else
+        {
+            token.type = Punctuator;
+            size_t length = 1;
+            for (unsigned int p = 0;punctuators[p] != NULL;++p)
+            {
+                size_t punctuatorLength = strlen(punctuators[p]);
+                if ( s.compare(i, punctuatorLength, punctuators[p]) == 0 )
+                {
+                    length = punctuatorLength;
+                    break;
+                }
+            }
+
+            if ( c == '{' )
+                bracesAreBlocks.push_back(!IsObjectLiteralBrace());
+            else if ( c == '}' && !bracesAreBlocks.empty() )
+            {
+                lastClosedBraceIsBlock = bracesAreBlocks.back();
+                bracesAreBlocks.pop_back();
+            }
+
+            i += length;
+        }
+
+        token.length = std::min(i, n)-token.start;
+        tokens.push_back(token);
+    }
+
+    return true;
+}
+
+void JsMinifier::Declare(int scope, const std::string & name)
+{
+    if ( name == "arguments" || IsReservedWord(name) ) return;
+
+    Scope & declaringScope = scopes[scope];
+    if ( declaringScope.declaredSet.insert(name).second )
+        declaringScope.declared.push_back(name);
+}
+
+bool JsMinifier::IsReference(size_t i) const
+{
+    if ( tokens[i].type != Identifier || IsReservedWord(GetText(i)) ) return false;
+    if ( i == 0 ) return !Is(i+1, ":");
+
+    //Properties
+    if ( Is(i-1, ".") ) return false;
+
+    //Object literal keys and labels
+    if ( Is(i+1, ":") && (Is(i-1, "{") || Is(i-1, ",") || Is(i-1, ";") || Is(i-1, "}")) ) return false;
+
+    //Getters and setters in object literals
+    if ( (Is(i-1, "{") || Is(i-1, ",")) && (Is(i, "get") || Is(i, "set")) &&
+        i+1 < tokens.size() && tokens[i+1].type == Identifier )
+        return false;
+    if ( i >= 2 && (Is(i-1, "get") || Is(i-1, "set")) && (Is(i-2, "{") || Is(i-2, ",")) && Is(i+1, "(") )
+        return false;
+
+    //Labels used by break and continue
+    if ( (Is(i-1, "break") || Is(i-1, "continue")) && !tokens[i].newlineBefore ) return false;
+
+    return true;
+}
+
+void JsMinifier::AnalyzeScopes()
+{
+    scopes.push_back(Scope(-1));
+    scopes[0].unsafe = true; //Global names are never renamed.
+    tokensScope.assign(tokens.size(), 0);
+
+    std::vector<int> scopesStack(1, 0);
+    unsigned int depth = 0;
+    int functionWaitingForBody = -1;
+
+    for (size_t i = 0;i<tokens.size();++i)
+    {
+        int currentScope = scopesStack.back();
+        if ( tokensScope[i] == 0 ) tokensScope[i] = currentScope;
+
+        const Token & token = tokens[i];
+        if ( token.type == Identifier )
+        {
+            if ( i > 0 && Is(i-1, ".") ) continue;
+
+            if ( Is(i, "function") )
+            {
+                int functionScope = scopes.size();
+                scopes.push_back(Scope(currentScope));
+
+                size_t j = i+1;
+                if ( j < tokens.size() && tokens[j].type == Identifier )
+                {
+                    //The name of a function declaration belongs to the enclosing function,
+                    //the name of a function expression only exists inside the function.
+                    bool declaration = i == 0 || Is(i-1, ";") || Is(i-1, "{") || Is(i-1, "}") || Is(i-1, ")");
+                    Declare(declaration ? currentScope : functionScope, GetText(j));
+                    tokensScope[j] = declaration ? currentScope : functionScope;
+                    ++j;
+                }
+                if ( !Is(j, "(") ) continue;
+
+                for (++j;j<tokens.size() && !Is(j, ")");++j)
+                {
+                    tokensScope[j] = functionScope;
+                    if ( tokens[j].type == Identifier ) Declare(functionScope, GetText(j));
+                }
+
+                if ( !Is(j+1, "{") ) continue;
+                functionWaitingForBody = functionScope;
+                i = j; //Continue with the body of the function.
+            }
+            else if ( Is(i, "var") )
+            {
+                //Declare the names of the var statement: the first name and the names following
+                //the commas which are not nested in an expression.
+                if ( Is(i+1, "(") ) continue;
+                if ( i+1 < tokens.size() && tokens[i+1].type == Identifier ) Declare(currentScope, GetText(i+1));
+
+                int nesting = 0;
+                for (size_t j = i+2;j<tokens.size();++j)
+                {
+                    if ( Is(j, "(") || Is(j, "[") || Is(j, "{") ) ++nesting;
+                    else if ( Is(j, ")") || Is(j, "]") || Is(j, "}") )
+                    {
+                        if ( nesting == 0 ) break;
+                        --nesting;
+                    }
+                    else if ( nesting == 0 )
+                    {
+                        if ( Is(j, ";") || Is(j, "in") ) break;
+
+                        //Automatic semicolon insertion: the statement is finished.
+                        if ( tokens[j].newlineBefore && tokens[j].type == Identifier && !Is(j, "instanceof") &&
+                            (tokens[j-1].type != Punctuator || Is(j-1, ")") || Is(j-1, "]") || Is(j-1, "}")) )
+                            break;
+
+                        if ( Is(j, ",") && j+1 < tokens.size() && tokens[j+1].type == Identifier )
+                            Declare(currentScope, GetText(j+1));
+                    }
+                }
+            }
+            else if ( Is(i, "catch") && Is(i+1, "(") && Is(i+3, ")") )
+            {
+                //The name of the exception is only declared in the catch block: it is simpler to never rename it.
+                std::string name = GetText(i+2);
+                for (int scope = currentScope;scope != -1;scope = scopes[scope].parent)
+                    scopes[scope].excluded.insert(name);
+            }
+            else if ( Is(i, "eval") || Is(i, "with") || Is(i, "let") || Is(i, "const") )
+            {
+                //eval and with can access to any variable of the enclosing functions. let and const
+                //are block scoped and not supported.
+                for (int scope = currentScope;scope != -1;scope = scopes[scope].parent)
+                    scopes[scope].unsafe = true;
+            }
+        }
+        else if ( token.type == Punctuator )
+        {
+            if ( Is(i, "{") || Is(i, "(") || Is(i, "[") )
+            {
+                if ( Is(i, "{") && functionWaitingForBody != -1 )
+                {
+                    scopes[functionWaitingForBody].bodyDepth = depth;
+                    scopesStack.push_back(functionWaitingForBody);
+                    functionWaitingForBody = -1;
+                }
+                ++depth;
+            }
+            else if ( Is(i, "}") || Is(i, ")") || Is(i, "]") )
+            {
+                if ( depth > 0 ) --depth;
+                if ( Is(i, "}") && scopesStack.size() > 1 && scopes[scopesStack.back()].bodyDepth == depth )
+                    scopesStack.pop_back();
+            }
+        }
+    }
+}
+
+const std::string & JsMinifier::GetNewName(size_t index)
+{
+    static const char firstChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_$";
+    static const char otherChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_$0123456789";
+    const size_t firstCharsCount = sizeof(firstChars)-1;
+    const size_t otherCharsCount = sizeof(otherChars)-1;
+
+    while ( newNames.size() <= index )
+    {
+        size_t candidate = nextNameCandidate++;
+        std::string name(1, firstChars[candidate % firstCharsCount]);
+        candidate /= firstCharsCount;
+        while ( candidate > 0 )
+        {
+            --candidate;
+            name += otherChars[candidate % otherCharsCount];
+            candidate /= otherCharsCount;
+        }
+
+        if ( !IsReservedWord(name) && usedNames.find(name) == usedNames.end() )
+            newNames.push_back(name);
+    }
+
+    return newNames[index];
+}
+
+void JsMinifier::RenameLocals()
+{
+    //Find the scope declaring each name, and the names which are kept as is: they can't be used as new names.
+    std::vector<int> tokensDeclaringScope(tokens.size(), -1);
+    for (size_t i = 0;i<tokens.size();++i)
+    {
+        if ( !IsReference(i) ) continue;
+
+        std::string name = GetText(i);
+        for (int s = tokensScope[i];s != -1;s = scopes[s].parent)
+        {
+            const Scope & scope = scopes[s];
+            if ( scope.declaredSet.find(name) == scope.declaredSet.end() ) continue;
+
+            if ( !scope.unsafe && scope.excluded.find(name) == scope.excluded.end() ) tokensDeclaringScope[i] = s;
+            break;
+        }
+
+        if ( tokensDeclaringScope[i] == -1 ) usedNames.insert(name);
+    }
+
+    //Scopes are created before the scopes they contain: the new names of a scope are chosen after the ones of
+    //its enclosing scopes, so that they never hide them. Sibling scopes can use the same names.
+    for (size_t s = 1;s<scopes.size();++s)
+    {
+        Scope & scope = scopes[s];
+        const Scope & parent = scopes[scope.parent];
+        scope.firstNameIndex = parent.firstNameIndex+parent.renamed.size();
+        if ( scope.unsafe ) continue;
+
+        for (size_t i = 0;i<scope.declared.size();++i)
+        {
+            if ( scope.excluded.find(scope.declared[i]) != scope.excluded.end() ) continue;
+            scope.renamed[scope.declared[i]] = GetNewName(scope.firstNameIndex+scope.renamed.size());
+        }
+    }
+
+    for (size_t i = 0;i<tokens.size();++i)
+    {
+        if ( tokensDeclaringScope[i] != -1 )
+            tokensNewName[i] = &scopes[tokensDeclaringScope[i]].renamed[GetText(i)];
+    }
+}
+
+void JsMinifier::WriteOutput(std::string & output)
+{
+    output.clear();
+    output.reserve(source->size()/2);
+
+    size_t nextComment = 0;
+    for (size_t i = 0;i<tokens.size();++i)
+    {
+        const Token & token = tokens[i];
+        for (;nextComment < preservedComments.size() && preservedComments[nextComment].first == i;++nextComment)
+        {
+            if ( !output.empty() && output[output.size()-1] == '/' ) output += ' ';
+            output += preservedComments[nextComment].second;
+        }
+
+        const char * text = tokensNewName[i] ? tokensNewName[i]->c_str() : source->c_str()+token.start;
+        size_t length = tokensNewName[i] ? tokensNewName[i]->size() : token.length;
+
+        if ( i > 0 && !output.empty() )
+        {
+            const Token & previous = tokens[i-1];
+            unsigned char last = output[output.size()-1];
+            unsigned char first = text[0];
+
+            //Keep the line breaks which can end a statement.
+            bool previousEndsExpression = previous.type != Punctuator ||
+                Is(i-1, ")") || Is(i-1, "]") || Is(i-1, "}") || Is(i-1, "++") || Is(i-1, "--");
+            bool beginsExpression = token.type != Punctuator ||
+                Is(i, "(") || Is(i, "[") || Is(i, "{") || Is(i, "+") || Is(i, "-") ||
+                Is(i, "++") || Is(i, "--") || Is(i, "!") || Is(i, "~");
+
+            if ( token.newlineBefore && previousEndsExpression && beginsExpression )
+                output += '\n';
+            else if ( (IsIdentifierChar(last) && IsIdentifierChar(first)) ||
+                ((last == '+' || last == '-') && first == last) ||
+                (last == '/' && (first == '/' || first == '*')) ||
+                (last == '<' && first == '!') || (last == '-' && first == '>') ||
+                (token.type == Number && first == '.' && (IsIdentifierChar(last) || last == '.')) ||
+                (previous.type == Number && first == '.' &&
+                    GetText(i-1).find_first_not_of("0123456789") == std::string::npos) )
+                output += ' ';
+        }
+
+        output.append(text, length);
+    }
+
+    for (;nextComment < preservedComments.size();++nextComment)
+        output += preservedComments[nextComment].second;
+}
+
+}
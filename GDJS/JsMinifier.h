@@ -0,0 +1,123 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef JSMINIFIER_H
+#define JSMINIFIER_H
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+namespace gdjs
+{
+
+/**
+ * \brief Minify JavaScript code, without requiring any external tool.
+ *
+ * Whitespaces and comments are removed ( except block comments starting with ! or containing
+ * \@license or \@preserve ) and line breaks are only kept where they can change the meaning
+ * of the code ( automatic semicolon insertion ).<br>
+ * The variables, parameters and functions declared inside functions are renamed with
+ * shorter names, unless the function ( or a function declared inside it ) uses eval, with,
+ * let or const. Global names and properties are never renamed.
+ *
+ * The compression is not as good as the one of Google Closure Compiler, but it is
+ * much faster and works on files of any size.
+ */
+class JsMinifier
+{
+public:
+    static const unsigned int version; ///< Must be increased each time the output of the minifier changes.
+
+    JsMinifier();
+    virtual ~JsMinifier() {};
+
+    /**
+     * \brief Minify the source code.
+     * \param source The code to be minified.
+     * \param output The string where the minified code is stored.
+     * \return true if the code was minified, false if the code could not be parsed ( see GetLastError ).
+     */
+    bool Minify(const std::string & source, std::string & output);
+
+    /**
+     * \brief Enable or disable the renaming of the local variables ( enabled by default ).
+     */
+    void SetLocalsRenamed(bool enable = true) { renameLocals = enable; };
+
+    /**
+     * \brief Return a string identifying the version of the minifier and its options: the same code minified
+     * by minifiers with the same signature gives the same output. Used to name the cached minified files.
+     */
+    std::string GetSignature() const;
+
+    /**
+     * \brief Return the error that occurred during the last minification.
+     */
+    const std::string & GetLastError() const { return lastError; };
+
+private:
+    enum TokenType
+    {
+        Identifier, ///< Identifiers and keywords.
+        Number,
+        String,
+        Regex,
+        Punctuator
+    };
+
+    struct Token
+    {
+        size_t start;
+        size_t length;
+        TokenType type;
+        bool newlineBefore; ///< True if there was a line break between the previous token and this one.
+    };
+
+    /**
+     * \brief A function, with the names declared inside it.
+     */
+    struct Scope
+    {
+        Scope(int parent_) : parent(parent_), unsafe(false), firstNameIndex(0), bodyDepth(0) {};
+
+        int parent; ///< The index of the enclosing scope, or -1 for the global scope.
+        bool unsafe; ///< True if the names of the scope must not be renamed.
+        std::vector<std::string> declared; ///< The names declared in the scope, in the order of their declarations.
+        std::set<std::string> declaredSet;
+        std::set<std::string> excluded; ///< Names declared in the scope which must not be renamed.
+        std::map<std::string, std::string> renamed; ///< The new names of the names declared in the scope.
+        size_t firstNameIndex; ///< The index of the first new name that can be used by the scope.
+        unsigned int bodyDepth; ///< The nesting depth of the braces of the body of the function.
+    };
+
+    bool Tokenize();
+    bool IsRegexAllowed(bool lastClosedBraceIsBlock) const;
+    bool IsObjectLiteralBrace() const;
+    void AnalyzeScopes();
+    void Declare(int scope, const std::string & name);
+    void RenameLocals();
+    bool IsReference(size_t i) const;
+    const std::string & GetNewName(size_t index);
+    void WriteOutput(std::string & output);
+
+    std::string GetText(size_t i) const { return source->substr(tokens[i].start, tokens[i].length); };
+    bool Is(size_t i, const char * text) const;
+
+    const std::string * source; ///< The code being minified.
+    std::vector<Token> tokens;
+    std::vector< std::pair<size_t, std::string> > preservedComments; ///< Comments kept, with the index of the token following them.
+    std::vector<Scope> scopes;
+    std::vector<int> tokensScope; ///< For each token, the index of the scope where it is.
+    std::vector<const std::string*> tokensNewName; ///< For each token, its new name or NULL.
+    std::set<std::string> usedNames; ///< The identifiers used in the code, that can't be used as new names.
+    std::vector<std::string> newNames; ///< The new names generated so far.
+    size_t nextNameCandidate;
+    bool renameLocals;
+    std::string lastError;
+};
+
+}
+#endif // JSMINIFIER_H
@@ -58,6 +58,8 @@ JsPlatform *JsPlatform::singleton = NULL;
 class Previewer : public gd::LayoutEditorPreviewer
 {
 public:
+    static const unsigned int previewWhileIterationsLimit = 100000; ///< While events never ending are stopped in previews, rather than freezing the browser.
+
     Previewer(gd::Project & project_, gd::Layout & layout_) :
         project(project_),
         layout(layout_)
@@ -68,7 +70,10 @@ public:
     {
         std::string exportDir = gd::ToString(wxFileName::GetTempDir()+"/GDTemporaries/JSPreview/");
 
+        //The files of the preview have hashed filenames, so that browsers only download the files which changed.
         Exporter exporter(gd::NativeFileSystem::Get());
+        exporter.SetHashedFilenamesUsed();
+        exporter.SetWhileIterationsLimit(previewWhileIterationsLimit);
         if ( !exporter.ExportLayoutForPreview(project, layout, exportDir) )
         {
             gd::LogError(_("An error occurred when launching the preview:\n\n")+exporter.GetLastError()
@@ -76,7 +81,7 @@ public:
         }
 
         //Without "http://", the function fails ( on Windows at least ).
-        //The timestamp is here to prevent browsers caching contents.
+        //The timestamp is here to prevent browsers caching the index file.
         if ( !wxLaunchDefaultBrowser("http://localhost:2828?"+gd::ToString(wxGetLocalTime())) )
         {
             gd::LogError(_("Unable to launch your browser :(\nOpen manually your browser and type \"localhost:2828\" in\nthe address bar ( without the quotes ) to launch the preview!"));
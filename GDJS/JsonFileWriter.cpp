@@ -0,0 +1,168 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <cstring>
+#include <map>
+#include "GDCore/Serialization/SerializerElement.h"
+#include "GDCore/Serialization/SerializerValue.h"
+#include "GDCore/CommonTools.h"
+#include "GDJS/JsonFileWriter.h"
+
+namespace gdjs
+{
+
+JsonFileWriter::JsonFileWriter(size_t bufferSize) :
+    file(NULL),
+    buffer(bufferSize > 0 ? bufferSize : 1),
+    bufferUsed(0),
+    error(false)
+{
+}
+
+JsonFileWriter::~JsonFileWriter()
+{
+    if ( file ) Close();
+}
+
+bool JsonFileWriter::Open(const std::string & filename)
+{
+    if ( file ) Close();
+
+    file = fopen(filename.c_str(), "wb");
+    bufferUsed = 0;
+    error = file == NULL;
+    return file != NULL;
+}
+
+bool JsonFileWriter::Close()
+{
+    if ( !file ) return false;
+
+    Flush();
+    if ( fclose(file) != 0 ) error = true;
+    file = NULL;
+
+    return !error;
+}
+
+void JsonFileWriter::Flush()
+{
+    if ( bufferUsed == 0 || !file ) return;
+
+    if ( fwrite(&buffer[0], 1, bufferUsed, file) != bufferUsed ) error = true;
+    bufferUsed = 0;
+}
+
+void JsonFileWriter::Write(const char * data, size_t size)
+{
+    if ( bufferUsed+size > buffer.size() )
+    {
+        Flush();
+        if ( size > buffer.size() ) //Too big for the buffer: written directly.
+        {
+            if ( file && fwrite(data, 1, size, file) != size ) error = true;
+            return;
+        }
+    }
+
+    memcpy(&buffer[bufferUsed], data, size);
+    bufferUsed += size;
+}
+
+void JsonFileWriter::WriteJSONString(const std::string & str)
+{
+    Write("\"", 1);
+
+    //Characters not needing to be escaped are written in runs, to avoid writing them one by one.
+    size_t runStart = 0;
+    for (size_t i = 0;i<str.size();++i)
+    {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if ( c >= 0x20 && c != '"' && c != '\\' ) continue;
+
+        Write(str.c_str()+runStart, i-runStart);
+        runStart = i+1;
+
+        switch ( c )
+        {
+            case '"': Write("\\\"", 2); break;
+            case '\\': Write("\\\\", 2); break;
+            case '\b': Write("\\b", 2); break;
+            case '\f': Write("\\f", 2); break;
+            case '\n': Write("\\n", 2); break;
+            case '\r': Write("\\r", 2); break;
+            case '\t': Write("\\t", 2); break;
+            default:
+            {
+                char escaped[7];
+                sprintf(escaped, "\\u%04x", c);
+                Write(escaped, 6);
+            }
+        }
+    }
+    Write(str.c_str()+runStart, str.size()-runStart);
+
+    Write("\"", 1);
+}
+
+void JsonFileWriter::WriteJSONValue(const gd::SerializerValue & value)
+{
+    if ( value.IsBoolean() ) Write(value.GetBool() ? "true" : "false");
+    else if ( value.IsInt() ) Write(gd::ToString(value.GetInt()));
+    else if ( value.IsDouble() ) Write(gd::ToString(value.GetDouble()));
+    else WriteJSONString(value.GetString());
+}
+
+void JsonFileWriter::WriteJSON(const gd::SerializerElement & element)
+{
+    if ( !element.IsValueUndefined() )
+    {
+        WriteJSONValue(element.GetValue());
+        return;
+    }
+
+    const std::vector< std::pair<std::string, boost::shared_ptr<gd::SerializerElement> > > & children = element.GetAllChildren();
+    if ( element.ConsideredAsArray() )
+    {
+        Write("[", 1);
+        bool firstChild = true;
+        for (size_t i = 0;i<children.size();++i)
+        {
+            if ( !children[i].second ) continue;
+
+            if ( !firstChild ) Write(",", 1);
+            WriteJSON(*children[i].second);
+            firstChild = false;
+        }
+        Write("]", 1);
+    }
+    else
+    {
+        Write("{", 1);
+        bool firstChild = true;
+        const std::map<std::string, gd::SerializerValue> & attributes = element.GetAllAttributes();
+        for (std::map<std::string, gd::SerializerValue>::const_iterator it = attributes.begin();it != attributes.end();++it)
+        {
+            if ( !firstChild ) Write(",", 1);
+            WriteJSONString(it->first);
+            Write(": ", 2);
+            WriteJSONValue(it->second);
+            firstChild = false;
+        }
+        for (size_t i = 0;i<children.size();++i)
+        {
+            if ( !children[i].second ) continue;
+
+            if ( !firstChild ) Write(",", 1);
+            WriteJSONString(children[i].first);
+            Write(": ", 2);
+            WriteJSON(*children[i].second);
+            firstChild = false;
+        }
+        Write("}", 1);
+    }
+}
+
+}
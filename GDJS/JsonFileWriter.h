@@ -0,0 +1,86 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef JSONFILEWRITER_H
+#define JSONFILEWRITER_H
+#include <string>
+#include <cstdio>
+#include <vector>
+namespace gd { class SerializerElement; }
+namespace gd { class SerializerValue; }
+
+namespace gdjs
+{
+
+/**
+ * \brief Write a gd::SerializerElement as JSON directly into a file, without building
+ * the whole JSON string in memory ( unlike gd::Serializer::ToJSON ).
+ *
+ * The JSON is written through a buffer, flushed to the file when full. Usage example:
+ * \code
+ * JsonFileWriter writer;
+ * if ( !writer.Open(filename) ) return false;
+ * writer.Write("gdjs.projectData = ");
+ * writer.WriteJSON(rootElement);
+ * writer.Write(";");
+ * return writer.Close();
+ * \endcode
+ */
+class JsonFileWriter
+{
+public:
+    /**
+     * \brief Create a writer.
+     * \param bufferSize The size of the buffer, in bytes.
+     */
+    JsonFileWriter(size_t bufferSize = 256*1024);
+    virtual ~JsonFileWriter();
+
+    /**
+     * \brief Open the file to be written. The file is truncated if it exists.
+     * \return true if the file was opened.
+     */
+    bool Open(const std::string & filename);
+
+    /**
+     * \brief Write the remaining content of the buffer and close the file.
+     * \return true if the whole content was written.
+     */
+    bool Close();
+
+    /**
+     * \brief Write a raw string.
+     */
+    void Write(const std::string & str) { Write(str.c_str(), str.size()); };
+
+    /**
+     * \brief Write raw data.
+     */
+    void Write(const char * data, size_t size);
+
+    /**
+     * \brief Write the element, and all its children, in JSON.
+     * The JSON written is byte for byte the same as the one returned by gd::Serializer::ToJSON
+     * ( this is checked by the JsonFileWriter test of gdjs-tests: keep both in sync ).
+     */
+    void WriteJSON(const gd::SerializerElement & element);
+
+    /**
+     * \brief Write the string as a JSON string ( i.e: quoted and escaped ).
+     */
+    void WriteJSONString(const std::string & str);
+
+private:
+    void WriteJSONValue(const gd::SerializerValue & value);
+    void Flush();
+
+    FILE * file;
+    std::vector<char> buffer;
+    size_t bufferUsed; ///< The number of bytes of the buffer waiting to be written.
+    bool error; ///< True if an error happened while writing the file.
+};
+
+}
+#endif // JSONFILEWRITER_H
@@ -0,0 +1,294 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <algorithm>
+#if !defined(GD_NO_WX_GUI)
+#include <wx/thread.h>
+#elif !defined(EMSCRIPTEN)
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+#endif
+#include "GDCore/IDE/AbstractFileSystem.h"
+#include "GDJS/ParallelFilesCopier.h"
+#include "GDJS/ExportManifest.h"
+#include "GDJS/FastFileCopy.h"
+#undef CopyFile //Disable an annoying macro
+
+namespace gdjs
+{
+
+#if !defined(EMSCRIPTEN)
+/**
+ * \brief The state shared by the workers of a ParallelFilesCopier.
+ */
+struct ParallelFilesCopierJobs
+{
+    ParallelFilesCopierJobs(unsigned int filesCount_) :
+        nextFile(0), filesCount(filesCount_), succeeded(filesCount_, 0) {};
+
+    /**
+     * \brief Get the index of the next file to be copied by a worker.
+     * \return false if there are no more files to copy.
+     */
+    bool TakeNextFile(unsigned int & index);
+
+    /**
+     * \brief Called by a worker after copying the file at \a index.
+     */
+    void SetFileCopied(unsigned int index, bool success);
+
+    /**
+     * \brief Wait until the file copied in \a position is copied, and return its index.
+     */
+    unsigned int WaitFileCopied(unsigned int position);
+
+    unsigned int nextFile; ///< The index of the next file to be copied by a worker.
+    unsigned int filesCount;
+    std::vector<char> succeeded; ///< For each file, 1 if it was copied. Each element is only written by the worker copying the file.
+    std::vector<unsigned int> copiedFiles; ///< The index of the files, in the order they were copied.
+    #if !defined(GD_NO_WX_GUI)
+    wxMutex mutex; ///< Protects nextFile and copiedFiles.
+    wxSemaphore fileCopied; ///< Posted by the workers after each file copied.
+    #else
+    boost::mutex mutex; ///< Protects nextFile and copiedFiles.
+    boost::condition_variable fileCopied; ///< Notified by the workers after each file copied.
+    #endif
+};
+
+/**
+ * \brief A thread copying files of a ParallelFilesCopier until there are no more files to copy.
+ */
+#if !defined(GD_NO_WX_GUI)
+class ParallelFilesCopierWorker : public wxThread
+{
+public:
+    ParallelFilesCopierWorker(ParallelFilesCopier & copier_, ParallelFilesCopierJobs & jobs_) :
+        wxThread(wxTHREAD_JOINABLE), copier(copier_), jobs(jobs_) {};
+    virtual ~ParallelFilesCopierWorker() {};
+
+    /**
+     * \brief Launch the thread.
+     * \return false if the thread could not be launched.
+     */
+    bool Launch() { return Run() == wxTHREAD_NO_ERROR; }
+
+    virtual ExitCode Entry()
+    {
+        CopyFiles();
+        return 0;
+    }
+#else
+class ParallelFilesCopierWorker
+{
+public:
+    ParallelFilesCopierWorker(ParallelFilesCopier & copier_, ParallelFilesCopierJobs & jobs_) :
+        copier(copier_), jobs(jobs_), thread(NULL) {};
+    virtual ~ParallelFilesCopierWorker() { delete thread; };
+
+    /**
+     * \brief Launch the thread.
+     * \return false if the thread could not be launched.
+     */
+    bool Launch()
+    {
+        try
+        {
+            thread = new boost::thread(boost::bind(&ParallelFilesCopierWorker::CopyFiles, this));
+        }
+        catch(boost::thread_resource_error &)
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Wait for the end of the thread.
+     */
+    void Wait() { if ( thread ) thread->join(); }
+#endif
+
+private:
+    void CopyFiles()
+    {
+        unsigned int index = 0;
+        while ( jobs.TakeNextFile(index) )
+            jobs.SetFileCopied(index, copier.CopyFile(index));
+    }
+
+    ParallelFilesCopier & copier;
+    ParallelFilesCopierJobs & jobs;
+    #if defined(GD_NO_WX_GUI)
+    boost::thread * thread;
+    #endif
+};
+
+#if !defined(GD_NO_WX_GUI)
+bool ParallelFilesCopierJobs::TakeNextFile(unsigned int & index)
+{
+    wxMutexLocker lock(mutex);
+    if ( nextFile >= filesCount ) return false;
+
+    index = nextFile++;
+    return true;
+}
+
+void ParallelFilesCopierJobs::SetFileCopied(unsigned int index, bool success)
+{
+    succeeded[index] = success ? 1 : 0;
+    {
+        wxMutexLocker lock(mutex);
+        copiedFiles.push_back(index);
+    }
+    fileCopied.Post();
+}
+
+unsigned int ParallelFilesCopierJobs::WaitFileCopied(unsigned int position)
+{
+    fileCopied.Wait();
+
+    wxMutexLocker lock(mutex);
+    return copiedFiles[position];
+}
+#else
+bool ParallelFilesCopierJobs::TakeNextFile(unsigned int & index)
+{
+    boost::mutex::scoped_lock lock(mutex);
+    if ( nextFile >= filesCount ) return false;
+
+    index = nextFile++;
+    return true;
+}
+
+void ParallelFilesCopierJobs::SetFileCopied(unsigned int index, bool success)
+{
+    succeeded[index] = success ? 1 : 0;
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        copiedFiles.push_back(index);
+    }
+    fileCopied.notify_all();
+}
+
+unsigned int ParallelFilesCopierJobs::WaitFileCopied(unsigned int position)
+{
+    boost::mutex::scoped_lock lock(mutex);
+    while ( copiedFiles.size() <= position )
+        fileCopied.wait(lock);
+
+    return copiedFiles[position];
+}
+#endif
+#endif
+
+ParallelFilesCopier::ParallelFilesCopier(gd::AbstractFileSystem & fs_, unsigned int workersCount_) :
+    fs(fs_),
+    workersCount(std::max(workersCount_, 1u)),
+    manifest(NULL),
+    jobs(NULL)
+{
+}
+
+ParallelFilesCopier::~ParallelFilesCopier()
+{
+    if ( jobs ) Wait();
+}
+
+void ParallelFilesCopier::AddFile(const std::string & source, const std::string & destination)
+{
+    //Directories are created now, as the file system is not necessarily safe to use from several threads for this.
+    std::string path = fs.DirNameFrom(destination);
+    if ( !fs.DirExists(path) ) fs.MkDir(path);
+
+    files.push_back(std::make_pair(source, destination));
+}
+
+bool ParallelFilesCopier::CopyFile(unsigned int index)
+{
+    const std::string & source = files[index].first;
+    const std::string & destination = files[index].second;
+    if ( source == destination ) return true;
+
+    return manifest ? manifest->CopyFile(source, destination) : FastFileCopy::Copy(fs, source, destination);
+}
+
+void ParallelFilesCopier::Start()
+{
+    #if !defined(EMSCRIPTEN)
+    if ( jobs || workersCount <= 1 || files.size() <= 1 ) return;
+
+    jobs = new ParallelFilesCopierJobs(files.size());
+
+    //Launch the workers
+    for (unsigned int i = 0;i<std::min<size_t>(workersCount, files.size());++i)
+    {
+        ParallelFilesCopierWorker * worker = new ParallelFilesCopierWorker(*this, *jobs);
+        if ( worker->Launch() )
+            workers.push_back(worker);
+        else
+            delete worker;
+    }
+
+    if ( workers.empty() ) //The files will be copied by Wait.
+    {
+        delete jobs;
+        jobs = NULL;
+    }
+    #endif
+}
+
+bool ParallelFilesCopier::Wait(ProgressCallback callback)
+{
+    failedFiles.clear();
+    std::vector<char> succeeded(files.size(), 0);
+    bool filesCopied = false;
+
+    #if !defined(EMSCRIPTEN)
+    if ( jobs )
+    {
+        //Report the progress from this thread while the workers are copying the files.
+        for (unsigned int i = 0;i<files.size();++i)
+        {
+            unsigned int index = jobs->WaitFileCopied(i);
+            if ( callback ) callback(i+1, files.size(), files[index].second);
+        }
+
+        for (unsigned int i = 0;i<workers.size();++i)
+        {
+            workers[i]->Wait();
+            delete workers[i];
+        }
+        workers.clear();
+
+        succeeded = jobs->succeeded;
+        filesCopied = true;
+        delete jobs;
+        jobs = NULL;
+    }
+    #endif
+
+    //Copy the files one after the other if threads are not available.
+    if ( !filesCopied )
+    {
+        for (unsigned int i = 0;i<files.size();++i)
+        {
+            succeeded[i] = CopyFile(i) ? 1 : 0;
+            if ( callback ) callback(i+1, files.size(), files[i].second);
+        }
+    }
+
+    //Failures are listed in the order the files were added, whatever the order they were copied.
+    for (unsigned int i = 0;i<files.size();++i)
+    {
+        if ( !succeeded[i] ) failedFiles.push_back(files[i]);
+    }
+
+    return failedFiles.empty();
+}
+
+}
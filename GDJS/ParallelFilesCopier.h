@@ -0,0 +1,125 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef PARALLELFILESCOPIER_H
+#define PARALLELFILESCOPIER_H
+#include <string>
+#include <vector>
+#include <utility>
+#include <boost/function.hpp>
+namespace gd { class AbstractFileSystem; }
+namespace gdjs { class ExportManifest; }
+namespace gdjs { struct ParallelFilesCopierJobs; }
+namespace gdjs { class ParallelFilesCopierWorker; }
+
+namespace gdjs
+{
+
+/**
+ * \brief Copy a list of files using a bounded pool of worker threads.
+ *
+ * Files are copied in parallel to make better use of the disks bandwidth, while the
+ * progress is reported from the calling thread ( so that it can safely update a GUI ).
+ * The threads of wxWidgets are used in the IDE, and boost threads in the builds without wxWidgets.
+ * With Emscripten, the files are copied one after the other.
+ *
+ * Usage example:
+ * \code
+ * ParallelFilesCopier copier(fs);
+ * copier.AddFile(source, destination);
+ * copier.CopyAll(progressCallback);
+ * \endcode
+ *
+ * The copy can also be done in the background while the calling thread does something else:
+ * \code
+ * copier.Start();
+ * //...
+ * copier.Wait(progressCallback);
+ * \endcode
+ */
+class ParallelFilesCopier
+{
+public:
+    /**
+     * \brief Function called after each file copied, with the number of files already copied,
+     * the total number of files and the destination of the last file copied.
+     */
+    typedef boost::function<void (unsigned int, unsigned int, const std::string &)> ProgressCallback;
+
+    /**
+     * \brief Construct a copier using \a fs to copy the files.
+     * \param workersCount The maximum number of files copied at the same time.
+     */
+    ParallelFilesCopier(gd::AbstractFileSystem & fs, unsigned int workersCount = 4);
+
+    /**
+     * \brief Destroy the copier, waiting for the end of the copy if it was started.
+     */
+    virtual ~ParallelFilesCopier();
+
+    /**
+     * \brief Set the manifest to be used to skip the files which are up to date ( can be NULL ).
+     */
+    void SetManifest(ExportManifest * manifest_) { manifest = manifest_; };
+
+    /**
+     * \brief Add a file to be copied. The directory of the destination is created if necessary.
+     */
+    void AddFile(const std::string & source, const std::string & destination);
+
+    /**
+     * \brief Copy all the files added.
+     *
+     * \param callback Optional function called, from the calling thread, after each file copied.
+     * \return true if all the files were successfully copied.
+     */
+    bool CopyAll(ProgressCallback callback = ProgressCallback()) { Start(); return Wait(callback); };
+
+    /**
+     * \brief Start copying the files added, using the worker threads, and return immediately.
+     *
+     * Wait must be called to know when the files are copied. Files must not be added until then.
+     */
+    void Start();
+
+    /**
+     * \brief Wait until all the files are copied. If Start was not called ( or if the worker threads could
+     * not be launched ), the files are copied by the calling thread.
+     *
+     * \param callback Optional function called, from the calling thread, after each file copied.
+     * \return true if all the files were successfully copied.
+     */
+    bool Wait(ProgressCallback callback = ProgressCallback());
+
+    /**
+     * \brief Return the files ( source and destination ) added to the copier.
+     */
+    const std::vector< std::pair<std::string, std::string> > & GetFiles() const { return files; };
+
+    /**
+     * \brief Return the files ( source and destination ) that could not be copied by CopyAll.
+     */
+    const std::vector< std::pair<std::string, std::string> > & GetFailedFiles() const { return failedFiles; };
+
+private:
+    friend class ParallelFilesCopierWorker;
+
+    /**
+     * \brief Copy the file at the specified index of the files to copy.
+     * \return true if the copy succeeded.
+     */
+    bool CopyFile(unsigned int index);
+
+    gd::AbstractFileSystem & fs;
+    unsigned int workersCount;
+    ExportManifest * manifest; ///< Optional manifest used to skip up to date files.
+    std::vector< std::pair<std::string, std::string> > files; ///< The source and destination of each file to copy.
+    std::vector< std::pair<std::string, std::string> > failedFiles; ///< The files that could not be copied.
+    ParallelFilesCopierJobs * jobs; ///< The state shared with the workers, if the copy was started ( NULL otherwise ).
+    std::vector<ParallelFilesCopierWorker*> workers; ///< The workers launched by Start.
+};
+
+}
+#endif // PARALLELFILESCOPIER_H
@@ -0,0 +1,148 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include "GDCore/IDE/AbstractFileSystem.h"
+#include "GDJS/PrecacheManifest.h"
+#include "GDJS/ExportManifest.h"
+
+namespace gdjs
+{
+
+const std::string PrecacheManifest::manifestFilename = "precache-manifest.json";
+const std::string PrecacheManifest::serviceWorkerFilename = "service-worker.js";
+
+/**
+ * \brief Return the string quoted and escaped for JSON.
+ */
+static std::string ToJSONString(const std::string & str)
+{
+    std::string result = "\"";
+    for (unsigned int i = 0;i<str.size();++i)
+    {
+        unsigned char c = str[i];
+        if ( c == '"' || c == '\\' ) { result += '\\'; result += c; }
+        else if ( c < 0x20 )
+        {
+            char escaped[8];
+            sprintf(escaped, "\\u%04x", c);
+            result += escaped;
+        }
+        else result += c;
+    }
+
+    return result+"\"";
+}
+
+/**
+ * \brief Return true if the file, at the root of the export directory, must not be cached.
+ */
+static bool IsExcludedFromPrecache(std::string filename)
+{
+    std::transform(filename.begin(), filename.end(), filename.begin(), ::tolower);
+    if ( filename == PrecacheManifest::manifestFilename || filename == PrecacheManifest::serviceWorkerFilename ||
+         filename == ExportManifest::manifestFilename || filename == "index.html" || filename == "gd_metadata.json" )
+        return true;
+
+    //The compressed versions of the files are only used by web servers.
+    size_t dot = filename.find_last_of('.');
+    std::string extension = dot != std::string::npos ? filename.substr(dot) : "";
+    return extension == ".gz" || extension == ".br" || extension == ".zip";
+}
+
+PrecacheManifest::PrecacheManifest(gd::AbstractFileSystem & fs_, const std::string & exportDir_) :
+    fs(fs_),
+    exportDir(exportDir_)
+{
+}
+
+bool PrecacheManifest::AddFile(const std::string & filename)
+{
+    std::string hash = ExportManifest::HashFile(exportDir+"/"+filename);
+    if ( hash.empty() ) return false;
+
+    AddEntry(filename, hash);
+    return true;
+}
+
+void PrecacheManifest::AddFiles(const std::vector<std::string> & filenames)
+{
+    for (unsigned int i = 0;i<filenames.size();++i)
+        AddFile(filenames[i]);
+}
+
+void PrecacheManifest::AddExportDirectoryFiles()
+{
+    std::vector<std::string> dirFiles = fs.ReadDir(exportDir, "");
+    std::sort(dirFiles.begin(), dirFiles.end()); //The version must not depend on the order of the files on the disk.
+    for (unsigned int i = 0;i<dirFiles.size();++i)
+    {
+        std::string filename = dirFiles[i];
+        fs.MakeRelative(filename, exportDir);
+        if ( !IsExcludedFromPrecache(filename) ) AddFile(filename);
+    }
+}
+
+void PrecacheManifest::AddContent(const std::string & filename, const std::string & content)
+{
+    AddEntry(filename, ExportManifest::HashContent(content));
+}
+
+void PrecacheManifest::AddEntry(const std::string & filename, const std::string & hash)
+{
+    //Filenames are used as URLs by the service worker.
+    std::string url = filename;
+    std::replace(url.begin(), url.end(), '\\', '/');
+    if ( !addedFiles.insert(url).second ) return;
+
+    files.push_back(std::make_pair(url, hash));
+}
+
+std::string PrecacheManifest::GetVersion() const
+{
+    std::string allFiles;
+    for (unsigned int i = 0;i<files.size();++i)
+        allFiles += files[i].first+" "+files[i].second+"\n";
+
+    return ExportManifest::HashContent(allFiles);
+}
+
+std::string PrecacheManifest::ToJSON() const
+{
+    std::string json = "{\"version\":"+ToJSONString(GetVersion())+",\"files\":[";
+    for (unsigned int i = 0;i<files.size();++i)
+    {
+        if ( i != 0 ) json += ",";
+        json += "{\"url\":"+ToJSONString(files[i].first)+",\"hash\":"+ToJSONString(files[i].second)+"}";
+    }
+
+    return json+"]}";
+}
+
+std::string PrecacheManifest::GenerateServiceWorker(const std::string & serviceWorkerTemplate) const
+{
+    const std::string placeholder = "{}/*GDJS_PRECACHE_MANIFEST*/";
+    size_t pos = serviceWorkerTemplate.find(placeholder);
+    if ( pos == std::string::npos ) return "";
+
+    std::string serviceWorker = serviceWorkerTemplate;
+    return serviceWorker.replace(pos, placeholder.size(), ToJSON());
+}
+
+std::string PrecacheManifest::GetRegistrationHTML()
+{
+    //Service workers are only available on secure origins: nothing is done on the other ones.
+    return "<script>\n"
+        "    if ( 'serviceWorker' in navigator ) {\n"
+        "        window.addEventListener('load', function() {\n"
+        "            navigator.serviceWorker.register('"+serviceWorkerFilename+"');\n"
+        "        });\n"
+        "    }\n"
+        "    </script>\n";
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef PRECACHEMANIFEST_H
+#define PRECACHEMANIFEST_H
+#include <string>
+#include <vector>
+#include <set>
+namespace gd { class AbstractFileSystem; }
+
+namespace gdjs
+{
+
+/**
+ * \brief The list of the files of an exported game to be stored in the cache of the browsers by
+ * the service worker of the game, so that the game is loaded from the cache, even offline.
+ *
+ * Each file is associated to the hash of its content, and the version of the manifest is the hash
+ * of all the files: it changes as soon as one file changes. The manifest is written in JSON
+ * ( "precache-manifest.json" ) and inserted into the service worker ( "service-worker.js" ).
+ *
+ * Usage example:
+ * \code
+ * PrecacheManifest manifest(fs, exportDir);
+ * manifest.AddFiles(includesFiles);
+ * manifest.AddExportDirectoryFiles();
+ * manifest.AddContent("index.html", indexContent);
+ * fs.WriteToFile(exportDir+"/"+PrecacheManifest::manifestFilename, manifest.ToJSON());
+ * fs.WriteToFile(exportDir+"/"+PrecacheManifest::serviceWorkerFilename, manifest.GenerateServiceWorker(serviceWorkerTemplate));
+ * \endcode
+ *
+ * \see Exporter::SetServiceWorkerGenerated
+ */
+class PrecacheManifest
+{
+public:
+    /**
+     * \brief Create an empty manifest for the export directory.
+     */
+    PrecacheManifest(gd::AbstractFileSystem & fs, const std::string & exportDir);
+    virtual ~PrecacheManifest() {};
+
+    /**
+     * \brief Add a file of the export directory.
+     * \param filename The filename, relative to the export directory.
+     * \return false if the file can't be read ( it is not added ).
+     */
+    bool AddFile(const std::string & filename);
+
+    /**
+     * \brief Add the files of the export directory.
+     * \param filenames The filenames, relative to the export directory.
+     */
+    void AddFiles(const std::vector<std::string> & filenames);
+
+    /**
+     * \brief Add the files at the root of the export directory, except the files which must not be
+     * cached ( the service worker, the manifests, the compressed versions of the files... ).
+     */
+    void AddExportDirectoryFiles();
+
+    /**
+     * \brief Add a file which is not yet written in the export directory.
+     */
+    void AddContent(const std::string & filename, const std::string & content);
+
+    /**
+     * \brief Return the version of the manifest, i.e: the hash of the filenames and of the hashes of all the files.
+     */
+    std::string GetVersion() const;
+
+    /**
+     * \brief Return the manifest in JSON: {"version": "...", "files": [{"url": "...", "hash": "..."}, ...]}
+     */
+    std::string ToJSON() const;
+
+    /**
+     * \brief Return the service worker, made of the template with the manifest inserted
+     * in place of the GDJS_PRECACHE_MANIFEST placeholder.
+     * \return The service worker, or an empty string if the template has no place for the manifest.
+     */
+    std::string GenerateServiceWorker(const std::string & serviceWorkerTemplate) const;
+
+    /**
+     * \brief Return the HTML registering the service worker, to be inserted in the index file.
+     */
+    static std::string GetRegistrationHTML();
+
+    static const std::string manifestFilename; ///< The name of the manifest file, in the export directory.
+    static const std::string serviceWorkerFilename; ///< The name of the service worker, in the export directory.
+
+private:
+    /**
+     * \brief Add a file and the hash of its content, unless the file was already added.
+     */
+    void AddEntry(const std::string & filename, const std::string & hash);
+
+    gd::AbstractFileSystem & fs;
+    std::string exportDir;
+    std::vector< std::pair<std::string, std::string> > files; ///< The filenames and the hash of their content, in the order they were added.
+    std::set<std::string> addedFiles;
+};
+
+}
+#endif // PRECACHEMANIFEST_H
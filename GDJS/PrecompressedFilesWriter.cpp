@@ -0,0 +1,247 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <cctype>
+#include <cstdio>
+#include <sys/stat.h>
+#if !defined(GD_NO_WX_GUI)
+#include <wx/thread.h>
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+#include <wx/utils.h>
+#include <wx/filefn.h>
+#include <wx/config.h>
+#endif
+#include "GDCore/CommonTools.h"
+#include "GDJS/PrecompressedFilesWriter.h"
+
+namespace gdjs
+{
+
+/**
+ * \brief Return the size of the file, or 0 if it can't be opened.
+ */
+static size_t GetFileSize(const std::string & file)
+{
+    FILE * input = fopen(file.c_str(), "rb");
+    if ( !input ) return 0;
+
+    fseek(input, 0, SEEK_END);
+    long size = ftell(input);
+    fclose(input);
+
+    return size > 0 ? size : 0;
+}
+
+#if !defined(GD_NO_WX_GUI)
+/**
+ * \brief The state shared by the workers of a PrecompressedFilesWriter.
+ */
+struct PrecompressedFilesWriterJobs
+{
+    PrecompressedFilesWriterJobs(unsigned int filesCount_) :
+        nextFile(0), filesCount(filesCount_), succeeded(filesCount_, 0) {};
+
+    wxMutex mutex; ///< Protects nextFile.
+    unsigned int nextFile; ///< The index of the next file to be compressed by a worker.
+    unsigned int filesCount;
+    std::vector<char> succeeded; ///< For each file, 1 if its gzip file was written. Each element is only written by the worker compressing the file.
+};
+
+/**
+ * \brief A thread writing the gzip files of a PrecompressedFilesWriter until there are no more files to compress.
+ */
+class PrecompressedFilesWriterWorker : public wxThread
+{
+public:
+    PrecompressedFilesWriterWorker(PrecompressedFilesWriter & writer_, PrecompressedFilesWriterJobs & jobs_) :
+        wxThread(wxTHREAD_JOINABLE), writer(writer_), jobs(jobs_) {};
+    virtual ~PrecompressedFilesWriterWorker() {};
+
+    virtual ExitCode Entry()
+    {
+        while ( true )
+        {
+            unsigned int index = 0;
+            {
+                wxMutexLocker lock(jobs.mutex);
+                if ( jobs.nextFile >= jobs.filesCount ) break;
+                index = jobs.nextFile++;
+            }
+
+            jobs.succeeded[index] = writer.WriteGzipFile(index) ? 1 : 0;
+        }
+
+        return 0;
+    }
+
+private:
+    PrecompressedFilesWriter & writer;
+    PrecompressedFilesWriterJobs & jobs;
+};
+#endif
+
+PrecompressedFilesWriter::PrecompressedFilesWriter(unsigned int workersCount_) :
+    workersCount(std::max(workersCount_, 1u)),
+    minimumSize(1024),
+    brotliQuality(11)
+{
+}
+
+bool PrecompressedFilesWriter::IsTextFile(const std::string & filename)
+{
+    size_t dot = filename.find_last_of('.');
+    if ( dot == std::string::npos ) return false;
+
+    std::string extension = filename.substr(dot+1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    static const char * textExtensions[] = {"js", "json", "html", "htm", "css", "txt", "xml", "svg"};
+    for (unsigned int i = 0;i<sizeof(textExtensions)/sizeof(textExtensions[0]);++i)
+    {
+        if ( extension == textExtensions[i] ) return true;
+    }
+
+    return false;
+}
+
+bool PrecompressedFilesWriter::HasUpToDateGzipFile(const std::string & file)
+{
+    struct stat fileStat;
+    struct stat gzipStat;
+    return stat(file.c_str(), &fileStat) == 0 && stat((file+".gz").c_str(), &gzipStat) == 0 &&
+        gzipStat.st_mtime >= fileStat.st_mtime;
+}
+
+void PrecompressedFilesWriter::AddFile(const std::string & file)
+{
+    if ( !IsTextFile(file) || GetFileSize(file) < minimumSize ) return;
+
+    files.push_back(file);
+}
+
+bool PrecompressedFilesWriter::WriteGzipFile(unsigned int index)
+{
+    #if !defined(GD_NO_WX_GUI)
+    const std::string & file = files[index];
+    std::ifstream input(file.c_str(), std::ios::in | std::ios::binary);
+    if ( !input.is_open() ) return false;
+
+    std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    wxMemoryOutputStream memoryStream;
+    {
+        wxZlibOutputStream zlibStream(memoryStream, 9, wxZLIB_GZIP);
+        zlibStream.Write(content.c_str(), content.size());
+        zlibStream.Close();
+    }
+
+    size_t compressedSize = memoryStream.GetSize();
+    if ( compressedSize >= content.size() ) return true; //Compression is useless for this file.
+
+    std::string compressed(compressedSize, '\0');
+    memoryStream.CopyTo(&compressed[0], compressedSize);
+
+    std::ofstream output((file+".gz").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if ( !output.is_open() ) return false;
+    output.write(compressed.c_str(), compressed.size());
+
+    return output.good();
+    #else
+    return false;
+    #endif
+}
+
+void PrecompressedFilesWriter::WriteBrotliFiles()
+{
+    #if !defined(GD_NO_WX_GUI)
+    wxString brotliExec = "brotli";
+    wxString userPath;
+    if ( wxConfigBase::Get()->Read("Paths/Brotli" , &userPath) && !userPath.empty() )
+        brotliExec = userPath;
+
+    //The files are given to brotli by groups, to avoid too long command lines.
+    const unsigned int filesPerCommand = 32;
+    for (unsigned int i = 0;i<files.size();i += filesPerCommand)
+    {
+        wxString cmd = "\""+brotliExec+"\" -q "+gd::ToString(brotliQuality)+" -k -f";
+        for (unsigned int j = i;j<files.size() && j<i+filesPerCommand;++j)
+            cmd += " \""+files[j]+"\"";
+
+        wxArrayString output;
+        wxArrayString errors;
+        if ( wxExecute(cmd, output, errors) != 0 )
+        {
+            std::cout << "Brotli files not written: execution of brotli failed ( Command line : " << cmd << ")." << std::endl;
+            return; //Most likely not installed: no need to try with the other files.
+        }
+    }
+
+    //Remove the brotli files which are useless.
+    for (unsigned int i = 0;i<files.size();++i)
+    {
+        if ( wxFileExists(files[i]+".br") && GetFileSize(files[i]+".br") >= GetFileSize(files[i]) )
+            wxRemoveFile(files[i]+".br");
+    }
+    #endif
+}
+
+bool PrecompressedFilesWriter::WriteAll()
+{
+    #if !defined(GD_NO_WX_GUI)
+    std::vector<char> succeeded(files.size(), 0);
+    bool filesWritten = false;
+
+    if ( workersCount > 1 && files.size() > 1 )
+    {
+        PrecompressedFilesWriterJobs jobs(files.size());
+
+        //Launch the workers
+        std::vector<PrecompressedFilesWriterWorker*> workers;
+        for (unsigned int i = 0;i<std::min<size_t>(workersCount, files.size());++i)
+        {
+            PrecompressedFilesWriterWorker * worker = new PrecompressedFilesWriterWorker(*this, jobs);
+            if ( worker->Run() == wxTHREAD_NO_ERROR )
+                workers.push_back(worker);
+            else
+                delete worker;
+        }
+
+        if ( !workers.empty() )
+        {
+            //Brotli is launched from this thread while the workers are writing the gzip files.
+            WriteBrotliFiles();
+
+            for (unsigned int i = 0;i<workers.size();++i)
+            {
+                workers[i]->Wait();
+                delete workers[i];
+            }
+
+            succeeded = jobs.succeeded;
+            filesWritten = true;
+        }
+    }
+
+    //Compress the files one after the other if threads are not available.
+    if ( !filesWritten )
+    {
+        for (unsigned int i = 0;i<files.size();++i)
+            succeeded[i] = WriteGzipFile(i) ? 1 : 0;
+
+        WriteBrotliFiles();
+    }
+
+    return std::find(succeeded.begin(), succeeded.end(), 0) == succeeded.end();
+    #else
+    return false;
+    #endif
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef PRECOMPRESSEDFILESWRITER_H
+#define PRECOMPRESSEDFILESWRITER_H
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace gdjs
+{
+
+/**
+ * \brief Write, next to text files, their compressed versions ( "file.js.gz" and "file.js.br" ) so that
+ * web servers can send them as is, rather than compressing the files for each request.
+ *
+ * Gzip files are written using the best compression level by a pool of worker threads. Brotli
+ * files are written by the brotli command line tool ( the path of the tool can be set in the
+ * "Paths/Brotli" setting ), if it is installed, while the gzip files are compressed.<br>
+ * A compressed file is not written if it is not smaller than the original file.
+ * When wxWidgets is not available, no files are written.
+ *
+ * \see HttpServer
+ */
+class PrecompressedFilesWriter
+{
+public:
+    /**
+     * \brief Create a writer.
+     * \param workersCount The maximum number of files compressed at the same time.
+     */
+    PrecompressedFilesWriter(unsigned int workersCount = 4);
+    virtual ~PrecompressedFilesWriter() {};
+
+    /**
+     * \brief Set the minimum size, in bytes, of the files to be compressed ( default is 1024 bytes ).
+     * Smaller files would not gain much from being compressed.
+     */
+    void SetMinimumSize(size_t minimumSize_) { minimumSize = minimumSize_; };
+
+    /**
+     * \brief Set the quality used by brotli, from 0 to 11 ( default is 11, the best and the slowest ).
+     */
+    void SetBrotliQuality(unsigned int quality) { brotliQuality = std::min(quality, 11u); };
+
+    /**
+     * \brief Add a file to be compressed. The file is ignored if it is not a text file, or if it is too small.
+     */
+    void AddFile(const std::string & file);
+
+    /**
+     * \brief Write the compressed versions of all the files added.
+     * \return true if all the gzip files were written ( brotli files are optional ).
+     */
+    bool WriteAll();
+
+    /**
+     * \brief Return true if the file is a text file ( JS, HTML, JSON... ), worth being compressed.
+     */
+    static bool IsTextFile(const std::string & filename);
+
+    /**
+     * \brief Return true if the gzip version of the file exists and is not older than the file.
+     */
+    static bool HasUpToDateGzipFile(const std::string & file);
+
+private:
+    friend class PrecompressedFilesWriterWorker;
+
+    /**
+     * \brief Write the gzip file of the file at the specified index.
+     * \return true if the gzip file was written, or was useless.
+     */
+    bool WriteGzipFile(unsigned int index);
+
+    /**
+     * \brief Write the brotli files of all the files, using the brotli command line tool.
+     */
+    void WriteBrotliFiles();
+
+    unsigned int workersCount;
+    size_t minimumSize;
+    unsigned int brotliQuality;
+    std::vector<std::string> files;
+};
+
+}
+#endif // PRECOMPRESSEDFILESWRITER_H
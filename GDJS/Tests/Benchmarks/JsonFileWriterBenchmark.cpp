@@ -0,0 +1,188 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+
+/**
+ * gdjs-benchmark-json measures the time and the memory used to write the data of a project with
+ * a layout containing a lot of instances, with gd::Serializer::ToJSON ( the whole JSON is built in memory
+ * before being written ) and with JsonFileWriter ( the JSON is written through a buffer ).
+ *
+ * Usage: gdjs-benchmark-json [tojson|stream] [instances count ( default: 100000 )]
+ * Without a method, both are measured, each one in its own process so that the peak memory
+ * of a method does not hide the one of the other.
+ */
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#if !defined(WINDOWS)
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#else
+#include <ctime>
+#endif
+#include "GDCore/Serialization/Serializer.h"
+#include "GDCore/Serialization/SerializerElement.h"
+#include "GDCore/CommonTools.h"
+#include "GDJS/CLI/HeadlessFileSystem.h"
+#include "GDJS/JsonFileWriter.h"
+
+using namespace gdjs;
+
+/**
+ * \brief Fill the element with a project containing a layout with \a instancesCount instances,
+ * serialized like gd::Project::SerializeTo does ( instances are placed on a grid ).
+ */
+static void FillProjectElement(gd::SerializerElement & projectElement, unsigned int instancesCount)
+{
+    gd::SerializerElement & propertiesElement = projectElement.AddChild("properties");
+    propertiesElement.SetAttribute("name", std::string("Instances export benchmark"));
+    propertiesElement.SetAttribute("windowWidth", 800);
+    propertiesElement.SetAttribute("windowHeight", 600);
+
+    gd::SerializerElement & layoutsElement = projectElement.AddChild("layouts");
+    layoutsElement.ConsiderAsArrayOf("layout");
+    gd::SerializerElement & layoutElement = layoutsElement.AddChild("layout");
+    layoutElement.SetAttribute("name", std::string("Benchmark"));
+
+    gd::SerializerElement & objectsElement = layoutElement.AddChild("objects");
+    objectsElement.ConsiderAsArrayOf("object");
+    gd::SerializerElement & objectElement = objectsElement.AddChild("object");
+    objectElement.SetAttribute("name", std::string("NewObject"));
+    objectElement.SetAttribute("type", std::string("Sprite"));
+
+    gd::SerializerElement & instancesElement = layoutElement.AddChild("instances");
+    instancesElement.ConsiderAsArrayOf("instance");
+    for (unsigned int i = 0;i<instancesCount;++i)
+    {
+        gd::SerializerElement & instanceElement = instancesElement.AddChild("instance");
+        instanceElement.SetAttribute("name", std::string("NewObject"));
+        instanceElement.SetAttribute("x", static_cast<double>((i%1000)*2));
+        instanceElement.SetAttribute("y", static_cast<double>((i/1000)*2));
+        instanceElement.SetAttribute("zOrder", 1);
+        instanceElement.SetAttribute("layer", std::string(""));
+        instanceElement.SetAttribute("angle", 0.0);
+        instanceElement.SetAttribute("customSize", false);
+        instanceElement.SetAttribute("width", 0.0);
+        instanceElement.SetAttribute("height", 0.0);
+        instanceElement.SetAttribute("locked", false);
+        instanceElement.AddChild("numberProperties").ConsiderAsArrayOf("property");
+        instanceElement.AddChild("stringProperties").ConsiderAsArrayOf("property");
+        instanceElement.AddChild("initialVariables").ConsiderAsArrayOf("variable");
+    }
+}
+
+/**
+ * \brief Return the time elapsed since an arbitrary point, in milliseconds.
+ */
+static double GetTimeMs()
+{
+    #if !defined(WINDOWS)
+    timeval time;
+    gettimeofday(&time, NULL);
+    return time.tv_sec*1000.0+time.tv_usec/1000.0;
+    #else
+    return clock()*1000.0/CLOCKS_PER_SEC;
+    #endif
+}
+
+/**
+ * \brief Return the peak memory used by the process, in kilobytes ( 0 if not available ).
+ */
+static long GetPeakMemoryKb()
+{
+    #if !defined(WINDOWS)
+    rusage usage;
+    if ( getrusage(RUSAGE_SELF, &usage) != 0 ) return 0;
+    #if defined(MACOS)
+    return usage.ru_maxrss/1024; //In bytes on OS X.
+    #else
+    return usage.ru_maxrss;
+    #endif
+    #else
+    return 0;
+    #endif
+}
+
+/**
+ * \brief Write the project data with the method, and print the time and the memory used.
+ * \return false if the file could not be written.
+ */
+static bool Measure(const std::string & method, unsigned int instancesCount, const std::string & filename)
+{
+    gd::SerializerElement projectElement;
+    FillProjectElement(projectElement, instancesCount);
+
+    //The element is built before measuring: only the memory used to write it is counted.
+    long memoryBefore = GetPeakMemoryKb();
+    double timeBefore = GetTimeMs();
+    bool written = false;
+    if ( method == "tojson" )
+    {
+        HeadlessFileSystem fs("");
+        written = fs.WriteToFile(filename, "gdjs.projectData = "+gd::Serializer::ToJSON(projectElement)+";");
+    }
+    else
+    {
+        JsonFileWriter writer;
+        written = writer.Open(filename);
+        writer.Write("gdjs.projectData = ");
+        writer.WriteJSON(projectElement);
+        writer.Write(";");
+        written = writer.Close() && written;
+    }
+    double time = GetTimeMs()-timeBefore;
+    long memory = GetPeakMemoryKb()-memoryBefore;
+
+    std::cout << method << ": " << instancesCount << " instances written in " << time << "ms, "
+        << "peak memory increased by " << memory << "KB" << (written ? "" : " ( unable to write the file )") << std::endl;
+    return written;
+}
+
+int main(int argc, char ** argv)
+{
+    std::string method = argc > 1 ? argv[1] : "";
+    unsigned int instancesCount = argc > 2 ? atoi(argv[2]) : 100000;
+    if ( !method.empty() && method != "tojson" && method != "stream" )
+    {
+        std::cout << "Usage: gdjs-benchmark-json [tojson|stream] [instances count]" << std::endl;
+        return 1;
+    }
+
+    #if defined(WINDOWS)
+    const char * temp = getenv("TEMP");
+    std::string filename = std::string(temp ? temp : ".")+"/gdjs-benchmark-json.js";
+    #else
+    const char * temp = getenv("TMPDIR");
+    std::string filename = std::string(temp ? temp : "/tmp")+"/gdjs-benchmark-json.js";
+    #endif
+
+    bool success = true;
+    if ( !method.empty() )
+        success = Measure(method, instancesCount, filename);
+    else
+    {
+        const char * methods[] = {"tojson", "stream"};
+        for (unsigned int i = 0;i<2;++i)
+        {
+            #if !defined(WINDOWS)
+            //Each method is measured in its own process, to have its own peak memory.
+            pid_t pid = fork();
+            if ( pid == 0 ) return Measure(methods[i], instancesCount, filename) ? 0 : 1;
+
+            int status = 1;
+            if ( pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 )
+                success = false;
+            #else
+            success = Measure(methods[i], instancesCount, filename) && success;
+            #endif
+        }
+    }
+
+    remove(filename.c_str());
+    return success ? 0 : 1;
+}
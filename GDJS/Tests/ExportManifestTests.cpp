@@ -0,0 +1,92 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <string>
+#include <cstdio>
+#include "GDJS/CLI/HeadlessFileSystem.h"
+#include "GDJS/ExportManifest.h"
+#include "GDJS/Tests/Tests.h"
+#undef CopyFile //Disable an annoying macro
+
+namespace gdjs
+{
+namespace tests
+{
+
+/**
+ * \brief Export the files like a preview: two resources copied and an index file written.
+ * \return The number of files written.
+ */
+static unsigned int ExportFiles(HeadlessFileSystem & fs, const std::string & sourceDir, const std::string & exportDir,
+    const std::string & indexContent, bool exportSecondResource = true)
+{
+    ExportManifest manifest(fs, exportDir);
+    manifest.Load();
+    GDJS_CHECK(manifest.CopyFile(sourceDir+"/image.png", exportDir+"/image.png"));
+    if ( exportSecondResource ) GDJS_CHECK(manifest.CopyFile(sourceDir+"/sound.wav", exportDir+"/sound.wav"));
+    GDJS_CHECK(manifest.WriteToFile(exportDir+"/index.html", indexContent));
+    manifest.RemoveStaleFiles();
+    GDJS_CHECK(manifest.Save());
+
+    return manifest.GetWrittenFilesCount();
+}
+
+void TestExportManifest(HeadlessFileSystem & fs, const std::string & testDir)
+{
+    std::string sourceDir = testDir+"/source";
+    std::string exportDir = testDir+"/export";
+    fs.MkDir(sourceDir);
+    fs.MkDir(exportDir);
+    fs.WriteToFile(sourceDir+"/image.png", "image content");
+    fs.WriteToFile(sourceDir+"/sound.wav", "sound content");
+
+    //First export: everything is written.
+    GDJS_CHECK(ExportFiles(fs, sourceDir, exportDir, "<html></html>") == 3);
+    GDJS_CHECK(fs.FileExists(exportDir+"/"+ExportManifest::manifestFilename));
+    GDJS_CHECK(fs.ReadFile(exportDir+"/image.png") == "image content");
+    GDJS_CHECK(fs.ReadFile(exportDir+"/index.html") == "<html></html>");
+
+    //Second export of the same files: nothing is rewritten.
+    fs.WriteToFile(exportDir+"/image.png", "modified in place"); //Would be restored if the file was copied again.
+    GDJS_CHECK(ExportFiles(fs, sourceDir, exportDir, "<html></html>") == 0);
+    GDJS_CHECK(fs.ReadFile(exportDir+"/image.png") == "modified in place");
+
+    //Only the changed files are written.
+    fs.WriteToFile(exportDir+"/image.png", "image content");
+    fs.WriteToFile(sourceDir+"/sound.wav", "new sound content");
+    GDJS_CHECK(ExportFiles(fs, sourceDir, exportDir, "<html><body></body></html>") == 2);
+    GDJS_CHECK(fs.ReadFile(exportDir+"/sound.wav") == "new sound content");
+    GDJS_CHECK(fs.ReadFile(exportDir+"/index.html") == "<html><body></body></html>");
+
+    //A file deleted from the export directory is written again.
+    remove((exportDir+"/index.html").c_str());
+    GDJS_CHECK(ExportFiles(fs, sourceDir, exportDir, "<html><body></body></html>") == 1);
+    GDJS_CHECK(fs.FileExists(exportDir+"/index.html"));
+
+    //The files which are not exported anymore are removed.
+    GDJS_CHECK(ExportFiles(fs, sourceDir, exportDir, "<html><body></body></html>", false) == 0);
+    GDJS_CHECK(!fs.FileExists(exportDir+"/sound.wav"));
+    GDJS_CHECK(fs.FileExists(exportDir+"/image.png"));
+
+    //Without a manifest, everything is written again.
+    remove((exportDir+"/"+ExportManifest::manifestFilename).c_str());
+    GDJS_CHECK(ExportFiles(fs, sourceDir, exportDir, "<html><body></body></html>") == 3);
+
+    //The files written are listed, and the compressed versions of the removed files are removed too.
+    fs.WriteToFile(exportDir+"/sound.wav.gz", "compressed sound content");
+    ExportManifest manifest(fs, exportDir);
+    manifest.Load();
+    GDJS_CHECK(manifest.WriteToFile(exportDir+"/index.html", "<html><body></body></html>"));
+    GDJS_CHECK(manifest.WriteToFile(exportDir+"/other.html", "<html></html>"));
+    manifest.RemoveStaleFiles();
+    GDJS_CHECK(manifest.GetExportedFiles().size() == 2);
+    GDJS_CHECK(manifest.GetWrittenFiles().size() == 1);
+    GDJS_CHECK(manifest.GetWrittenFiles().count(exportDir+"/other.html") == 1);
+    GDJS_CHECK(!fs.FileExists(exportDir+"/sound.wav"));
+    GDJS_CHECK(!fs.FileExists(exportDir+"/sound.wav.gz"));
+}
+
+}
+}
@@ -0,0 +1,89 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <string>
+#include "GDCore/Serialization/Serializer.h"
+#include "GDCore/Serialization/SerializerElement.h"
+#include "GDCore/CommonTools.h"
+#include "GDJS/CLI/HeadlessFileSystem.h"
+#include "GDJS/JsonFileWriter.h"
+#include "GDJS/Tests/Tests.h"
+
+namespace gdjs
+{
+namespace tests
+{
+
+/**
+ * \brief Fill the element with all the kinds of values that a serialized project can contain.
+ */
+static void FillElement(gd::SerializerElement & element)
+{
+    element.SetAttribute("name", std::string("A \"quoted\" name with a \\ backslash"));
+    element.SetAttribute("text", std::string("Line 1\nLine 2\tTabulated\r\x01\x1f"));
+    element.SetAttribute("latin1", std::string("Sc\xe8ne"));
+    element.SetAttribute("empty", std::string(""));
+    element.SetAttribute("integer", -42);
+    element.SetAttribute("double", 3.25);
+    element.SetAttribute("bool", true);
+    element.SetAttribute("otherBool", false);
+
+    gd::SerializerElement & objectsElement = element.AddChild("objects");
+    objectsElement.ConsiderAsArrayOf("object");
+    for (unsigned int i = 0;i<3;++i)
+    {
+        gd::SerializerElement & objectElement = objectsElement.AddChild("object");
+        objectElement.SetAttribute("name", "Object"+gd::ToString(i));
+        objectElement.SetAttribute("x", i*10.5);
+        objectElement.AddChild("variables").ConsiderAsArrayOf("variable");
+    }
+
+    element.AddChild("emptyObject");
+    element.AddChild("emptyArray").ConsiderAsArrayOf("item");
+    element.AddChild("stringValue").SetValue(std::string("Value with \"quotes\""));
+    element.AddChild("intValue").SetValue(7);
+    element.AddChild("doubleValue").SetValue(0.5);
+    element.AddChild("boolValue").SetValue(true);
+}
+
+/**
+ * \brief Check that the element written by JsonFileWriter, with the given buffer size, is the same as
+ * the JSON returned by gd::Serializer::ToJSON.
+ */
+static void CheckSameAsToJSON(HeadlessFileSystem & fs, const std::string & filename,
+    const gd::SerializerElement & element, size_t bufferSize)
+{
+    JsonFileWriter writer(bufferSize);
+    GDJS_CHECK(writer.Open(filename));
+    writer.Write("gdjs.projectData = ");
+    writer.WriteJSON(element);
+    writer.Write(";");
+    GDJS_CHECK(writer.Close());
+
+    GDJS_CHECK(fs.ReadFile(filename) == "gdjs.projectData = "+gd::Serializer::ToJSON(element)+";");
+}
+
+void TestJsonFileWriter(HeadlessFileSystem & fs, const std::string & testDir)
+{
+    gd::SerializerElement element;
+    FillElement(element);
+
+    CheckSameAsToJSON(fs, testDir+"/data.js", element, 256*1024);
+    CheckSameAsToJSON(fs, testDir+"/data.js", element, 7); //Most writes are bigger than the buffer.
+    CheckSameAsToJSON(fs, testDir+"/data.js", element, 1);
+
+    //A value alone is written as a value.
+    gd::SerializerElement valueElement;
+    valueElement.SetValue(std::string("Only a value"));
+    CheckSameAsToJSON(fs, testDir+"/value.js", valueElement, 64);
+
+    //Writing to a file which can't be opened is reported.
+    JsonFileWriter writer;
+    GDJS_CHECK(!writer.Open(testDir+"/not/existing/directory/data.js"));
+    GDJS_CHECK(!writer.Close());
+}
+
+}
+}
@@ -0,0 +1,83 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <string>
+#include <vector>
+#include "GDJS/CLI/HeadlessFileSystem.h"
+#include "GDJS/ExportManifest.h"
+#include "GDJS/PrecacheManifest.h"
+#include "GDJS/Tests/Tests.h"
+
+namespace gdjs
+{
+namespace tests
+{
+
+/**
+ * \brief Create the manifest of the export directory like the exporter does.
+ */
+static std::string GetManifestJSON(HeadlessFileSystem & fs, const std::string & exportDir)
+{
+    PrecacheManifest manifest(fs, exportDir);
+    std::vector<std::string> includesFiles;
+    includesFiles.push_back("libs/pixi.js");
+    includesFiles.push_back("code.js"); //Also in the export directory: only added once.
+    manifest.AddFiles(includesFiles);
+    manifest.AddExportDirectoryFiles();
+    manifest.AddContent("index.html", "<html></html>");
+
+    return manifest.ToJSON();
+}
+
+void TestPrecacheManifest(HeadlessFileSystem & fs, const std::string & testDir)
+{
+    std::string exportDir = testDir+"/export";
+    fs.MkDir(exportDir);
+    fs.MkDir(exportDir+"/libs");
+    fs.WriteToFile(exportDir+"/libs/pixi.js", "pixi");
+    fs.WriteToFile(exportDir+"/code.js", "code");
+    fs.WriteToFile(exportDir+"/data.js", "data");
+    fs.WriteToFile(exportDir+"/image.png", "image");
+
+    //Files which must not be cached by the service worker.
+    fs.WriteToFile(exportDir+"/index.html", "<html>Old index</html>");
+    fs.WriteToFile(exportDir+"/code.js.gz", "compressed code");
+    fs.WriteToFile(exportDir+"/code.js.br", "compressed code");
+    fs.WriteToFile(exportDir+"/"+PrecacheManifest::serviceWorkerFilename, "old worker");
+    fs.WriteToFile(exportDir+"/"+PrecacheManifest::manifestFilename, "{}");
+    fs.WriteToFile(exportDir+"/"+ExportManifest::manifestFilename, "");
+
+    //Files which can't be read are not added.
+    PrecacheManifest manifest(fs, exportDir);
+    GDJS_CHECK(!manifest.AddFile("missing.js"));
+    std::string emptyVersion = manifest.GetVersion();
+
+    //The files are listed in the order they are added, the files of the directory being sorted.
+    std::string json = GetManifestJSON(fs, exportDir);
+    std::string files = "[{\"url\":\"libs/pixi.js\",\"hash\":\""+ExportManifest::HashContent("pixi")+"\"},"
+        "{\"url\":\"code.js\",\"hash\":\""+ExportManifest::HashContent("code")+"\"},"
+        "{\"url\":\"data.js\",\"hash\":\""+ExportManifest::HashContent("data")+"\"},"
+        "{\"url\":\"image.png\",\"hash\":\""+ExportManifest::HashContent("image")+"\"},"
+        "{\"url\":\"index.html\",\"hash\":\""+ExportManifest::HashContent("<html></html>")+"\"}]";
+    GDJS_CHECK(json.find(",\"files\":"+files+"}") != std::string::npos);
+    GDJS_CHECK(json.find("{\"version\":\"") == 0);
+    GDJS_CHECK(json.find("\"version\":\""+emptyVersion+"\"") == std::string::npos);
+
+    //The version only changes when a file changes.
+    GDJS_CHECK(GetManifestJSON(fs, exportDir) == json);
+    fs.WriteToFile(exportDir+"/data.js", "new data");
+    std::string newJson = GetManifestJSON(fs, exportDir);
+    GDJS_CHECK(newJson != json);
+    GDJS_CHECK(newJson.substr(0, newJson.find(",\"files\"")) != json.substr(0, json.find(",\"files\"")));
+
+    //The manifest is inserted in the service worker.
+    PrecacheManifest emptyManifest(fs, exportDir);
+    GDJS_CHECK(emptyManifest.GenerateServiceWorker("var gdjsPrecache = {}/*GDJS_PRECACHE_MANIFEST*/;") ==
+        "var gdjsPrecache = "+emptyManifest.ToJSON()+";");
+    GDJS_CHECK(emptyManifest.GenerateServiceWorker("var gdjsPrecache = {};") == "");
+}
+
+}
+}
@@ -0,0 +1,39 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef GDJS_TESTS_H
+#define GDJS_TESTS_H
+#include <string>
+namespace gdjs { class HeadlessFileSystem; }
+
+/**
+ * \brief Check a condition in a test. The condition is printed if it is false.
+ */
+#define GDJS_CHECK(condition) gdjs::tests::Check((condition), #condition, __FILE__, __LINE__)
+
+namespace gdjs
+{
+namespace tests
+{
+
+/**
+ * \brief Count a check, printing it if it failed.
+ * \return The condition.
+ */
+bool Check(bool condition, const char * expression, const char * file, int line);
+
+/**
+ * \brief A test, run by gdjs-tests with a file system and an empty directory where it can write files.
+ */
+typedef void (*TestFunction)(HeadlessFileSystem & fs, const std::string & testDir);
+
+//The tests:
+void TestExportManifest(HeadlessFileSystem & fs, const std::string & testDir);
+void TestJsonFileWriter(HeadlessFileSystem & fs, const std::string & testDir);
+void TestPrecacheManifest(HeadlessFileSystem & fs, const std::string & testDir);
+
+}
+}
+#endif // GDJS_TESTS_H
@@ -0,0 +1,107 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+
+/**
+ * gdjs-tests runs the tests of the parts of GDJS which can work without wxWidgets.
+ * It is built with the command line exporter ( GDJS_NO_WX_GUI option ) and launched by ctest.
+ * Usage: gdjs-tests [test name...]
+ */
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#if !defined(WINDOWS)
+#include <unistd.h>
+#endif
+#include "GDJS/CLI/HeadlessFileSystem.h"
+#include "GDJS/Tests/Tests.h"
+
+namespace gdjs
+{
+namespace tests
+{
+
+static unsigned int checksCount = 0;
+static unsigned int failuresCount = 0;
+
+bool Check(bool condition, const char * expression, const char * file, int line)
+{
+    checksCount++;
+    if ( !condition )
+    {
+        failuresCount++;
+        std::cout << file << ":" << line << ": check failed: " << expression << std::endl;
+    }
+
+    return condition;
+}
+
+}
+}
+
+using namespace gdjs;
+
+/**
+ * \brief Return a directory, not existing yet, where the tests can write their files.
+ */
+static std::string GetTestsDir()
+{
+    #if defined(WINDOWS)
+    const char * temp = getenv("TEMP");
+    std::string tempDir = temp ? temp : ".";
+    return tempDir+"/gdjs-tests";
+    #else
+    const char * temp = getenv("TMPDIR");
+    std::string tempDir = temp ? temp : "/tmp";
+    std::ostringstream dir;
+    dir << tempDir << "/gdjs-tests-" << getpid();
+    return dir.str();
+    #endif
+}
+
+int main(int argc, char ** argv)
+{
+    struct Test
+    {
+        const char * name;
+        tests::TestFunction function;
+    };
+    const Test allTests[] = {
+        {"ExportManifest", &tests::TestExportManifest},
+        {"JsonFileWriter", &tests::TestJsonFileWriter},
+        {"PrecacheManifest", &tests::TestPrecacheManifest}
+    };
+
+    std::string testsDir = GetTestsDir();
+    HeadlessFileSystem fs(testsDir);
+    unsigned int testsRun = 0;
+    for (unsigned int i = 0;i<sizeof(allTests)/sizeof(allTests[0]);++i)
+    {
+        //Only the tests named on the command line are run, if any.
+        bool selected = argc <= 1;
+        for (int j = 1;j<argc;++j)
+            if ( strcmp(argv[j], allTests[i].name) == 0 ) selected = true;
+        if ( !selected ) continue;
+
+        std::string testDir = testsDir+"/"+allTests[i].name;
+        if ( fs.DirExists(testDir) ) fs.RemoveDir(testDir);
+        if ( !fs.MkDir(testDir) )
+        {
+            std::cout << "Unable to create " << testDir << std::endl;
+            return 1;
+        }
+
+        unsigned int failuresBefore = tests::failuresCount;
+        allTests[i].function(fs, testDir);
+        std::cout << allTests[i].name << ": " << (tests::failuresCount == failuresBefore ? "OK" : "FAILED") << std::endl;
+        testsRun++;
+    }
+    if ( fs.DirExists(testsDir) ) fs.RemoveDir(testsDir);
+
+    std::cout << testsRun << " test(s), " << tests::checksCount << " check(s), "
+        << tests::failuresCount << " failure(s)" << std::endl;
+    return tests::failuresCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <algorithm>
+#include "GDJS/TextureAtlasPacker.h"
+
+namespace gdjs
+{
+
+/**
+ * \brief Sort the rectangles by decreasing height, then by decreasing width.
+ */
+class RectanglesOrder
+{
+public:
+    RectanglesOrder(const std::vector< std::pair<unsigned int, unsigned int> > & rectangles_) : rectangles(rectangles_) {};
+
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        if ( rectangles[a].second != rectangles[b].second ) return rectangles[a].second > rectangles[b].second;
+        if ( rectangles[a].first != rectangles[b].first ) return rectangles[a].first > rectangles[b].first;
+        return a < b;
+    }
+
+private:
+    const std::vector< std::pair<unsigned int, unsigned int> > & rectangles;
+};
+
+TextureAtlasPacker::TextureAtlasPacker(unsigned int pageSize_, unsigned int padding_) :
+    pageSize(pageSize_),
+    padding(padding_)
+{
+}
+
+unsigned int TextureAtlasPacker::AddRectangle(unsigned int width, unsigned int height)
+{
+    rectangles.push_back(std::make_pair(width, height));
+    placements.push_back(Placement());
+
+    return rectangles.size()-1;
+}
+
+bool TextureAtlasPacker::FindPosition(const Page & page, unsigned int width, unsigned int height,
+    unsigned int & nodeIndex, unsigned int & x, unsigned int & y) const
+{
+    bool found = false;
+    unsigned int bestBottom = 0;
+    unsigned int bestWidth = 0;
+    for (unsigned int i = 0;i<page.skyline.size();++i)
+    {
+        unsigned int nodeX = page.skyline[i].x;
+        if ( nodeX + width > pageSize ) break;
+
+        //The rectangle lays on the highest of the nodes it covers.
+        unsigned int top = 0;
+        unsigned int remainingWidth = width;
+        for (unsigned int j = i;j<page.skyline.size() && remainingWidth > 0;++j)
+        {
+            top = std::max(top, page.skyline[j].y);
+            remainingWidth -= std::min(remainingWidth, page.skyline[j].width);
+        }
+        if ( top + height > pageSize ) continue;
+
+        if ( !found || top + height < bestBottom || (top + height == bestBottom && page.skyline[i].width < bestWidth) )
+        {
+            found = true;
+            bestBottom = top + height;
+            bestWidth = page.skyline[i].width;
+            nodeIndex = i;
+            x = nodeX;
+            y = top;
+        }
+    }
+
+    return found;
+}
+
+void TextureAtlasPacker::PlaceRectangle(Page & page, unsigned int nodeIndex, unsigned int x, unsigned int y,
+    unsigned int width, unsigned int height)
+{
+    page.skyline.insert(page.skyline.begin()+nodeIndex, SkylineNode(x, y+height, width));
+
+    //Shrink or remove the nodes now below the rectangle.
+    for (unsigned int i = nodeIndex+1;i<page.skyline.size();)
+    {
+        SkylineNode & previous = page.skyline[i-1];
+        SkylineNode & node = page.skyline[i];
+        if ( node.x >= previous.x + previous.width ) break;
+
+        unsigned int shrink = previous.x + previous.width - node.x;
+        if ( shrink < node.width )
+        {
+            node.x += shrink;
+            node.width -= shrink;
+            break;
+        }
+
+        page.skyline.erase(page.skyline.begin()+i);
+    }
+
+    //Merge the nodes at the same height.
+    for (unsigned int i = 0;i+1<page.skyline.size();)
+    {
+        if ( page.skyline[i].y == page.skyline[i+1].y )
+        {
+            page.skyline[i].width += page.skyline[i+1].width;
+            page.skyline.erase(page.skyline.begin()+i+1);
+        }
+        else
+            ++i;
+    }
+
+    page.usedWidth = std::max(page.usedWidth, x + width);
+    page.usedHeight = std::max(page.usedHeight, y + height);
+}
+
+void TextureAtlasPacker::Pack()
+{
+    pages.clear();
+
+    std::vector<unsigned int> order;
+    for (unsigned int i = 0;i<rectangles.size();++i) order.push_back(i);
+    std::sort(order.begin(), order.end(), RectanglesOrder(rectangles));
+
+    for (unsigned int i = 0;i<order.size();++i)
+    {
+        unsigned int index = order[i];
+        unsigned int width = rectangles[index].first + 2*padding;
+        unsigned int height = rectangles[index].second + 2*padding;
+        placements[index] = Placement();
+        if ( width > pageSize || height > pageSize ) continue;
+
+        unsigned int nodeIndex = 0, x = 0, y = 0;
+        unsigned int page = 0;
+        while ( page < pages.size() && !FindPosition(pages[page], width, height, nodeIndex, x, y) )
+            ++page;
+
+        if ( page == pages.size() ) //Fits in none of the pages: start a new one.
+        {
+            pages.push_back(Page(pageSize));
+            FindPosition(pages.back(), width, height, nodeIndex, x, y);
+        }
+
+        PlaceRectangle(pages[page], nodeIndex, x, y, width, height);
+        placements[index].packed = true;
+        placements[index].page = page;
+        placements[index].x = x + padding;
+        placements[index].y = y + padding;
+    }
+}
+
+}
@@ -0,0 +1,141 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef TEXTUREATLASPACKER_H
+#define TEXTUREATLASPACKER_H
+#include <string>
+#include <vector>
+
+namespace gdjs
+{
+
+/**
+ * \brief The location of an image packed in a texture atlas.
+ */
+struct TextureAtlasFrame
+{
+    std::string file; ///< The file of the atlas page, relative to the export directory.
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+    unsigned int height;
+};
+
+/**
+ * \brief Compute the positions of rectangles ( images ) packed into pages of a texture atlas.
+ *
+ * Rectangles are sorted by decreasing height and placed, one after the other, at the lowest position
+ * available in the first page where they fit ( "skyline bottom-left" algorithm ). A new page is started
+ * when a rectangle fits in none of the pages.<br>
+ * A padding is kept around each rectangle, so that the border pixels of the images can be repeated
+ * around them: this avoids the pixels of a neighbour image to be visible when the textures are filtered.
+ *
+ * Usage example:
+ * \code
+ * TextureAtlasPacker packer(2048, 2);
+ * unsigned int index = packer.AddRectangle(32, 48);
+ * packer.Pack();
+ * if ( packer.GetPlacement(index).packed ) ...
+ * \endcode
+ */
+class TextureAtlasPacker
+{
+public:
+    /**
+     * \brief The position of a rectangle in the atlas.
+     */
+    struct Placement
+    {
+        Placement() : packed(false), page(0), x(0), y(0) {};
+
+        bool packed; ///< False if the rectangle is too big to be packed.
+        unsigned int page;
+        unsigned int x; ///< The position of the rectangle, padding excluded.
+        unsigned int y;
+    };
+
+    /**
+     * \brief Create a packer.
+     * \param pageSize The maximum width and height of the pages.
+     * \param padding The number of pixels kept around each rectangle.
+     */
+    TextureAtlasPacker(unsigned int pageSize = 2048, unsigned int padding = 2);
+    virtual ~TextureAtlasPacker() {};
+
+    /**
+     * \brief Add a rectangle to be packed.
+     * \return The index of the rectangle, to be used with GetPlacement.
+     */
+    unsigned int AddRectangle(unsigned int width, unsigned int height);
+
+    /**
+     * \brief Compute the placement of all the rectangles added.
+     */
+    void Pack();
+
+    /**
+     * \brief Return the placement of a rectangle, computed by Pack.
+     */
+    const Placement & GetPlacement(unsigned int index) const { return placements[index]; };
+
+    /**
+     * \brief Return the number of pages used by the rectangles.
+     */
+    unsigned int GetPagesCount() const { return pages.size(); };
+
+    /**
+     * \brief Return the width actually used by the rectangles ( and their padding ) in the page.
+     */
+    unsigned int GetPageWidth(unsigned int page) const { return pages[page].usedWidth; };
+
+    /**
+     * \brief Return the height actually used by the rectangles ( and their padding ) in the page.
+     */
+    unsigned int GetPageHeight(unsigned int page) const { return pages[page].usedHeight; };
+
+private:
+    /**
+     * \brief A segment of the skyline: the top of the rectangles already placed in a page.
+     */
+    struct SkylineNode
+    {
+        SkylineNode(unsigned int x_, unsigned int y_, unsigned int width_) : x(x_), y(y_), width(width_) {};
+
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+    };
+
+    struct Page
+    {
+        Page(unsigned int size) : usedWidth(0), usedHeight(0) { skyline.push_back(SkylineNode(0, 0, size)); };
+
+        std::vector<SkylineNode> skyline;
+        unsigned int usedWidth;
+        unsigned int usedHeight;
+    };
+
+    /**
+     * \brief Find the lowest position where a rectangle fits in the page.
+     * \return false if the rectangle does not fit in the page.
+     */
+    bool FindPosition(const Page & page, unsigned int width, unsigned int height,
+        unsigned int & nodeIndex, unsigned int & x, unsigned int & y) const;
+
+    /**
+     * \brief Update the skyline of the page after a rectangle was placed on the node.
+     */
+    void PlaceRectangle(Page & page, unsigned int nodeIndex, unsigned int x, unsigned int y,
+        unsigned int width, unsigned int height);
+
+    unsigned int pageSize;
+    unsigned int padding;
+    std::vector< std::pair<unsigned int, unsigned int> > rectangles; ///< The width and height of each rectangle.
+    std::vector<Placement> placements;
+    std::vector<Page> pages;
+};
+
+}
+#endif // TEXTUREATLASPACKER_H
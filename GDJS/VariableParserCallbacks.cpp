@@ -17,6 +17,7 @@
 #include "GDCore/Events/EventsCodeGenerationContext.h"
 #include "GDCore/CommonTools.h"
 #include "GDJS/VariableParserCallbacks.h"
+#include "GDJS/EventsCodeGenerator.h"
 
 using namespace std;
 
@@ -75,6 +76,13 @@ void VariableCodeGenerationCallbacks::OnRootVariable(std::string variableName)
 	            	codeGenerator.GetObjectListName(realObjects[i], context)+"[0].getVariables())";
 	    }
 
+	    //Getting the variables of an object which is not the current object has no side effect:
+	    //it can be done only once by the instruction.
+	    gdjs::EventsCodeGenerator * jsCodeGenerator = dynamic_cast<gdjs::EventsCodeGenerator*>(&codeGenerator);
+	    if ( jsCodeGenerator && !realObjects.empty() && gdjs::EventsCodeGenerator::IsPureObjectFunction("getVariables")
+	         && output.find("[i].getVariables()") == std::string::npos )
+	        jsCodeGenerator->AddCachableExpression(output);
+
 	    if ( codeGenerator.GetLayout().HasObjectNamed(object) ) //We check first layout's objects' list.
 	        variables = &codeGenerator.GetLayout().GetObject(object).GetVariables();
 	    else if ( codeGenerator.GetProject().HasObjectNamed(object) ) //Then the global objects list.
@@ -0,0 +1,474 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <cctype>
+#include <ctime>
+#if !defined(GD_NO_WX_GUI)
+#include <wx/thread.h>
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+#endif
+#include "GDJS/ZipPackager.h"
+
+namespace gdjs
+{
+
+/**
+ * \brief A file to be written in the archive.
+ */
+struct ZipPackagerEntry
+{
+    ZipPackagerEntry(const std::string & file_, const std::string & name_) :
+        file(file_), name(name_), ready(false), failed(false), inMemory(false), crc(0), uncompressedSize(0), method(0) {};
+
+    std::string file;
+    std::string name;
+    bool ready; ///< True when the entry can be written. Protected by the mutex of the jobs if the entry is compressed by a worker.
+    bool failed; ///< True if the file could not be read.
+    bool inMemory; ///< True if the file was read ( and compressed ) by CompressEntry.
+    unsigned long crc;
+    unsigned long uncompressedSize;
+    unsigned short method; ///< 0 for stored data, 8 for deflated data.
+    std::string data; ///< The compressed data, if the entry was compressed by a worker.
+};
+
+static unsigned long crcTable[256];
+
+static void BuildCrcTable()
+{
+    if ( crcTable[1] != 0 ) return;
+
+    for (unsigned long i = 0;i<256;++i)
+    {
+        unsigned long c = i;
+        for (unsigned int k = 0;k<8;++k)
+            c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+
+        crcTable[i] = c;
+    }
+}
+
+/**
+ * \brief Update the CRC-32 of some data ( starting with a crc of 0 ).
+ */
+static unsigned long UpdateCrc(unsigned long crc, const char * data, size_t size)
+{
+    unsigned long c = crc ^ 0xFFFFFFFFUL;
+    for (size_t i = 0;i<size;++i)
+        c = crcTable[(c ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (c >> 8);
+
+    return (c ^ 0xFFFFFFFFUL) & 0xFFFFFFFFUL;
+}
+
+#if !defined(GD_NO_WX_GUI)
+/**
+ * \brief The state shared by the workers of a ZipPackager.
+ */
+struct ZipPackagerJobs
+{
+    ZipPackagerJobs() : jobAdded(mutex), jobDone(mutex), stopping(false) {};
+
+    wxMutex mutex; ///< Protects queue, stopping and the ready member of the entries compressed by the workers.
+    wxCondition jobAdded; ///< Signaled when an entry is added to the queue, or when the workers must stop.
+    wxCondition jobDone; ///< Broadcasted when an entry is compressed.
+    std::deque<ZipPackagerEntry*> queue; ///< The entries to be compressed.
+    bool stopping; ///< True when the workers must stop once the queue is empty.
+};
+
+/**
+ * \brief A thread compressing the entries of a ZipPackager, until it is stopped.
+ */
+class ZipPackagerWorker : public wxThread
+{
+public:
+    ZipPackagerWorker(ZipPackagerJobs & jobs_) : wxThread(wxTHREAD_JOINABLE), jobs(jobs_) {};
+    virtual ~ZipPackagerWorker() {};
+
+    virtual ExitCode Entry()
+    {
+        while ( true )
+        {
+            ZipPackagerEntry * entry = NULL;
+            {
+                wxMutexLocker lock(jobs.mutex);
+                while ( jobs.queue.empty() && !jobs.stopping ) jobs.jobAdded.Wait();
+                if ( jobs.queue.empty() ) break;
+
+                entry = jobs.queue.front();
+                jobs.queue.pop_front();
+            }
+
+            ZipPackager::CompressEntry(*entry);
+            {
+                wxMutexLocker lock(jobs.mutex);
+                entry->ready = true;
+                jobs.jobDone.Broadcast();
+            }
+        }
+
+        return 0;
+    }
+
+private:
+    ZipPackagerJobs & jobs;
+};
+#else
+struct ZipPackagerJobs {};
+class ZipPackagerWorker {};
+#endif
+
+ZipPackager::ZipPackager(unsigned int workersCount_) :
+    file(NULL),
+    offset(0),
+    dosTime(0),
+    dosDate(0),
+    error(false),
+    workersCount(workersCount_),
+    jobs(NULL)
+{
+    BuildCrcTable(); //Built now, before any worker can use it.
+}
+
+ZipPackager::~ZipPackager()
+{
+    if ( file ) Close();
+
+    StopWorkers();
+    for (unsigned int i = 0;i<pendingEntries.size();++i)
+        delete pendingEntries[i];
+}
+
+bool ZipPackager::ShouldBeCompressed(const std::string & filename)
+{
+    size_t dot = filename.find_last_of('.');
+    if ( dot == std::string::npos ) return true;
+
+    std::string extension = filename.substr(dot+1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    static const char * compressedExtensions[] = {"png", "jpg", "jpeg", "gif", "webp", "ogg", "mp3", "m4a", "aac",
+        "mp4", "webm", "zip", "gz", "br", "woff", "woff2"};
+    for (unsigned int i = 0;i<sizeof(compressedExtensions)/sizeof(compressedExtensions[0]);++i)
+    {
+        if ( extension == compressedExtensions[i] ) return false;
+    }
+
+    return true;
+}
+
+bool ZipPackager::Open(const std::string & zipFile)
+{
+    if ( file ) Close();
+
+    file = fopen(zipFile.c_str(), "wb");
+    offset = 0;
+    error = file == NULL;
+    names.clear();
+    writtenEntries.clear();
+    failedFiles.clear();
+
+    //All the entries have the date of the creation of the archive.
+    time_t now = time(NULL);
+    struct tm * date = localtime(&now);
+    if ( date )
+    {
+        dosTime = (date->tm_hour << 11) | (date->tm_min << 5) | (date->tm_sec / 2);
+        dosDate = (std::max(date->tm_year - 80, 0) << 9) | ((date->tm_mon + 1) << 5) | date->tm_mday;
+    }
+
+    return file != NULL;
+}
+
+void ZipPackager::AddFile(const std::string & filename, const std::string & nameInArchive)
+{
+    if ( !file || !names.insert(nameInArchive).second ) return;
+
+    ZipPackagerEntry * entry = new ZipPackagerEntry(filename, nameInArchive);
+    pendingEntries.push_back(entry);
+
+    #if !defined(GD_NO_WX_GUI)
+    if ( ShouldBeCompressed(nameInArchive) )
+    {
+        if ( !jobs ) StartWorkers();
+        if ( jobs )
+        {
+            wxMutexLocker lock(jobs->mutex);
+            jobs->queue.push_back(entry);
+            jobs->jobAdded.Signal();
+        }
+        else //No threads available: compressed now.
+        {
+            CompressEntry(*entry);
+            entry->ready = true;
+        }
+    }
+    else
+        entry->ready = true; //Stored: written by this thread, directly from the file.
+    #else
+    entry->ready = true;
+    #endif
+
+    WritePendingEntries(false);
+}
+
+void ZipPackager::StartWorkers()
+{
+    #if !defined(GD_NO_WX_GUI)
+    if ( jobs || workersCount == 0 ) return;
+
+    jobs = new ZipPackagerJobs;
+    for (unsigned int i = 0;i<workersCount;++i)
+    {
+        ZipPackagerWorker * worker = new ZipPackagerWorker(*jobs);
+        if ( worker->Run() == wxTHREAD_NO_ERROR )
+            workers.push_back(worker);
+        else
+            delete worker;
+    }
+
+    if ( workers.empty() )
+    {
+        delete jobs;
+        jobs = NULL;
+        workersCount = 0; //Don't try again.
+    }
+    #endif
+}
+
+void ZipPackager::StopWorkers()
+{
+    #if !defined(GD_NO_WX_GUI)
+    if ( !jobs ) return;
+
+    {
+        wxMutexLocker lock(jobs->mutex);
+        jobs->stopping = true;
+        jobs->jobAdded.Broadcast();
+    }
+    for (unsigned int i = 0;i<workers.size();++i)
+    {
+        workers[i]->Wait();
+        delete workers[i];
+    }
+    workers.clear();
+
+    delete jobs;
+    jobs = NULL;
+    #endif
+}
+
+void ZipPackager::CompressEntry(ZipPackagerEntry & entry)
+{
+    #if !defined(GD_NO_WX_GUI)
+    std::ifstream input(entry.file.c_str(), std::ios::in | std::ios::binary);
+    if ( !input.is_open() )
+    {
+        entry.failed = true;
+        return;
+    }
+
+    std::string content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    entry.crc = UpdateCrc(0, content.c_str(), content.size());
+    entry.uncompressedSize = content.size();
+
+    wxMemoryOutputStream memoryStream;
+    {
+        wxZlibOutputStream zlibStream(memoryStream, -1, wxZLIB_NO_HEADER); //Raw deflate, as required by the zip format.
+        zlibStream.Write(content.c_str(), content.size());
+        zlibStream.Close();
+    }
+
+    size_t compressedSize = memoryStream.GetSize();
+    if ( compressedSize < content.size() )
+    {
+        entry.data.resize(compressedSize);
+        memoryStream.CopyTo(&entry.data[0], compressedSize);
+        entry.method = 8;
+    }
+    else //Compression is useless for this file.
+    {
+        entry.data.swap(content);
+        entry.method = 0;
+    }
+    entry.inMemory = true;
+    #endif
+}
+
+void ZipPackager::WritePendingEntries(bool wait)
+{
+    while ( !pendingEntries.empty() )
+    {
+        ZipPackagerEntry * entry = pendingEntries.front();
+
+        #if !defined(GD_NO_WX_GUI)
+        if ( jobs )
+        {
+            wxMutexLocker lock(jobs->mutex);
+            while ( !entry->ready && wait ) jobs->jobDone.Wait();
+            if ( !entry->ready ) return;
+        }
+        #endif
+
+        pendingEntries.pop_front();
+        WriteEntry(*entry);
+        delete entry;
+    }
+}
+
+void ZipPackager::WriteEntry(ZipPackagerEntry & entry)
+{
+    WrittenEntry writtenEntry;
+    writtenEntry.name = entry.name;
+    writtenEntry.offset = offset;
+
+    if ( entry.failed )
+    {
+        failedFiles.push_back(entry.file);
+        return;
+    }
+
+    if ( entry.inMemory )
+    {
+        writtenEntry.crc = entry.crc;
+        writtenEntry.compressedSize = entry.data.size();
+        writtenEntry.uncompressedSize = entry.uncompressedSize;
+        writtenEntry.method = entry.method;
+
+        WriteLocalHeader(writtenEntry);
+        Write(entry.data.c_str(), entry.data.size());
+        std::string().swap(entry.data);
+    }
+    else //Stored: the file is copied to the archive without being read entirely in memory.
+    {
+        FILE * input = fopen(entry.file.c_str(), "rb");
+        if ( !input )
+        {
+            failedFiles.push_back(entry.file);
+            return;
+        }
+
+        writtenEntry.crc = 0;
+        writtenEntry.compressedSize = 0;
+        writtenEntry.uncompressedSize = 0;
+        writtenEntry.method = 0;
+        WriteLocalHeader(writtenEntry);
+
+        std::vector<char> buffer(64*1024);
+        size_t read = 0;
+        while ( (read = fread(&buffer[0], 1, buffer.size(), input)) > 0 )
+        {
+            writtenEntry.crc = UpdateCrc(writtenEntry.crc, &buffer[0], read);
+            writtenEntry.uncompressedSize += read;
+            Write(&buffer[0], read);
+        }
+        if ( ferror(input) ) error = true;
+        fclose(input);
+        writtenEntry.compressedSize = writtenEntry.uncompressedSize;
+
+        //Now that the size and the CRC are known, update the local header.
+        unsigned long endOffset = offset;
+        if ( fseek(file, writtenEntry.offset+14, SEEK_SET) != 0 ) error = true;
+        Write32(writtenEntry.crc);
+        Write32(writtenEntry.compressedSize);
+        Write32(writtenEntry.uncompressedSize);
+        if ( fseek(file, 0, SEEK_END) != 0 ) error = true;
+        offset = endOffset;
+    }
+
+    writtenEntries.push_back(writtenEntry);
+}
+
+void ZipPackager::WriteLocalHeader(const WrittenEntry & entry)
+{
+    Write32(0x04034b50UL);
+    Write16(20); //Version needed to extract
+    Write16(0x0800); //Flags: names are encoded in UTF-8
+    Write16(entry.method);
+    Write16(dosTime);
+    Write16(dosDate);
+    Write32(entry.crc);
+    Write32(entry.compressedSize);
+    Write32(entry.uncompressedSize);
+    Write16(entry.name.size());
+    Write16(0); //Extra field length
+    Write(entry.name.c_str(), entry.name.size());
+}
+
+bool ZipPackager::Close()
+{
+    if ( !file ) return false;
+
+    WritePendingEntries(true);
+    StopWorkers();
+
+    //Central directory
+    unsigned long centralDirectoryOffset = offset;
+    for (unsigned int i = 0;i<writtenEntries.size();++i)
+    {
+        const WrittenEntry & entry = writtenEntries[i];
+        Write32(0x02014b50UL);
+        Write16(20); //Version made by
+        Write16(20); //Version needed to extract
+        Write16(0x0800);
+        Write16(entry.method);
+        Write16(dosTime);
+        Write16(dosDate);
+        Write32(entry.crc);
+        Write32(entry.compressedSize);
+        Write32(entry.uncompressedSize);
+        Write16(entry.name.size());
+        Write16(0); //Extra field length
+        Write16(0); //Comment length
+        Write16(0); //Disk number
+        Write16(0); //Internal attributes
+        Write32(0); //External attributes
+        Write32(entry.offset);
+        Write(entry.name.c_str(), entry.name.size());
+    }
+    unsigned long centralDirectorySize = offset-centralDirectoryOffset;
+
+    //End of central directory
+    Write32(0x06054b50UL);
+    Write16(0);
+    Write16(0);
+    Write16(writtenEntries.size());
+    Write16(writtenEntries.size());
+    Write32(centralDirectorySize);
+    Write32(centralDirectoryOffset);
+    Write16(0);
+
+    if ( fclose(file) != 0 ) error = true;
+    file = NULL;
+
+    //The zip format used is limited to 65535 entries.
+    if ( writtenEntries.size() > 0xFFFF ) error = true;
+
+    return !error && failedFiles.empty();
+}
+
+void ZipPackager::Write(const void * data, size_t size)
+{
+    if ( size == 0 ) return;
+    if ( fwrite(data, 1, size, file) != size ) error = true;
+    offset += size;
+}
+
+void ZipPackager::Write16(unsigned int value)
+{
+    unsigned char bytes[2] = { static_cast<unsigned char>(value & 0xFF), static_cast<unsigned char>((value >> 8) & 0xFF) };
+    Write(bytes, 2);
+}
+
+void ZipPackager::Write32(unsigned long value)
+{
+    unsigned char bytes[4] = { static_cast<unsigned char>(value & 0xFF), static_cast<unsigned char>((value >> 8) & 0xFF),
+        static_cast<unsigned char>((value >> 16) & 0xFF), static_cast<unsigned char>((value >> 24) & 0xFF) };
+    Write(bytes, 4);
+}
+
+}
@@ -0,0 +1,134 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+#ifndef ZIPPACKAGER_H
+#define ZIPPACKAGER_H
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <cstdio>
+
+namespace gdjs
+{
+
+struct ZipPackagerEntry;
+struct ZipPackagerJobs;
+class ZipPackagerWorker;
+
+/**
+ * \brief Create a zip file, adding the files to the archive while the other files are still being exported.
+ *
+ * Files already compressed ( images, sounds, fonts... ) are stored as is, as compressing them again
+ * would take time without saving space. The other files are compressed by a pool of worker threads,
+ * while the stored files are written by the calling thread. Entries are written in the order they
+ * were added.<br>
+ * When wxWidgets is not available, the files are stored without compression.
+ *
+ * Usage example:
+ * \code
+ * ZipPackager packager;
+ * if ( !packager.Open(zipFile) ) return false;
+ * packager.AddFile(exportDir+"/index.html", "index.html");
+ * //...Export the other files and add them...
+ * return packager.Close();
+ * \endcode
+ */
+class ZipPackager
+{
+public:
+    /**
+     * \brief Create a packager.
+     * \param workersCount The maximum number of files compressed at the same time.
+     */
+    ZipPackager(unsigned int workersCount = 4);
+    virtual ~ZipPackager();
+
+    /**
+     * \brief Create the zip file. The file is overwritten if it exists.
+     * \return true if the file was created.
+     */
+    bool Open(const std::string & zipFile);
+
+    /**
+     * \brief Add a file to the archive. Nothing is done if a file was already added with the same name.
+     * \param file The file to be added.
+     * \param nameInArchive The name of the file in the archive ( using "/" as separator ), encoded in UTF-8.
+     */
+    void AddFile(const std::string & file, const std::string & nameInArchive);
+
+    /**
+     * \brief Return true if a file was already added with this name.
+     */
+    bool HasFile(const std::string & nameInArchive) const { return names.find(nameInArchive) != names.end(); };
+
+    /**
+     * \brief Wait for the files to be compressed, and write the end of the archive.
+     * \return true if the archive was successfully written, with all the files.
+     */
+    bool Close();
+
+    /**
+     * \brief Return the files that could not be added to the archive.
+     */
+    const std::vector<std::string> & GetFailedFiles() const { return failedFiles; };
+
+    /**
+     * \brief Return true if the file should be compressed, false if its content is already compressed.
+     */
+    static bool ShouldBeCompressed(const std::string & filename);
+
+private:
+    friend class ZipPackagerWorker;
+
+    /**
+     * \brief Information about the entries already written, for the central directory of the archive.
+     */
+    struct WrittenEntry
+    {
+        std::string name;
+        unsigned long crc;
+        unsigned long compressedSize;
+        unsigned long uncompressedSize;
+        unsigned short method;
+        unsigned long offset; ///< The offset of the local header of the entry in the archive.
+    };
+
+    /**
+     * \brief Compress the content of the entry file, storing the result in the entry.
+     * Called by the worker threads.
+     */
+    static void CompressEntry(ZipPackagerEntry & entry);
+
+    /**
+     * \brief Write the entries which are ready, in the order they were added.
+     * \param wait If true, wait for all the entries to be ready.
+     */
+    void WritePendingEntries(bool wait);
+    void WriteEntry(ZipPackagerEntry & entry);
+    void WriteLocalHeader(const WrittenEntry & entry);
+    void StartWorkers();
+    void StopWorkers();
+
+    void Write(const void * data, size_t size);
+    void Write16(unsigned int value);
+    void Write32(unsigned long value);
+
+    FILE * file;
+    unsigned long offset; ///< The current size of the archive.
+    unsigned short dosTime;
+    unsigned short dosDate;
+    bool error; ///< True if an error happened while writing the archive.
+    unsigned int workersCount;
+    std::set<std::string> names; ///< The names of the files added.
+    std::deque<ZipPackagerEntry*> pendingEntries; ///< The entries not written yet, in the order they were added.
+    std::vector<WrittenEntry> writtenEntries;
+    std::vector<std::string> failedFiles;
+    ZipPackagerJobs * jobs; ///< The state shared with the workers ( NULL if the workers are not started ).
+    std::vector<ZipPackagerWorker*> workers;
+};
+
+}
+#endif // ZIPPACKAGER_H
@@ -81,3 +81,20 @@ gdjs.EventsContext.prototype.addObjectsToEventsMap = function(name, objectList)
 gdjs.EventsContext.prototype.getEventsObjectsMap = function() {
     return this._eventsObjectsMap.clone();
 };
+
+/**
+ * Called by the code generated for a While event when the loop was stopped
+ * because it reached its maximum number of iterations (see gdjs::Exporter::SetWhileIterationsLimit).<br>
+ * By default, a warning is logged: replace this function to be notified by another mean.
+ *
+ * @method onWhileIterationsLimitReached
+ * @static
+ * @param runtimeScene The scene being played
+ * @param eventId {String} The identifier of the While event that was stopped: the name of the scene ( or of the
+ * external events ) and the position of the event ( "Level/3.2" is the second sub event of the third event ).
+ * @param limit {Number} The maximum number of iterations that was reached.
+ */
+gdjs.EventsContext.onWhileIterationsLimitReached = function(runtimeScene, eventId, limit) {
+    console.warn("A While event ("+eventId+") was stopped after "+limit+" iterations in scene \""+
+        runtimeScene.getName()+"\".");
+};
@@ -13,7 +13,8 @@ var gdjs = gdjs || {
     evtTools:{},
     callbacksRuntimeSceneLoaded: [],
     callbacksRuntimeSceneUnloaded: [],
-    callbacksObjectDeletedFromScene: []
+    callbacksObjectDeletedFromScene: [],
+    loadedScenesData: {}
 };
 
 /**
@@ -101,6 +102,18 @@ gdjs.iterateOverArray = function(array, func) {
     }
 };
 
+/**
+ * Register the data of a scene which was exported in its own file.<br>
+ * Called by these files when they are loaded ( see gdjs.RuntimeGame.loadSceneData ).
+ *
+ * @method registerSceneData
+ * @static
+ * @param sceneData The data of the scene.
+ */
+gdjs.registerSceneData = function(sceneData) {
+    gdjs.loadedScenesData[sceneData.name] = sceneData;
+};
+
 /**
  * Register the runtime objects that can be used in runtimeScene.<br>
  * Objects must be part of gdjs and have their property "thisIsARuntimeObjectConstructor"
@@ -21,7 +21,9 @@ gdjs.ImageManager = function(runtimeGame)
 
 /**
  * Return the PIXI texture associated to the specified name.
- * Returns a placeholder texture if not found.
+ * Returns a placeholder texture if not found.<br>
+ * If the image was packed in a texture atlas by the exporter, the texture is the
+ * part of the atlas page where the image is.
  * @param name The name of the texture to get.
  * @method getPIXITexture
  */
@@ -33,23 +35,18 @@ gdjs.ImageManager.prototype.getPIXITexture = function(name) {
 		return this._invalidTexture;
 	}
 
-	var resources = this._game.getGameData().resources.resources;
-	if ( resources ) {
-		var texture = null;
-		gdjs.iterateOverArray(resources, function(res) {
-			if ( res.name === name &&
-				res.kind === "image" ) {
-
-				texture = PIXI.Texture.fromImage(res.file);
-				return false;
-			}
-		});
-
-		if ( texture !== null ) {
-			//console.log("Loaded texture \""+name+"\".");
-			this._loadedTextures.put(name, texture);
-			return texture;
+	var res = this._game.getResourceData(name);
+	if ( res !== null && res.kind === "image" ) {
+		var texture = PIXI.Texture.fromImage(res.file);
+		if ( res.atlasFrame ) {
+			var frame = res.atlasFrame;
+			texture = new PIXI.Texture(texture.baseTexture,
+				new PIXI.Rectangle(frame.x, frame.y, frame.width, frame.height));
 		}
+
+		//console.log("Loaded texture \""+name+"\".");
+		this._loadedTextures.put(name, texture);
+		return texture;
 	}
 
 	console.warn("Unable to find texture \""+name+"\".");
@@ -11,7 +11,7 @@
  * @namespace gdjs
  * @class RuntimeGame
  * @param data The object (usually stored in data.json) containing the full project data
- * @param spec Optional object for specifiying additional options: {forceFullscreen: ...}
+ * @param spec Optional object for specifiying additional options: {forceFullscreen: ..., prefetchScenesData: ..., prefetchScenesAssets: ...}
  */
 gdjs.RuntimeGame = function(data, spec)
 {
@@ -27,8 +27,14 @@ gdjs.RuntimeGame = function(data, spec)
 
     this._variables = new gdjs.VariablesContainer(data.variables);
     this._data = data;
+    this._indices = data && data.indices ? data.indices : {}; //The tables associating names to indices ( see _indexOf ).
     this._imageManager = new gdjs.ImageManager(this);
     this._minFPS = data ? parseInt(data.properties.minFPS, 10) : 15;
+    this._scenesDataLoading = {}; //The callbacks to call when the data of the scenes being loaded are available.
+    this._prefetchScenesData = spec.prefetchScenesData || false; //If true, the data of all scenes is loaded in background.
+    this._prefetchScenesAssets = spec.prefetchScenesAssets || false; //If true, the assets of all scenes are loaded in background.
+    this._loadedAssets = {}; //The files of the assets already loaded.
+    this._assetsLoading = {}; //The callbacks to call when the files of the assets being loaded are available.
 
     //Game loop management (see startStandardGameLoop method)
     this._notifySceneForResize = false; //When set to true, the current scene is notified that canvas size changed.
@@ -86,25 +92,229 @@ gdjs.RuntimeGame.prototype.getGameData = function() {
 };
 
 /**
- * Get the data associated to a scene.
+ * Get the data associated to a scene.<br>
+ * The data of a scene exported in its own file only contains the name of the scene
+ * and the file to load until the file is loaded ( see loadSceneData ).
  *
  * @method getSceneData
  * @param sceneName The name of the scene. If not defined, the first scene will be returned.
  * @return The data associated to the scene.
  */
 gdjs.RuntimeGame.prototype.getSceneData = function(sceneName) {
-	var scene = undefined;
-	gdjs.iterateOverArray(this._data.layouts, function(sceneData) {
-		if ( sceneName === undefined || sceneData.name === sceneName ) {
-			scene = sceneData;
-			return false;
+	var layouts = this._data.layouts;
+	var i = sceneName === undefined ? (layouts.length !== 0 ? 0 : -1) : this._indexOf("layouts", layouts, sceneName);
+	if ( i === -1 ) {
+		console.warn("The game has no scene called \""+sceneName+"\"");
+		return undefined;
+	}
+
+	//Replace the data of the scene by the full data, if its file was loaded.
+	if ( layouts[i].dataFile !== undefined && gdjs.loadedScenesData.hasOwnProperty(layouts[i].name) ) {
+		layouts[i] = gdjs.loadedScenesData[layouts[i].name];
+		delete gdjs.loadedScenesData[layouts[i].name];
+	}
+
+	return layouts[i];
+};
+
+/**
+ * Return the index of the element having the specified name in an array of the game data
+ * ( the layouts, the external layouts or the resources ).<br>
+ * The exporter writes the tables associating the names to the indices ( "indices" in the game data ),
+ * so that elements are found without searching them. If a table is missing, it is built the first time
+ * it is needed.
+ *
+ * @method _indexOf
+ * @private
+ * @param kind The name of the table ( "layouts", "externalLayouts" or "resources" ).
+ * @param array The array of the game data.
+ * @param name The name of the element to find.
+ * @return The index of the element, or -1 if not found.
+ */
+gdjs.RuntimeGame.prototype._indexOf = function(kind, array, name) {
+	var indices = this._indices[kind];
+	var index = indices !== undefined && indices.hasOwnProperty(name) ? indices[name] : -1;
+	if ( indices === undefined || (index !== -1 && (array[index] === undefined || array[index].name !== name)) ) {
+		//No table, or a table not matching the data: ( re )build it. The first element with a name is the one found.
+		indices = this._indices[kind] = {};
+		for(var i = array.length-1;i>=0;--i) indices[array[i].name] = i;
+
+		index = indices.hasOwnProperty(name) ? indices[name] : -1;
+	}
+
+	return index;
+};
+
+/**
+ * Load the data of a scene, if the scene was exported in its own file, and call the
+ * callback with the data of the scene.<br>
+ * If the data is already loaded, or if its file could not be loaded before, the callback is called immediately.
+ *
+ * @method loadSceneData
+ * @param sceneName The name of the scene. If not defined, the first scene is loaded.
+ * @param callback Optional function called with the data of the scene ( or undefined if it
+ * could not be loaded ).
+ */
+gdjs.RuntimeGame.prototype.loadSceneData = function(sceneName, callback) {
+	var sceneData = this.getSceneData(sceneName);
+	if ( sceneData === undefined || sceneData.dataFile === undefined ) {
+		if ( callback ) callback(sceneData);
+		return;
+	}
+	if ( sceneData.loadingFailed ) {
+		if ( callback ) callback(undefined);
+		return;
+	}
+
+	//Don't load the file again if it is already being loaded.
+	var callbacks = this._scenesDataLoading[sceneData.name];
+	if ( callbacks !== undefined ) {
+		if ( callback ) callbacks.push(callback);
+		return;
+	}
+	callbacks = this._scenesDataLoading[sceneData.name] = callback ? [callback] : [];
+
+	var game = this;
+	var script = document.createElement("script");
+	script.onload = script.onerror = function() {
+		delete game._scenesDataLoading[sceneData.name];
+
+		var loadedData = game.getSceneData(sceneData.name);
+		if ( loadedData.dataFile !== undefined ) {
+			console.error("Unable to load the data of the scene \""+sceneData.name+"\" from "+sceneData.dataFile);
+			sceneData.loadingFailed = true; //Don't try to prefetch it again.
+			loadedData = undefined;
 		}
-	});
 
-	if ( scene === undefined )
-		console.warn("The game has no scene called \""+sceneName+"\"");
+		for(var i = 0;i<callbacks.length;++i) callbacks[i](loadedData);
+	};
+	script.src = sceneData.dataFile;
+	document.getElementsByTagName("head")[0].appendChild(script);
+};
 
-	return scene;
+/**
+ * Load, one after the other, the data of all the scenes exported in their own files
+ * and not loaded yet.
+ *
+ * @method prefetchScenesData
+ */
+gdjs.RuntimeGame.prototype.prefetchScenesData = function() {
+	var game = this;
+	var layouts = this._data.layouts;
+	for(var i = 0, len = layouts.length;i<len;++i) {
+		if ( layouts[i].dataFile !== undefined && !layouts[i].loadingFailed &&
+			this._scenesDataLoading[layouts[i].name] === undefined ) {
+			this.loadSceneData(layouts[i].name, function() { game.prefetchScenesData(); });
+			return;
+		}
+	}
+};
+
+/**
+ * Return the files of the assets used by a scene which are not loaded yet.<br>
+ * If the exporter did not list the resources used by the scene, the files of all the
+ * resources of the game are returned.
+ *
+ * @method _getSceneAssets
+ * @private
+ * @param sceneData The data of the scene.
+ * @return {Array} The files to be loaded.
+ */
+gdjs.RuntimeGame.prototype._getSceneAssets = function(sceneData) {
+	//Files are loaded once, even if used by several resources ( like texture atlases pages ).
+	var assets = [];
+	var assetsAdded = {};
+	var loadedAssets = this._loadedAssets;
+	function addAsset(res) {
+		if ( !res.file || assetsAdded.hasOwnProperty(res.file) || loadedAssets.hasOwnProperty(res.file) ) return;
+
+		assets.push(res.file);
+		assetsAdded[res.file] = true;
+	}
+
+	var resources = this._data.resources.resources;
+	if ( sceneData.usedResources !== undefined ) {
+		for(var i = 0, len = sceneData.usedResources.length;i<len;++i) {
+			var index = this._indexOf("resources", resources, sceneData.usedResources[i].name);
+			if ( index !== -1 ) addAsset(resources[index]);
+		}
+	}
+	else {
+		for(var i = 0, len = resources.length;i<len;++i)
+			addAsset(resources[i]);
+	}
+
+	return assets;
+};
+
+/**
+ * Load the assets used by a scene, and call the callback when they are all loaded.<br>
+ * If they are already loaded, the callback is called immediately.
+ *
+ * @method loadSceneAssets
+ * @param sceneName The name of the scene. If not defined, the assets of the first scene are loaded.
+ * @param callback Optional function called when the assets are loaded.
+ * @param onProgress Optional function called, with the number of files loaded and the number
+ * of files to load, each time a file is loaded.
+ */
+gdjs.RuntimeGame.prototype.loadSceneAssets = function(sceneName, callback, onProgress) {
+	var sceneData = this.getSceneData(sceneName);
+	var assets = sceneData !== undefined ? this._getSceneAssets(sceneData) : [];
+	var remainingCount = assets.length;
+	if ( remainingCount === 0 ) {
+		if ( callback ) callback();
+		return;
+	}
+
+	function onAssetLoaded() {
+		remainingCount--;
+		if ( remainingCount === 0 && callback ) callback();
+	}
+
+	//The files already being loaded ( for another scene ) are not loaded again.
+	var assetsToLoad = [];
+	for(var i = 0;i<assets.length;++i) {
+		if ( this._assetsLoading[assets[i]] === undefined ) {
+			this._assetsLoading[assets[i]] = [];
+			assetsToLoad.push(assets[i]);
+		}
+		this._assetsLoading[assets[i]].push(onAssetLoaded);
+	}
+	if ( assetsToLoad.length === 0 ) return;
+
+	var game = this;
+	var loadedCount = 0;
+	var assetLoader = new PIXI.AssetLoader(assetsToLoad);
+	assetLoader.onComplete = function() {
+		for(var i = 0;i<assetsToLoad.length;++i) {
+			var callbacks = game._assetsLoading[assetsToLoad[i]];
+			delete game._assetsLoading[assetsToLoad[i]];
+			game._loadedAssets[assetsToLoad[i]] = true;
+
+			for(var j = 0;j<callbacks.length;++j) callbacks[j]();
+		}
+	};
+	assetLoader.onProgress = function() {
+		loadedCount++;
+		if ( onProgress ) onProgress(loadedCount, assetsToLoad.length);
+	};
+	assetLoader.load();
+};
+
+/**
+ * Load, one after the other, the assets of all the scenes which are not loaded yet.
+ *
+ * @method prefetchScenesAssets
+ */
+gdjs.RuntimeGame.prototype.prefetchScenesAssets = function() {
+	var game = this;
+	var layouts = this._data.layouts;
+	for(var i = 0, len = layouts.length;i<len;++i) {
+		if ( this._getSceneAssets(layouts[i]).length !== 0 ) {
+			this.loadSceneAssets(layouts[i].name, function() { game.prefetchScenesAssets(); });
+			return;
+		}
+	}
 };
 
 /**
@@ -115,15 +325,9 @@ gdjs.RuntimeGame.prototype.getSceneData = function(sceneName) {
  * @return true if the scene exists. If sceneName is undefined, true if the game has a scene.
  */
 gdjs.RuntimeGame.prototype.hasScene = function(sceneName) {
-	var isTrue = false;
-	gdjs.iterateOverArray(this._data.layouts, function(sceneData) {
-		if ( sceneName === undefined || sceneData.name == sceneName ) {
-			isTrue = true;
-			return false;
-		}
-	});
+	if ( sceneName === undefined ) return this._data.layouts.length !== 0;
 
-	return isTrue;
+	return this._indexOf("layouts", this._data.layouts, sceneName) !== -1;
 };
 
 /**
@@ -134,15 +338,23 @@ gdjs.RuntimeGame.prototype.hasScene = function(sceneName) {
  * @return The data associated to the external layout or null if not found.
  */
 gdjs.RuntimeGame.prototype.getExternalLayoutData = function(name) {
-    var externalLayout = null;
-    gdjs.iterateOverArray(this._data.externalLayouts, function(layoutData) {
-        if ( layoutData.name === name ) {
-            externalLayout = layoutData;
-            return false;
-        }
-    });
+    var index = this._indexOf("externalLayouts", this._data.externalLayouts, name);
+    return index !== -1 ? this._data.externalLayouts[index] : null;
+};
+
+/**
+ * Get the data associated to a resource.
+ *
+ * @method getResourceData
+ * @param name The name of the resource.
+ * @return The data associated to the resource or null if not found.
+ */
+gdjs.RuntimeGame.prototype.getResourceData = function(name) {
+    var resources = this._data.resources.resources;
+    if ( !resources ) return null;
 
-    return externalLayout;
+    var index = this._indexOf("resources", resources, name);
+    return index !== -1 ? resources[index] : null;
 };
 
 /**
@@ -625,44 +837,26 @@ gdjs.RuntimeGame.prototype._resizeCanvas = function() {
 };
 
 /**
- * Load all assets, displaying progress in renderer.
+ * Load the assets of the first scene, displaying progress in renderer.<br>
+ * The assets of the other scenes are loaded when the scenes are started ( or prefetched,
+ * see prefetchScenesAssets ). If the exporter did not list the resources used by each scene,
+ * all the assets are loaded.
  * @method loadAllAssets
  */
 gdjs.RuntimeGame.prototype.loadAllAssets = function(callback) {
 
-    //Load all assets
     var loadingStage = new PIXI.Stage();
     var text = new PIXI.Text(" ", {font: "bold 60px Arial", fill: "#FFFFFF", align: "center"});
     loadingStage.addChild(text);
     text.position.x = this._renderer.width/2-50;
     text.position.y = this._renderer.height/2;
-    var loadingCount = 0;
-
-    var assets = [];
-    gdjs.iterateOverArray(gdjs.projectData.resources.resources, function(res) {
-        if ( res.file ) assets.push(res.file);
-    });
 
     var game = this;
-    if ( assets.length !== 0 ) {
-        var assetLoader = new PIXI.AssetLoader(assets);
-        assetLoader.onComplete = onAssetsLoaded;
-        assetLoader.onProgress = onAssetsLoadingProgress;
-        assetLoader.load();
-    }
-    else {
-        onAssetsLoaded();
-    }
-
-    function onAssetsLoaded() {
-        callback();
-    }
-
-    function onAssetsLoadingProgress() {
+    var firstSceneName = this._data.firstLayout;
+    this.loadSceneAssets(this.hasScene(firstSceneName) ? firstSceneName : undefined, callback, function(loadedCount, count) {
         game._renderer.render(loadingStage);
-        loadingCount++;
-        text.setText(Math.floor(loadingCount/assets.length*100) + "%");
-    }
+        text.setText(Math.floor(loadedCount/count*100) + "%");
+    });
 };
 
 /**
@@ -678,16 +872,24 @@ gdjs.RuntimeGame.prototype.startStandardGameLoop = function() {
     }
 
     //Create the scene to be played
-    var currentScene = new gdjs.RuntimeScene(this, this._renderer);
+    var game = this;
+    var currentScene = null;
     var firstSceneName = gdjs.projectData.firstLayout;
-    var firstsceneData = this.hasScene(firstSceneName) ? this.getSceneData(firstSceneName) : this.getSceneData();
+    this.loadSceneData(this.hasScene(firstSceneName) ? firstSceneName : undefined, function(firstSceneData) {
+        if ( firstSceneData === undefined ) {
+            console.error("The game can't be started: the data of its first scene could not be loaded.");
+            return;
+        }
 
-    currentScene.loadFromScene(firstsceneData);
+        currentScene = new gdjs.RuntimeScene(game, game._renderer);
+        currentScene.loadFromScene(firstSceneData);
+        if ( game._prefetchScenesData ) game.prefetchScenesData();
+        if ( game._prefetchScenesAssets ) game.prefetchScenesAssets();
 
-    requestAnimFrame(gameLoop);
+        requestAnimFrame(gameLoop);
+    });
 
     //The standard game loop
-    var game = this;
     function gameLoop() {
 
         //Manage resize events.
@@ -702,10 +904,31 @@ gdjs.RuntimeGame.prototype.startStandardGameLoop = function() {
             if ( currentScene.gameStopRequested() )
                 postGameScreen();
             else {
-                var nextSceneName = currentScene.getRequestedScene();
-                currentScene = new gdjs.RuntimeScene(game, game._renderer);
-                currentScene.loadFromScene(game.getSceneData(nextSceneName));
-                requestAnimFrame( gameLoop );
+                //The data and the assets of the next scene may have to be loaded ( at the
+                //same time ) before starting the scene.
+                var requestedScene = currentScene.getRequestedScene();
+                var nextSceneData = undefined;
+                var pendingLoadings = 2;
+                var onNextSceneLoaded = function() {
+                    pendingLoadings--;
+                    if ( pendingLoadings !== 0 ) return;
+
+                    if ( nextSceneData === undefined ) {
+                        //The data of the scene could not be loaded: stay on the current scene.
+                        console.error("Unable to change the scene to \""+requestedScene+"\": its data could not be loaded.");
+                        currentScene.requestSceneChange("");
+                    }
+                    else {
+                        currentScene = new gdjs.RuntimeScene(game, game._renderer);
+                        currentScene.loadFromScene(nextSceneData);
+                    }
+                    requestAnimFrame( gameLoop );
+                };
+                game.loadSceneData(requestedScene, function(sceneData) {
+                    nextSceneData = sceneData;
+                    onNextSceneLoaded();
+                });
+                game.loadSceneAssets(requestedScene, onNextSceneLoaded);
             }
         }
         else {
@@ -0,0 +1,57 @@
+/*
+ * Game Develop JS Platform
+ * Copyright 2008-2014 Florian Rival (Florian.Rival@gmail.com). All rights reserved.
+ * This project is released under the GNU Lesser General Public License.
+ */
+
+/*
+ * Service worker of an exported game: all the files of the game are stored in the cache of
+ * the browser when the worker is installed, and are then loaded from the cache.
+ *
+ * The list of files and the version are inserted by the exporter ( see gdjs::PrecacheManifest ).
+ * When the game is exported again, the version changes ( it is the hash of the files ) so that
+ * browsers install the new worker, which downloads the new files in a new cache.
+ *
+ * The new worker only becomes active once all the pages of the game running with the previous version are
+ * closed: these pages can still load files ( the layouts data, their resources... ) lazily, from the cache of
+ * their version. The caches of the previous versions are only removed at this moment.
+ */
+var gdjsPrecache = {}/*GDJS_PRECACHE_MANIFEST*/;
+var gdjsCacheName = "gdjs-precache-" + gdjsPrecache.version;
+
+self.addEventListener("install", function(event) {
+    event.waitUntil(caches.open(gdjsCacheName).then(function(cache) {
+        //The files are requested bypassing the HTTP cache, which could contain outdated files.
+        var requests = [];
+        for(var i = 0;i<gdjsPrecache.files.length;++i) {
+            requests.push(new Request(gdjsPrecache.files[i].url, {cache: "reload"}));
+        }
+
+        return cache.addAll(requests);
+    }));
+});
+
+self.addEventListener("activate", function(event) {
+    //Remove the caches of the previous versions of the game ( no page uses them anymore ).
+    event.waitUntil(caches.keys().then(function(cacheNames) {
+        var removals = [];
+        for(var i = 0;i<cacheNames.length;++i) {
+            if ( cacheNames[i].indexOf("gdjs-precache-") === 0 && cacheNames[i] !== gdjsCacheName )
+                removals.push(caches.delete(cacheNames[i]));
+        }
+
+        return Promise.all(removals);
+    }));
+});
+
+self.addEventListener("fetch", function(event) {
+    if ( event.request.method !== "GET" ) return;
+
+    //The game can be opened with a query string, and with or without "index.html".
+    var isPage = event.request.mode === "navigate";
+    event.respondWith(caches.open(gdjsCacheName).then(function(cache) {
+        return cache.match(isPage ? "index.html" : event.request, {ignoreSearch: true});
+    }).then(function(response) {
+        return response || fetch(event.request);
+    }));
+});
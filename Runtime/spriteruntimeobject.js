@@ -10,28 +10,45 @@
  * It contains the texture displayed as well as information like the points position
  * or the collision mask.
  *
+ * The custom hit boxes are stored in flat arrays: customHitBoxesPolygons contains, for each hit box,
+ * the index of its first vertex in customHitBoxesVertices and its number of vertices. The hit boxes of the
+ * frame are the customHitBoxesCount hit boxes starting at customHitBoxesStart.
+ *
  * @namespace gdjs
  * @class SpriteAnimationFrame
  * @constructor
+ * @param imageManager The image manager of the game.
+ * @param frameData The data of the frame.
+ * @param shapesData Optional flat arrays of the hit boxes and points of the object, shared with the
+ * other frames ( see gdjs.SpriteRuntimeObject.getShapesData ).
  */
-gdjs.SpriteAnimationFrame = function(imageManager, frameData)
+gdjs.SpriteAnimationFrame = function(imageManager, frameData, shapesData)
 {
     this.image = frameData ? frameData.image : "";
     this.pixiTexture = imageManager.getPIXITexture(this.image);
 
     if ( this.center === undefined ) this.center = { x:0, y:0 };
     if ( this.origin === undefined ) this.origin = { x:0, y:0 };
-    this.hasCustomHitBoxes = false;
-    if ( this.customHitBoxes === undefined ) this.customHitBoxes = [];
     if ( this.points === undefined ) this.points = new Hashtable();
     else this.points.clear();
 
     //Initialize points:
-    var that = this;
-    gdjs.iterateOverArray(frameData.points, function(ptData) {
-        var point = {x:parseFloat(ptData.x), y:parseFloat(ptData.y)};
-        that.points.put(ptData.name, point);
-    });
+    if ( shapesData !== undefined && frameData.pointsStart !== undefined ) {
+        //The points are only created when one is requested ( see getPoint ).
+        this._shapesData = shapesData;
+        this._pointsStart = frameData.pointsStart;
+        this._pointsCount = frameData.pointsCount;
+        this._pointsLoaded = false;
+    }
+    else {
+        var that = this;
+        gdjs.iterateOverArray(frameData.points, function(ptData) {
+            var point = {x:parseFloat(ptData.x), y:parseFloat(ptData.y)};
+            that.points.put(ptData.name, point);
+        });
+        this._shapesData = null;
+        this._pointsLoaded = true;
+    }
     var origin = frameData.originPoint;
     this.origin.x = parseFloat(origin.x);
     this.origin.y = parseFloat(origin.y);
@@ -47,36 +64,60 @@ gdjs.SpriteAnimationFrame = function(imageManager, frameData)
     }
 
     //Load the custom collision mask, if any:
-    if ( frameData.hasCustomCollisionMask ) {
-        this.hasCustomHitBoxes = true;
-        var polygonIndex = 0;
-        gdjs.iterateOverArray(frameData.customCollisionMask, function(polygonData) {
-
-            //Add a polygon, if necessary (Avoid recreating a polygon if it already exists).
-            if ( polygonIndex >= that.customHitBoxes.length ) that.customHitBoxes.push(new gdjs.Polygon());
-
-            var vertIndex = 0;
-            gdjs.iterateOverArray(polygonData, function(pointData) {
-
-                //Add a point, if necessary (Avoid recreating a point if it already exists).
-                if ( vertIndex >= that.customHitBoxes[polygonIndex].vertices.length )
-                    that.customHitBoxes[polygonIndex].vertices.push([0,0]);
-
-                that.customHitBoxes[polygonIndex].vertices[vertIndex][0] = parseFloat(pointData.x, 10);
-                that.customHitBoxes[polygonIndex].vertices[vertIndex][1] = parseFloat(pointData.y, 10);
-
-                vertIndex++;
+    this.hasCustomHitBoxes = !!frameData.hasCustomCollisionMask;
+    this.customHitBoxesStart = 0;
+    this.customHitBoxesCount = 0;
+    if ( shapesData !== undefined && frameData.hitBoxesStart !== undefined ) {
+        //The hit boxes are views over the arrays of the object, shared by all its instances.
+        this.customHitBoxesVertices = shapesData.vertices;
+        this.customHitBoxesPolygons = shapesData.polygons;
+        this.customHitBoxesStart = frameData.hitBoxesStart;
+        this.customHitBoxesCount = frameData.hitBoxesCount;
+    }
+    else {
+        //The hit boxes are copied in arrays owned by the frame (Avoid recreating them if they already exist).
+        if ( this._ownHitBoxesVertices === undefined ) {
+            this._ownHitBoxesVertices = [];
+            this._ownHitBoxesPolygons = [];
+        }
+        var vertices = this._ownHitBoxesVertices;
+        var polygons = this._ownHitBoxesPolygons;
+        var verticesCount = 0;
+        var polygonsCount = 0;
+        if ( this.hasCustomHitBoxes ) {
+            gdjs.iterateOverArray(frameData.customCollisionMask, function(polygonData) {
+                polygons[2*polygonsCount] = verticesCount;
+                gdjs.iterateOverArray(polygonData, function(pointData) {
+                    vertices[2*verticesCount] = parseFloat(pointData.x, 10);
+                    vertices[2*verticesCount+1] = parseFloat(pointData.y, 10);
+                    verticesCount++;
+                });
+                polygons[2*polygonsCount+1] = verticesCount-polygons[2*polygonsCount];
+                polygonsCount++;
             });
+        }
 
-            that.customHitBoxes[polygonIndex].vertices.length = vertIndex;
-            polygonIndex++;
-        });
-
-        this.customHitBoxes.length = polygonIndex;
+        vertices.length = 2*verticesCount;
+        polygons.length = 2*polygonsCount;
+        this.customHitBoxesVertices = vertices;
+        this.customHitBoxesPolygons = polygons;
+        this.customHitBoxesCount = polygonsCount;
     }
-    else {
-        this.customHitBoxes.length = 0;
+};
+
+/**
+ * Create the points of the frame stored in the flat arrays of the object.
+ *
+ * @method _loadPoints
+ * @private
+ */
+gdjs.SpriteAnimationFrame.prototype._loadPoints = function() {
+    var shapesData = this._shapesData;
+    for(var i = this._pointsStart, end = this._pointsStart+this._pointsCount;i<end;++i) {
+        this.points.put(shapesData.pointsNames[i], {x:shapesData.points[2*i], y:shapesData.points[2*i+1]});
     }
+
+    this._pointsLoaded = true;
 };
 
 /**
@@ -90,6 +131,7 @@ gdjs.SpriteAnimationFrame.prototype.getPoint = function(name) {
 	if ( name == "Centre" ) return this.center;
 	else if ( name == "Origin" ) return this.origin;
 
+	if ( !this._pointsLoaded ) this._loadPoints();
 	return this.points.containsKey(name) ? this.points.get(name) : this.origin;
 };
 
@@ -100,10 +142,10 @@ gdjs.SpriteAnimationFrame.prototype.getPoint = function(name) {
  * @namespace gdjs
  * @constructor
  */
-gdjs.SpriteAnimation = function(imageManager, animData)
+gdjs.SpriteAnimation = function(imageManager, animData, shapesData)
 {
 	//Constructor of internal object representing a direction of an animation.
-    var Direction = function(imageManager, directionData) {
+    var Direction = function(imageManager, directionData, shapesData) {
         this.timeBetweenFrames = directionData ? parseFloat(directionData.timeBetweenFrames) :
                                  1.0;
         this.loop = !!directionData.looping;
@@ -113,9 +155,9 @@ gdjs.SpriteAnimation = function(imageManager, animData)
         if ( this.frames === undefined ) this.frames = [];
         gdjs.iterateOverArray(directionData.sprites, function(frameData) {
             if ( i < that.frames.length )
-                gdjs.SpriteAnimationFrame.call(that.frames[i], imageManager, frameData);
+                gdjs.SpriteAnimationFrame.call(that.frames[i], imageManager, frameData, shapesData);
             else
-                that.frames.push(new gdjs.SpriteAnimationFrame(imageManager, frameData));
+                that.frames.push(new gdjs.SpriteAnimationFrame(imageManager, frameData, shapesData));
 
             i++;
         });
@@ -129,9 +171,9 @@ gdjs.SpriteAnimation = function(imageManager, animData)
     if ( this.directions === undefined ) this.directions = [];
     gdjs.iterateOverArray(animData.directions, function(directionData) {
         if ( i < that.directions.length )
-            Direction.call(that.directions[i], imageManager, directionData);
+            Direction.call(that.directions[i], imageManager, directionData, shapesData);
         else
-            that.directions.push(new Direction(imageManager, directionData));
+            that.directions.push(new Direction(imageManager, directionData, shapesData));
 
         i++;
     });
@@ -165,14 +207,15 @@ gdjs.SpriteRuntimeObject = function(runtimeScene, objectData)
     this.opacity = 255;
 
     //Animations:
+    var shapesData = gdjs.SpriteRuntimeObject.getShapesData(objectData);
     var that = this;
     var i = 0;
     if ( this._animations === undefined ) this._animations = [];
     gdjs.iterateOverArray(objectData.animations, function(animData) {
         if ( i < that._animations.length )
-            gdjs.SpriteAnimation.call(that._animations[i], runtimeScene.getGame().getImageManager(), animData);
+            gdjs.SpriteAnimation.call(that._animations[i], runtimeScene.getGame().getImageManager(), animData, shapesData);
         else
-            that._animations.push(new gdjs.SpriteAnimation(runtimeScene.getGame().getImageManager(), animData));
+            that._animations.push(new gdjs.SpriteAnimation(runtimeScene.getGame().getImageManager(), animData, shapesData));
 
         i++;
     });
@@ -194,6 +237,27 @@ gdjs.SpriteRuntimeObject = function(runtimeScene, objectData)
 gdjs.SpriteRuntimeObject.prototype = Object.create( gdjs.RuntimeObject.prototype );
 gdjs.SpriteRuntimeObject.thisIsARuntimeObjectConstructor = "Sprite"; //Notify gdjs of the object existence.
 
+/**
+ * Return the flat arrays storing the hit boxes and the points of the frames of the object
+ * ( see gdjs.SpriteAnimationFrame ), or undefined if the object data was exported without them.
+ *
+ * The arrays are converted to typed arrays the first time, and shared by all the instances of the object.
+ * Coordinates are stored in Float64Array, so that they have the same precision as in the legacy arrays.
+ *
+ * @method getShapesData
+ * @static
+ * @param objectData The data of the object.
+ */
+gdjs.SpriteRuntimeObject.getShapesData = function(objectData) {
+    var shapesData = objectData.shapes;
+    if ( shapesData === undefined || shapesData.vertices instanceof Float64Array ) return shapesData;
+
+    shapesData.vertices = new Float64Array(shapesData.vertices);
+    shapesData.polygons = new Uint32Array(shapesData.polygons);
+    shapesData.points = new Float64Array(shapesData.points);
+    return shapesData;
+};
+
 //Others initialization and internal state management :
 
 /**
@@ -324,21 +388,26 @@ gdjs.SpriteRuntimeObject.prototype.updateHitBoxes = function() {
 
     //Update the current hitboxes with the frame custom hit boxes
     //and apply transformations.
-    for (var i = 0;i<this._animationFrame.customHitBoxes.length;++i) {
+    var frame = this._animationFrame;
+    var vertices = frame.customHitBoxesVertices;
+    var polygons = frame.customHitBoxesPolygons;
+    for (var i = 0;i<frame.customHitBoxesCount;++i) {
         if ( i >= this.hitBoxes.length )
             this.hitBoxes.push(new gdjs.Polygon());
 
-        for (var j = 0;j<this._animationFrame.customHitBoxes[i].vertices.length;++j) {
-            if ( j >= this.hitBoxes[i].vertices.length )
-                this.hitBoxes[i].vertices.push([0,0]);
+        var hitBoxVertices = this.hitBoxes[i].vertices;
+        var firstVertex = polygons[2*(frame.customHitBoxesStart+i)];
+        var verticesCount = polygons[2*(frame.customHitBoxesStart+i)+1];
+        for (var j = 0;j<verticesCount;++j) {
+            if ( j >= hitBoxVertices.length )
+                hitBoxVertices.push([0,0]);
 
-            this._transformToGlobal(this._animationFrame.customHitBoxes[i].vertices[j][0],
-                this._animationFrame.customHitBoxes[i].vertices[j][1],
-                this.hitBoxes[i].vertices[j]);
+            this._transformToGlobal(vertices[2*(firstVertex+j)], vertices[2*(firstVertex+j)+1],
+                hitBoxVertices[j]);
         }
-        this.hitBoxes[i].vertices.length = this._animationFrame.customHitBoxes[i].vertices.length;
+        hitBoxVertices.length = verticesCount;
     }
-    this.hitBoxes.length = this._animationFrame.customHitBoxes.length;
+    this.hitBoxes.length = frame.customHitBoxesCount;
 
     //Rotate and scale and flipping have already been applied to the point by _transformToGlobal.
 };